@@ -6,32 +6,206 @@ struct CameraUBO
     alignas(16) glm::mat4 projection;
 };
 
+// Copies of ImGui's draw lists, so the next frame's UI can be built while this one renders
+struct ImGuiDrawSnapshot
+{
+    ImDrawData data;
+    std::vector<ImDrawList*> lists;
+
+    ImGuiDrawSnapshot() = default;
+    ImGuiDrawSnapshot(const ImGuiDrawSnapshot&) = delete;
+    ImGuiDrawSnapshot& operator=(const ImGuiDrawSnapshot&) = delete;
+    ~ImGuiDrawSnapshot() { Clear(); }
+
+    void Capture(const ImDrawData* source)
+    {
+        Clear();
+        if (!source || !source->Valid)
+            return;
+
+        data = *source;
+        data.CmdLists.resize(0);
+        data.Textures = nullptr; // Texture uploads happen in PublishSnapshot, never on the render thread
+        for (ImDrawList* list : source->CmdLists)
+        {
+            ImDrawList* clone = list->CloneOutput();
+            lists.push_back(clone);
+            data.CmdLists.push_back(clone);
+        }
+    }
+
+    void Clear()
+    {
+        for (ImDrawList* list : lists)
+            IM_DELETE(list);
+        lists.clear();
+        data.Clear();
+    }
+
+    ImDrawData* Get() { return data.Valid ? &data : nullptr; }
+};
+
+// Everything Render reads from the simulation. Written at the end of Update.
+struct RenderSnapshot
+{
+    glm::mat4 view{ 1.0f };
+    glm::mat4 projection{ 1.0f };
+    glm::mat4 model{ 1.0f };
+    VkClearColorValue clearColor{};
+    uint32_t framesInFlight = 0;
+    bool vertexPulling = false;
+    VkCullModeFlags cullMode = VK_CULL_MODE_NONE;
+    bool lighting = true;
+    bool alphaTest = false;
+    bool defragRequested = false;
+    bool lateLatch = false; // Input was left for Render to consume
+    ImGuiDrawSnapshot ui;
+};
+
+// What the memory panel shows of render-thread state. Copied in PublishSnapshot while the
+// render thread is idle, so Update never reads the allocator or the graph mid-frame.
+struct MemoryTelemetry
+{
+    MemoryStatistics stats;
+    DefragmentationStats defrag;
+    TransientAllocatorStats transient;
+    size_t pendingDeletions = 0;
+    uint64_t completedValue = 0;
+    uint64_t signaledValue = 0;
+    bool defragmenting = false;
+};
+
+// One frame in flight as Render records it. The slot's objects stay with their owners,
+// which each keep one set per frame in flight and index it by the same slot.
+struct FrameContext
+{
+    uint32_t index = 0;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE; // Primary from the slot's render-thread pool
+    VkSemaphore imageAvailable = VK_NULL_HANDLE;
+    VkFence inFlightFence = VK_NULL_HANDLE;         // Null in timeline mode
+    uint32_t cameraOffset = 0;                      // Dynamic offset of the slot's camera slice
+};
+
+// Everything sized by frames in flight behind one slot index: sync objects, command
+// pools, descriptor pools, deferred deletions and camera slices. Keeps their counts
+// equal, so nothing else resizes them or tracks the slot. Render thread only.
+class FrameContexts
+{
+public:
+    void Initialize(std::shared_ptr<VulkanDevice> device,
+        std::shared_ptr<VulkanSynchronization> sync,
+        std::shared_ptr<VulkanCommandBuffer> commands,
+        std::shared_ptr<VulkanMemoryAllocator> allocator,
+        VulkanDescriptorAllocator* descriptors,
+        uint32_t renderPool,
+        uint32_t cameraStride)
+    {
+        m_device = std::move(device);
+        m_sync = std::move(sync);
+        m_commands = std::move(commands);
+        m_allocator = std::move(allocator);
+        m_descriptors = descriptors;
+        m_renderPool = renderPool;
+        m_cameraStride = cameraStride;
+        m_index = 0;
+    }
+
+    uint32_t GetCount() const { return m_sync ? m_sync->GetMaxFramesInFlight() : 0; }
+    uint32_t GetIndex() const { return m_index; }
+    const FrameSyncObjects& GetSync() const { return m_sync->GetFrameSync(m_index); }
+
+    // Waits until the GPU is done with the slot's previous frame
+    bool Wait() { return m_sync->WaitForFence(m_index); }
+
+    // Recycles the slot's fence and pools; called once its image is acquired
+    FrameContext Begin()
+    {
+        m_sync->ResetFence(m_index);
+        m_descriptors->BeginFrame(m_index);
+        m_commands->ResetThreadPools(m_index);
+
+        FrameContext frame;
+        frame.index = m_index;
+        frame.commandBuffer = m_commands->AcquirePrimary(m_index, m_renderPool);
+        frame.imageAvailable = GetSync().imageAvailableSemaphore;
+        frame.inFlightFence = GetSync().inFlightFence;
+        frame.cameraOffset = m_index * m_cameraStride;
+        return frame;
+    }
+
+    void Advance() { m_index = (m_index + 1) % GetCount(); }
+
+    // Waits for the device, then resizes every owner or none: a refused count leaves
+    // each of them at the previous one, so frames keep going
+    bool Resize(uint32_t frames)
+    {
+        m_device->WaitIdle();
+
+        const uint32_t previous = GetCount();
+        if (!m_sync->SetFramesInFlight(frames))
+            return false;
+
+        const uint32_t threads = m_commands->GetThreadCount();
+        if (!m_descriptors->Resize(frames) || !m_commands->InitializeThreadPools(threads, frames))
+        {
+            m_sync->SetFramesInFlight(previous);
+            m_descriptors->Resize(previous);
+            m_commands->InitializeThreadPools(threads, previous);
+            return false;
+        }
+
+        m_allocator->SetFramesInFlight(frames);
+        m_index = 0;
+        return true;
+    }
+
+private:
+    std::shared_ptr<VulkanDevice> m_device;
+    std::shared_ptr<VulkanSynchronization> m_sync;
+    std::shared_ptr<VulkanCommandBuffer> m_commands;
+    std::shared_ptr<VulkanMemoryAllocator> m_allocator;
+    VulkanDescriptorAllocator* m_descriptors = nullptr;
+    uint32_t m_renderPool = 0;
+    uint32_t m_cameraStride = 0;
+    uint32_t m_index = 0;
+};
+
 class test : public Application
 {
 public:
     test()
     {
+        const auto initStart = std::chrono::steady_clock::now();
+
+        SetPipelined(true);
         InitializeCore();
         InitializeWindowAndSurface();
+        InitializePipelineCache();
         InitializeSwapchainAndRenderPass();
         InitializePipelineModel();
         InitializeCommandsAndSync();
         InitializeMemoryAndGeometry();
+        InitializeFrameContexts();
         InitializeTextureManager(); 
-        InitDepth(); 
+        InitializeRenderGraph();
         InitializeFramebuffers();
         LoadModelTextures(); 
         InitalizeImGui(); 
         InitializeDescriptors();
+        InitializeDefragmentation();
         HookInput();
+
+        m_startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - initStart).count();
         LogInitSummary();
     }
 
     void Update(float deltaTime) override
     {
         WindowManager::PollAllWindowEvents();
-        if(!m_manualOverride)
-             CameraMovement(deltaTime);
+        m_latchDeltaTime = deltaTime;
+        m_lateLatchFrame = IsLateLatching(); // Fixed for the frame, even if the UI below toggles it
+        if (!m_lateLatchFrame)
+            ConsumeInput(deltaTime);
 
         m_rotation += deltaTime * 45.0f;
         if (m_rotation > 360.0f) m_rotation -= 360.0f;
@@ -49,8 +223,29 @@ public:
         ImGui::SliderFloat("B", &b, 0, 255.0f);
         ImGui::SliderFloat("Alpha", &alpha, 0, 1.0f); 
         ImGui::Checkbox("Manual", &m_manualOverride); 
+        ImGui::Checkbox("Memory", &m_showMemoryPanel);
+        ImGui::SliderInt("Frames in flight", &m_requestedFramesInFlight, 1, static_cast<int>(VulkanSynchronization::MaxFramesInFlightLimit));
+        if (m_pullPipeline)
+            ImGui::Checkbox("Vertex pulling", &m_useVertexPulling);
+        ImGui::Combo("Cull mode", &m_cullMode, "None\0Back\0Front\0");
+        ImGui::Checkbox("Lighting", &m_lighting);
+        ImGui::SameLine();
+        ImGui::Checkbox("Alpha test", &m_alphaTest);
+        const PipelineLibraryStats pipelines = m_pipelineLibrary.GetStats();
+        ImGui::Text("Pipelines: %u live, %u compiling, %.1f ms compiled off-thread",
+            pipelines.live, pipelines.pending, pipelines.asyncCompileMs);
+        if (m_device->IsGraphicsPipelineLibraryEnabled())
+            ImGui::Text("Pipeline library: %u parts, %llu fast-linked, %llu optimized",
+                pipelines.parts, static_cast<unsigned long long>(pipelines.fastLinked),
+                static_cast<unsigned long long>(pipelines.optimized));
+        ImGui::Text("Swapchain %ux%u, last resize %.2f ms",
+            m_swapchain->GetExtent().width, m_swapchain->GetExtent().height, m_resizeMs);
+        DrawPacingControls();
         ImGui::End();
 
+        if (m_showMemoryPanel)
+            DrawMemoryPanel();
+
         ImGui::Render();
         /*/
         
@@ -63,62 +258,161 @@ public:
         */
 
         m_camera->SetFOV(m_crest);
+        WriteSnapshot();
+    }
+
+    void PublishSnapshot() override
+    {
+        // The render thread is idle, so ImGui's texture uploads may use the queue here
+        ImDrawData* drawData = ImGui::GetDrawData();
+        if (drawData && drawData->Textures)
+        {
+            for (ImTextureData* texture : *drawData->Textures)
+            {
+                if (texture->Status != ImTextureStatus_OK)
+                    ImGui_ImplVulkan_UpdateTexture(texture);
+            }
+        }
+
+        RecreateSwapchain();
+
+        if (std::exchange(m_exportRequested, false))
+            m_allocator->ExportStatisticsJson("memory_stats.json");
+
+        if (m_showMemoryPanel)
+            CaptureMemoryTelemetry();
+
+        m_snapshots.Publish();
+    }
+
+    void CaptureMemoryTelemetry()
+    {
+        m_memoryTelemetry.stats = m_allocator->GetStatistics();
+        m_memoryTelemetry.defrag = m_allocator->GetDefragmentationStats();
+        m_memoryTelemetry.defragmenting = m_allocator->IsDefragmenting();
+        m_memoryTelemetry.transient = m_renderGraph.GetTransientStats();
+        m_memoryTelemetry.pendingDeletions = m_allocator->GetPendingDeletionCount();
+        if (m_sync->IsTimelineEnabled())
+        {
+            m_memoryTelemetry.completedValue = m_sync->GetCompletedValue();
+            m_memoryTelemetry.signaledValue = m_sync->GetLastSignaledValue();
+        }
     }
 
     void Render() override
     {
-        m_sync->WaitForFence(m_currentFrame);
+        // Only the snapshot is shared with Update; everything else here is render-thread
+        // state, which Update sees through copies made in PublishSnapshot
+        RenderSnapshot& snapshot = m_snapshots.Read();
 
-        m_renderPass->SetNewClearColor({ r / 255.0f , g / 255.0f, b / 255.0f, alpha}); 
+        // Nothing to draw into until PublishSnapshot rebuilds the swapchain
+        if (m_swapchainDirty.load(std::memory_order_acquire))
+            return;
+
+        if (snapshot.framesInFlight != m_frames.GetCount() &&
+            snapshot.framesInFlight != m_rejectedFramesInFlight)
+            ApplyFramesInFlight(snapshot.framesInFlight);
+
+        // Without frame sync objects there is no slot to record into, or to advance past
+        if (m_frames.GetCount() == 0)
+            return;
+
+        if (snapshot.defragRequested && !m_allocator->IsDefragmenting())
+        {
+            DefragmentationConfig config;
+            config.framesInFlight = m_frames.GetCount();
+            m_allocator->BeginDefragmentation(config);
+        }
+
+        m_frames.Wait();
+        m_allocator->BeginFrame(static_cast<uint32_t>(m_frameNumber));
+        m_allocator->DefragmentStep(m_commandBuffer.get());
+
+        m_renderPass->SetNewClearColor(snapshot.clearColor); 
 
         uint32_t imageIndex;
         if (!m_swapchain->AcquireNextImage(
             imageIndex,
-            m_sync->GetImageSync(m_currentFrame).imageAvailableSemaphore,
+            m_frames.GetSync().imageAvailableSemaphore,
             VK_NULL_HANDLE))
+        {
+            if (m_swapchain->IsOutOfDate())
+                m_swapchainDirty.store(true, std::memory_order_release);
             return;
+        }
 
-        m_sync->ResetFence(m_currentFrame);
+        m_frame = m_frames.Begin();
+        BuildFrameDescriptors();
 
-        VkCommandBuffer cmd = m_commandBuffers[m_currentFrame];
-        vkResetCommandBuffer(cmd, 0);
-        m_commandBuffer->BeginRecording(cmd);
+        VkCommandBuffer cmd = m_frame.commandBuffer;
+        m_commandBuffer->BeginRecording(cmd, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
-        BeginRenderPass(cmd, imageIndex);
-        DrawModel(cmd);
-        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
-        EndRenderPass(cmd);
+        if (snapshot.lateLatch)
+            LateLatch(snapshot);
+        UpdateCamera(snapshot);
+
+        ResolveModelPipelines(snapshot);
+
+        const SecondaryInheritance inheritance = SecondaryInheritance::RenderPass(
+            m_renderPass->GetRenderPass(), GetFramebuffer(imageIndex));
+
+        // Everything inside the pass is recorded into secondaries; the primary only executes them.
+        std::vector<VkCommandBuffer> secondaries = RecordModelParallel(inheritance, snapshot);
+
+        VkCommandBuffer uiCmd = m_commandBuffer->AcquireSecondary(m_frame.index, RenderThreadPool());
+        if (m_commandBuffer->BeginSecondary(uiCmd, inheritance))
+        {
+            if (ImDrawData* drawData = snapshot.ui.Get())
+                ImGui_ImplVulkan_RenderDrawData(drawData, uiCmd);
+            m_commandBuffer->EndRecording(uiCmd);
+            secondaries.push_back(uiCmd);
+        }
+
+        // The graph moves the backbuffer and depth in and out of attachment layouts around the pass
+        m_sceneImageIndex = imageIndex;
+        m_sceneSecondaries = std::move(secondaries);
+        m_renderGraph.SetImportedImage(m_backbufferResource, m_swapchain->GetImage(imageIndex).image);
+        m_renderGraph.Execute(cmd);
 
         m_commandBuffer->EndRecording(cmd);
 
+        // Reserved right before submitting so values reach the queue in order
+        const TimelineSignal frameSignal = m_sync->SignalFrame(m_frame.index);
+
         m_commandBuffer->Submit(
             cmd,
             m_device->GetGraphicsQueue(),
-            { m_sync->GetImageSync(m_currentFrame).imageAvailableSemaphore },
+            { m_frame.imageAvailable },
             { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT },
-            { m_sync->GetImageSync(m_currentFrame).renderFinishedSemaphore },
-            m_sync->GetFrameSync(m_currentFrame).inFlightFence
+            { m_sync->GetImageSync(imageIndex).renderFinishedSemaphore },
+            m_frame.inFlightFence,
+            frameSignal
         );
 
+        if (frameSignal.IsValid())
+            m_allocator->SubmitFrame(frameSignal.value);
+
         m_swapchain->PresentImage(
             imageIndex,
             { m_sync->GetImageSync(imageIndex).renderFinishedSemaphore }
         );
+        if (m_swapchain->IsOutOfDate())
+            m_swapchainDirty.store(true, std::memory_order_release);
 
-        m_currentFrame = (m_currentFrame + 1) % m_sync->GetMaxFramesInFlight();
-
-        if (Input::Get().IsKeyPressed(VK::Escape))
-        {
-            Quit(); 
-        }
-
-        Input::Get().Update();
-       
+        m_frames.Advance();
+        ++m_frameNumber;
     }
     
 private: 
     int m_crest = 120; 
     bool m_manualOverride = false; 
+    bool m_showMemoryPanel = false;
+    int m_requestedFramesInFlight = 3;
+    bool m_pipelined = true;
+    bool m_lateLatching = false;
+    bool m_capped = false;
+    float m_latchDeltaTime = 0.0f;
+    bool m_lateLatchFrame = false;
     void InitializeCore()
     {
         m_instance = std::make_shared<VulkanInstance>();
@@ -155,6 +449,22 @@ private:
         m_surface->Initialize(m_instance, m_device, m_window);
     }
 
+    // Loaded before any pipeline or ImGui is created so they all hit the same cache
+    void InitializePipelineCache()
+    {
+        m_pipelineCache = std::make_shared<VulkanPipelineCache>();
+        if (!m_pipelineCache->Initialize(m_instance, m_device, "Cache/pipeline_cache.bin"))
+            m_pipelineCache.reset();
+
+        // Packed by the build next to the loose .spv files, which remain the fallback
+        m_shaderCache = std::make_shared<VulkanShaderModuleCache>();
+        m_shaderCache->Initialize(m_instance, m_device);
+        m_shaderCache->MountArchive("Shaders/shaders.pak");
+        m_layoutCache.Initialize(m_instance, m_device);
+
+        m_pipelineLibrary.Initialize(m_instance, m_device, m_pipelineCache, m_shaderCache, &GetJobSystem());
+    }
+
     void InitializeTextureManager()
     {
         m_imageManager.Initialize(m_instance, m_device, m_allocator);
@@ -183,6 +493,12 @@ private:
         RenderPassConfig config = RenderPassConfig::SingleColorAttachment(m_swapchain->GetFormat());
         RenderPassAttachment depth = RenderPassAttachment::DepthAttachment(m_device->GetDepthFormat()); 
 
+        // Layout transitions belong to the render graph; the pass keeps attachments as it finds them
+        config.attachments[0].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        config.attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        depth.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depth.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
         config.attachments.push_back(std::move(depth)); 
         config.subpasses[0].depthAttachment = 1; 
         
@@ -190,65 +506,70 @@ private:
 
     }
 
-    void InitDepth()
-    {
-
-
-        UINT8 count = (UINT8)m_swapchain->GetImageCount();
-
-        m_depthImages.resize(count);
-
-        for (size_t i = 0; i < count; i++)
-        {
-            TextureInfo& depth = m_depthImages[i];
-            VkExtent2D extent = m_swapchain->GetExtent();
-            ImageOptions opts =
-            {
-                .width = extent.width,
-                .height = extent.height,
-                .format = m_device->GetDepthFormat(),
-                .mipLevels = 1,
-                .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-            };
-
-            depth = {};
-
-            if (!m_imageManager.CreateImage(ImageCreateInfo::FromOptions(opts), depth.image))
-            {
-                std::println("Failed to create depth image");
-            }
-
-            ImageViewOptions viewOpts{};
-
-            viewOpts.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-
-            if (!m_imageViewManager.CreateView(depth.image, depth.imageView, viewOpts))
-            {
-                std::println("Failed to create depth image");
-            }
-
-        }
-    }
-
     void InitializeFramebuffers()
     {
         const uint32_t imageCount = m_swapchain->GetImageCount();
         m_framebuffers.resize(imageCount);
 
+        // Every frame in flight shares the graph's depth; its barriers order their use
         for (uint32_t i = 0; i < imageCount; ++i)
         {
-            m_framebuffers[i] = std::make_shared<VulkanFrameBuffer>();
-            m_framebuffers[i]->Initialize(
+            auto& framebuffer = m_framebuffers[i];
+            framebuffer = std::make_shared<VulkanFrameBuffer>();
+            framebuffer->Initialize(
                 m_instance,
                 m_device,
                 m_renderPass,
-                { m_swapchain->GetImageView(i), m_depthImages[i].imageView.view},
+                { m_swapchain->GetImageView(i), m_renderGraph.GetTransientView(m_depthResource) },
                 m_swapchain->GetExtent().width,
                 m_swapchain->GetExtent().height
             );
         }
     }
 
+    void InitializeRenderGraph()
+    {
+        m_renderGraph.Initialize(m_instance, m_device, m_allocator);
+        BuildRenderGraph();
+        std::cout << m_renderGraph.GetCompiledInfo();
+    }
+
+    // The backbuffer changes every frame but the pass structure does not, so the graph is
+    // only rebuilt when the swapchain extent changes. Depth never leaves the pass, so it is
+    // a graph transient that can stay in lazily allocated memory where the device offers it.
+    bool BuildRenderGraph()
+    {
+        const VkExtent2D extent = m_swapchain->GetExtent();
+
+        m_renderGraph.Reset();
+        m_backbufferResource = m_renderGraph.ImportImage(RenderGraphImportDesc::Backbuffer(m_swapchain->GetFormat()));
+        m_depthResource = m_renderGraph.CreateImage(
+            RenderGraphImageDesc::Make("depth", extent.width, extent.height, m_device->GetDepthFormat()));
+
+        m_renderGraph.AddPass("scene")
+            .Write(m_backbufferResource, RenderGraphUsage::ColorAttachment)
+            .Write(m_depthResource, RenderGraphUsage::DepthAttachment)
+            .SetExecute([this](VkCommandBuffer cmd) {
+                BeginRenderPass(cmd, m_sceneImageIndex, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+                m_commandBuffer->ExecuteSecondaries(cmd, m_sceneSecondaries);
+                EndRenderPass(cmd);
+            });
+
+        if (!m_renderGraph.Compile())
+        {
+            std::println("Failed to compile render graph");
+            return false;
+        }
+
+        if (!m_renderGraph.Allocate())
+        {
+            std::println("Failed to create render graph images");
+            return false;
+        }
+
+        return true;
+    }
+
    bool InitalizeImGui()
     {
         VkDescriptorPoolSize pool_sizes[] = {
@@ -295,7 +616,7 @@ private:
         init_info.PipelineInfoMain.Subpass = 0;                                 
         init_info.PipelineInfoMain.MSAASamples = VK_SAMPLE_COUNT_1_BIT;       
 
-        init_info.PipelineCache = VK_NULL_HANDLE;
+        init_info.PipelineCache = m_pipelineCache ? m_pipelineCache->GetCache() : VK_NULL_HANDLE;
         init_info.Allocator = nullptr;
         init_info.CheckVkResultFn = nullptr;
         init_info.UseDynamicRendering = false;  
@@ -306,26 +627,40 @@ private:
         return true; 
     }
 
+    // Descriptor, push constant and vertex layouts come from the shaders themselves.
+    // The camera buffer is offset per frame, which SPIR-V cannot express, so it is named here.
+    bool ReflectLayout(const std::vector<ShaderStage>& shaders, ReflectedPipelineLayout& outLayout)
+    {
+        std::vector<std::shared_ptr<VulkanShaderModule>> modules;
+        for (const auto& shader : shaders)
+            modules.push_back(m_shaderCache->Acquire(shader.filepath));
+
+        return m_layoutCache.Reflect(modules, { { 0, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC } }, outLayout);
+    }
+
     void InitializePipelineModel()
     {
         auto bindingDescription = ModelVertex::GetBindingDescription();
         auto attributeDescriptions = ModelVertex::GetAttributeDescriptions();
 
-        m_pipeline = std::make_shared<VulkanGraphicsPipeline>();
         GraphicsPipelineConfig modelConfig = GraphicsPipelineConfig::SimpleTriangle(
             "Shaders/model.vert.spv",
             "Shaders/model.frag.spv"
         );
 
+        if (!ReflectLayout(modelConfig.shaders, m_modelLayout) || m_modelLayout.sets.empty())
+        {
+            std::println("Failed to reflect the model shaders");
+            return;
+        }
+
         modelConfig.vertexInput.bindings = { bindingDescription };
         modelConfig.vertexInput.attributes = { attributeDescriptions.begin(), attributeDescriptions.end() };
+        if (!VulkanDescriptorLayoutCache::MatchVertexInput(m_modelLayout, modelConfig.vertexInput))
+            return;
 
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(glm::mat4) + sizeof(glm::vec3);
-        modelConfig.pushConstantRanges = { pushConstantRange };
-        modelConfig.viewport = m_swapchain->GetExtent();
+        modelConfig.descriptorSetLayouts = m_modelLayout.setLayouts;
+        modelConfig.pushConstantRanges = m_modelLayout.pushConstantRanges;
         modelConfig.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
         modelConfig.cullMode = VK_CULL_MODE_NONE;
         modelConfig.depthTestEnable = VK_TRUE; 
@@ -342,10 +677,75 @@ private:
 
         const uint32_t imageCount = m_swapchain->GetImageCount();
         m_sync = std::make_shared<VulkanSynchronization>();
-        m_sync->Initialize(m_instance, m_device, 3, imageCount);
+        m_sync->Initialize(m_instance, m_device, static_cast<uint32_t>(m_requestedFramesInFlight), imageCount, true);
+
+        // Material sets come from its persistent pools, the fallback set from the per-frame ones
+        if (!m_descriptorAllocator.Initialize(m_instance, m_device, m_sync->GetMaxFramesInFlight()))
+        {
+            std::println("Failed to initialize the descriptor allocator");
+            Quit();
+        }
+
+        // Every per-frame primary and secondary comes from these, one pool per job system
+        // thread, picked by thread index, plus one for whichever thread runs Render, which is
+        // not a job thread when pipelined. m_commandBuffer's shared pool is left to single-time uploads.
+        const uint32_t recordThreads = GetJobSystem().GetThreadCount() + 1;
+        m_commandBuffer->InitializeThreadPools(recordThreads, m_sync->GetMaxFramesInFlight());
+    }
+
+    void InitializeFrameContexts()
+    {
+        m_frames.Initialize(m_device, m_sync, m_commandBuffer, m_allocator, &m_descriptorAllocator,
+            RenderThreadPool(), m_cameraStride);
+    }
+
+    // The camera buffer is already sized for the limit, so only the dynamic offset range
+    // it uses changes. A refused count is not retried until the request changes.
+    void ApplyFramesInFlight(uint32_t frames)
+    {
+        if (!m_frames.Resize(frames))
+        {
+            std::println("Could not switch to {} frames in flight, staying at {}", frames, m_frames.GetCount());
+            m_rejectedFramesInFlight = frames;
+            return;
+        }
+
+        m_rejectedFramesInFlight = 0;
+    }
+
+    // Pipelines use dynamic viewport/scissor and the render pass only depends on the format,
+    // so a resize rebuilds just the swapchain, its framebuffers and the graph with its depth.
+    // Called with the render thread idle.
+    void RecreateSwapchain()
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        // Cleared before rebuilding, so a resize that lands mid-rebuild marks it dirty again
+        if (!m_swapchainDirty.exchange(false, std::memory_order_acq_rel))
+            return;
+
+        if (!m_swapchain->Recreate())
+        {
+            // Minimized; stays dirty and frames are skipped until it has area again
+            m_swapchainDirty.store(true, std::memory_order_release);
+            return;
+        }
+
+        if (!m_sync->SetImageCount(m_swapchain->GetImageCount()))
+        {
+            m_swapchainDirty.store(true, std::memory_order_release);
+            return;
+        }
 
-        m_commandBuffers = m_commandBuffer->AllocateCommandBuffers(imageCount);
-        m_currentFrame = 0;
+        m_framebuffers.clear();
+        if (!BuildRenderGraph())
+        {
+            m_swapchainDirty.store(true, std::memory_order_release);
+            return;
+        }
+        InitializeFramebuffers();
+
+        m_resizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
     }
 
     void InitializeMemoryAndGeometry()
@@ -366,6 +766,8 @@ private:
         maxFOV = m_camera->GetSettings().maxFov;
         m_allocator = std::make_shared<VulkanMemoryAllocator>();
         m_allocator->Initialize(m_instance, m_device);
+        m_allocator->SetFramesInFlight(m_sync->GetMaxFramesInFlight());
+        m_allocator->SetTimeline(m_sync);
 
         m_allocator->CreateVertexBuffer(
             m_commandBuffer.get(),
@@ -374,8 +776,14 @@ private:
             m_vertexBuffer
         );
 
+        // One slice per possible frame in flight, selected with a dynamic offset. Rewritten
+        // every frame, so it is always host-visible and persistently mapped (VRAM through
+        // BAR when the device has it); a staged copy here would mean a submit per frame.
+        const VkDeviceSize alignment = m_device->GetDeviceProperties().limits.minUniformBufferOffsetAlignment;
+        m_cameraStride = static_cast<uint32_t>((sizeof(CameraUBO) + alignment - 1) & ~(alignment - 1));
+
         m_allocator->CreateUniformBuffer(
-            sizeof(CameraUBO),
+            static_cast<size_t>(m_cameraStride) * VulkanSynchronization::MaxFramesInFlightLimit,
             m_cameraUniformBuffer
         );
 
@@ -384,22 +792,83 @@ private:
 
     void InitializeDescriptors()
     {
+        if (m_modelLayout.sets.empty())
+            return;
+
         m_descriptor = std::make_shared<VulkanDescriptor>(); 
         m_descriptor->Initialize(m_instance, m_device);
 
-        m_descriptor->AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT);
+        // Built per frame by BuildFrameDescriptors
+        m_descriptor->AddBindings(m_modelLayout.sets[0]);
 
-        m_descriptor->AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+        const auto pipelineStart = std::chrono::steady_clock::now();
+        m_pipeline = m_pipelineLibrary.GetOrCreate(m_renderPass, m_pendingPipelineConfig);
 
-        m_descriptor->Build(1);
-        m_descriptor->BindBuffer(0, m_cameraUniformBuffer.buffer, sizeof(CameraUBO));
+        InitializePipelinePull();
+        m_pipelineMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pipelineStart).count();
+    }
 
-        m_descriptor->BindImage(1, m_brickTexture->GetImageView(), m_brickTexture->GetSampler());
+    void InitializePipelinePull()
+    {
+        // Needs bufferDeviceAddress; without it the model keeps the vertex input path.
+        if (!m_allocator->IsBufferDeviceAddressEnabled() || m_modelVertexBuffer.deviceAddress == 0)
+            return;
 
-        m_pendingPipelineConfig.descriptorSetLayouts = { m_descriptor->GetLayout() };
-        m_pipeline->Initialize(m_instance, m_device, m_renderPass, m_pendingPipelineConfig);
+        GraphicsPipelineConfig pullConfig = m_pendingPipelineConfig;
+        pullConfig.shaders = {
+            ShaderStage::Vertex("Shaders/model_pull.vert.spv"),
+            ShaderStage::Fragment("Shaders/model.frag.spv")
+        };
 
-        
+        // Same set layout handle as the model pipeline, so the material sets bind to either
+        ReflectedPipelineLayout pullLayout;
+        if (!ReflectLayout(pullConfig.shaders, pullLayout) ||
+            !VulkanDescriptorLayoutCache::MatchVertexInput(pullLayout, pullConfig.vertexInput))
+            return;
+
+        pullConfig.descriptorSetLayouts = pullLayout.setLayouts;
+        pullConfig.pushConstantRanges = pullLayout.pushConstantRanges;
+
+        m_pullPipeline = m_pipelineLibrary.GetOrCreate(m_renderPass, pullConfig);
+        if (!m_pullPipeline)
+            return;
+
+        m_pullPipelineConfig = pullConfig;
+
+        m_modelPullLayout = VertexPullLayout::ForModelVertex();
+        m_useVertexPulling = true;
+    }
+
+    void InitializeDefragmentation()
+    {
+        m_allocator->RegisterMovable(&m_modelVertexBuffer);
+        m_allocator->RegisterMovable(&m_ModelIndexBuffer);
+
+        m_textureManager.EnableDefragmentation(m_allocator.get(),
+            [this](const std::shared_ptr<Texture>& texture) { OnTextureMoved(texture); });
+    }
+
+    void OnTextureMoved(const std::shared_ptr<Texture>& texture)
+    {
+        for (size_t i = 0; i < m_materialDiffuseTextures.size(); ++i)
+        {
+            if (m_materialDiffuseTextures[i] == texture && m_materialDescriptors[i])
+                m_materialDescriptors[i]->BindImage(1, texture->GetImageView(), texture->GetSampler());
+        }
+    }
+
+    // The fallback set is written fresh from the frame slot's pools every frame, so it always
+    // sees the brick texture's current view and no set an earlier frame reads is rewritten.
+    void BuildFrameDescriptors()
+    {
+        if (!m_descriptor || m_modelLayout.setLayouts.empty())
+            return;
+
+        if (!m_descriptor->BuildFrame(m_modelLayout.setLayouts[0], m_descriptorAllocator))
+            return;
+
+        m_descriptor->BindBuffer(0, m_cameraUniformBuffer.buffer, sizeof(CameraUBO));
+        m_descriptor->BindImage(1, m_brickTexture->GetImageView(), m_brickTexture->GetSampler());
     }
 
     struct PushConstants {
@@ -409,48 +878,221 @@ private:
 
      bool yes = false; 
 
-    void DrawModel(VkCommandBuffer cmd)
+    uint32_t RenderThreadPool() { return GetJobSystem().GetThreadCount(); }
+
+    // Runs at the end of Update, into the slot the render thread is not reading
+    void WriteSnapshot()
     {
-        CameraUBO cameraData{};
-        cameraData.view = m_camera->GetViewMatrix();
-        cameraData.projection = m_camera->GetProjectionMatrix(
+        RenderSnapshot& snapshot = m_snapshots.Write();
+
+        snapshot.view = m_camera->GetViewMatrix();
+        snapshot.projection = CameraProjection();
+
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::rotate(model, glm::radians(180.0f), glm::vec3(1, 0, 0));
+        snapshot.model = glm::rotate(model, glm::radians(m_rotation), glm::vec3(0, 1, 0));
+
+        snapshot.clearColor = { r / 255.0f , g / 255.0f, b / 255.0f, alpha };
+        snapshot.framesInFlight = static_cast<uint32_t>(m_requestedFramesInFlight);
+        snapshot.vertexPulling = m_useVertexPulling && m_pullPipeline;
+        static constexpr VkCullModeFlags cullModes[] = { VK_CULL_MODE_NONE, VK_CULL_MODE_BACK_BIT, VK_CULL_MODE_FRONT_BIT };
+        snapshot.cullMode = cullModes[std::clamp(m_cullMode, 0, 2)];
+        snapshot.lighting = m_lighting;
+        snapshot.alphaTest = m_alphaTest;
+        snapshot.defragRequested = std::exchange(m_defragRequested, false);
+        snapshot.lateLatch = m_lateLatchFrame;
+        snapshot.ui.Capture(ImGui::GetDrawData());
+    }
+
+    glm::mat4 CameraProjection() const
+    {
+        return m_camera->GetProjectionMatrix(
             (float)m_swapchain->GetExtent().width /
             (float)m_swapchain->GetExtent().height
         );
-        m_allocator->UploadDataToBuffer(m_cameraUniformBuffer, &cameraData, sizeof(CameraUBO));
+    }
 
-        m_pipeline->Bind(cmd);
+    // Serial mode only, where Render runs on the window's thread: messages that arrived
+    // during the fence and acquire waits still move this frame's camera
+    void LateLatch(RenderSnapshot& snapshot)
+    {
+        WindowManager::PollAllWindowEvents();
+        ConsumeInput(m_latchDeltaTime);
 
-        VkBuffer vertexBuffers[] = { m_modelVertexBuffer.buffer };
-        VkDeviceSize offsets[] = { 0 };
-        vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(cmd, m_ModelIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+        snapshot.view = m_camera->GetViewMatrix();
+        snapshot.projection = CameraProjection();
+    }
 
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::rotate(model, glm::radians(180.0f), glm::vec3(1, 0, 0));
-        model = glm::rotate(model, glm::radians(m_rotation), glm::vec3(0, 1, 0));
+    void UpdateCamera(const RenderSnapshot& snapshot)
+    {
+        CameraUBO cameraData{};
+        cameraData.view = snapshot.view;
+        cameraData.projection = snapshot.projection;
+        m_allocator->UploadToBuffer(m_commandBuffer.get(), m_cameraUniformBuffer, &cameraData, sizeof(CameraUBO),
+            m_frame.cameraOffset);
+    }
 
-        PushConstants ps{};
-        ps.model = model;
-        ps.light = glm::vec3(5.0f, 5.0f, 5.0f);
+    // The base pipelines are built at startup; other cull modes are variants compiled on
+    // a worker the first time they are asked for, drawn with the base pipeline until
+    // ready, and evicted once nothing has used them for a while.
+    // One variant per value of USE_TEXTURE in model.frag; the rest of the state is per frame.
+    // Until a variant compiles the base pipeline stands in, which samples the white texture
+    // for untextured materials and so looks the same.
+    void ResolveModelPipelines(const RenderSnapshot& snapshot)
+    {
+        const bool pulling = snapshot.vertexPulling;
+        VulkanGraphicsPipeline* base = pulling ? m_pullPipeline.get() : m_pipeline.get();
 
-        vkCmdPushConstants(
-            cmd,
-            m_pipeline->GetLayout(),
-            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-            0,
-            sizeof(PushConstants),
-            &ps
-        );
+        GraphicsPipelineConfig config = pulling ? m_pullPipelineConfig : m_pendingPipelineConfig;
+        config.cullMode = snapshot.cullMode;
 
-        for (const auto& subMesh : m_model.subMeshes)
+        m_pipelineLibrary.EvictUnused(m_frameNumber, kPipelineEvictAge);
+
+        for (uint32_t textured = 0; textured < 2; ++textured)
         {
-            VkDescriptorSet set = VK_NULL_HANDLE;
-            if (!yes)
+            GraphicsPipelineConfig variantConfig = config;
+            for (auto& shader : variantConfig.shaders)
             {
+                if (shader.stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+                    continue;
+                shader.Specialize(kUseTexture, textured == 1)
+                    .Specialize(kUseLighting, snapshot.lighting)
+                    .Specialize(kAlphaTest, snapshot.alphaTest);
+            }
+
+            auto variant = m_pipelineLibrary.RequestAsync(m_renderPass, variantConfig, m_frameNumber);
+            m_framePipelines[textured] = variant ? variant.get() : base;
+        }
+    }
+
+    // constant_id values declared in model.frag
+    static constexpr uint32_t kUseTexture = 0;
+    static constexpr uint32_t kUseLighting = 1;
+    static constexpr uint32_t kAlphaTest = 2;
+
+    bool IsMaterialTextured(int material) const
+    {
+        if (material < 0 || material >= (int)m_materialTextured.size())
+            return true; // Falls back to m_descriptor, which has the brick texture
+        return m_materialTextured[material] != 0;
+    }
+
+    // Longer than any frames-in-flight setting, so an evicted pipeline is never still in use
+    static constexpr uint64_t kPipelineEvictAge = VulkanSynchronization::MaxFramesInFlightLimit + 60;
+
+    // Below this many sub-meshes per thread, fanning out costs more than it saves.
+    static constexpr size_t kMinDrawsPerThread = 256;
+
+    std::vector<VkCommandBuffer> RecordModelParallel(const SecondaryInheritance& inheritance, const RenderSnapshot& snapshot)
+    {
+        if (!yes)
+        {
+            for (const auto& subMesh : m_model.subMeshes)
                 std::cout << "SubMesh material id: " << subMesh.material << "\n";
-           
+            yes = true;
+        }
+
+        const size_t drawCount = m_model.subMeshes.size();
+        const uint32_t ranges = static_cast<uint32_t>(std::clamp<size_t>(
+            drawCount / kMinDrawsPerThread, 1, GetJobSystem().GetThreadCount()));
+
+        std::vector<VkCommandBuffer> secondaries(ranges, VK_NULL_HANDLE);
+        JobCounter recorded;
+
+        // Each range records into the pool of whichever job thread runs it. When this is the
+        // main thread it helps while it waits; a separate render thread just waits.
+        for (uint32_t range = 0; range < ranges; ++range)
+        {
+            GetJobSystem().Schedule([&, range]()
+            {
+                const uint32_t thread = JobSystem::GetCurrentThreadIndex();
+                VkCommandBuffer secondary = m_commandBuffer->AcquireSecondary(m_frame.index, thread);
+                if (!m_commandBuffer->BeginSecondary(secondary, inheritance))
+                    return;
+
+                DrawModel(secondary, snapshot, drawCount * range / ranges, drawCount * (range + 1) / ranges);
+                if (m_commandBuffer->EndRecording(secondary))
+                    secondaries[range] = secondary;
+            }, &recorded);
+        }
+
+        GetJobSystem().Wait(recorded);
+
+        // Submission order matches sub-mesh order regardless of which thread finished first
+        std::erase(secondaries, VK_NULL_HANDLE);
+        return secondaries;
+    }
+
+    // Records sub-meshes [first, last). Secondaries inherit no state, so each range rebinds everything.
+    void DrawModel(VkCommandBuffer cmd, const RenderSnapshot& snapshot, size_t first, size_t last)
+    {
+        if (first >= last)
+            return;
+
+        const bool pulling = snapshot.vertexPulling;
+
+        // Variants share one layout, so push constants and sets survive switching between them
+        VulkanGraphicsPipeline* pipeline = m_framePipelines[IsMaterialTextured(m_model.subMeshes[first].material)];
+        pipeline->Bind(cmd);
+        VulkanGraphicsPipeline::SetViewportAndScissor(cmd, m_swapchain->GetExtent());
+
+        const glm::mat4& model = snapshot.model;
+
+        // Earlier frames may still read their own camera slice
+        const uint32_t cameraOffset = m_frame.cameraOffset;
+
+        // Indices still go through the fixed-function path; only vertex fetch moves to the shader.
+        vkCmdBindIndexBuffer(cmd, m_ModelIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+        if (pulling)
+        {
+            VertexPullPushConstants ps{};
+            ps.model = model;
+            ps.light[0] = ps.light[1] = ps.light[2] = 5.0f;
+            ps.vertices = m_modelVertexBuffer.deviceAddress;
+            ps.SetLayout(m_modelPullLayout);
+
+            vkCmdPushConstants(
+                cmd,
+                pipeline->GetLayout(),
+                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                0,
+                sizeof(VertexPullPushConstants),
+                &ps
+            );
+        }
+        else
+        {
+            VkBuffer vertexBuffers[] = { m_modelVertexBuffer.buffer };
+            VkDeviceSize offsets[] = { 0 };
+            vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
+
+            PushConstants ps{};
+            ps.model = model;
+            ps.light = glm::vec3(5.0f, 5.0f, 5.0f);
+
+            vkCmdPushConstants(
+                cmd,
+                pipeline->GetLayout(),
+                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                0,
+                sizeof(PushConstants),
+                &ps
+            );
+        }
+
+        for (size_t i = first; i < last; ++i)
+        {
+            const auto& subMesh = m_model.subMeshes[i];
+
+            VulkanGraphicsPipeline* variant = m_framePipelines[IsMaterialTextured(subMesh.material)];
+            if (variant != pipeline)
+            {
+                pipeline = variant;
+                pipeline->Bind(cmd);
             }
+
+            VkDescriptorSet set = VK_NULL_HANDLE;
             if (subMesh.material >= 0 && subMesh.material < (int)m_materialDescriptors.size())
             {
                 set = m_materialDescriptors[subMesh.material]->GetSet();
@@ -460,18 +1102,20 @@ private:
                 set = m_descriptor->GetSet(); 
             }
 
+            if (set == VK_NULL_HANDLE)
+                continue;
+
             vkCmdBindDescriptorSets(
                 cmd,
                 VK_PIPELINE_BIND_POINT_GRAPHICS,
-                m_pipeline->GetLayout(),
+                pipeline->GetLayout(),
                 0, 1,
                 &set,
-                0, nullptr
+                1, &cameraOffset
             );
 
             vkCmdDrawIndexed(cmd, subMesh.indexCount, 1, subMesh.offset, 0, 0);
         }
-        yes = true;
     }
 
 
@@ -479,8 +1123,11 @@ private:
     {
         if (!m_Data.GetTriangleCount()) return;
         if (m_Data.materials.empty()) return;
+        if (m_modelLayout.sets.empty()) return;
 
         m_materialDescriptors.resize(m_Data.materials.size());
+        m_materialDiffuseTextures.resize(m_Data.materials.size());
+        m_materialTextured.assign(m_Data.materials.size(), 0);
 
         for (size_t i = 0; i < m_Data.materials.size(); ++i)
         {
@@ -488,20 +1135,22 @@ private:
             std::cout << "Descriptor[" << i << "] uses " << path << "\n";
 
 
+            const bool hasMap = !path.empty();
             if (path.empty())
                 path = "__white__"; 
 
-            auto tex = m_textureManager.LoadTexture(path) ? m_textureManager.GetTexture(path) : m_textureManager.GetTexture("__white__"); 
+            const bool loaded = m_textureManager.LoadTexture(path);
+            auto tex = loaded ? m_textureManager.GetTexture(path) : m_textureManager.GetTexture("__white__"); 
+            m_materialDiffuseTextures[i] = tex;
+            m_materialTextured[i] = hasMap && loaded;
 
 
             auto& p = m_materialDescriptors[i];
             p = std::make_shared<VulkanDescriptor>();
 
             p->Initialize(m_instance, m_device);
-            p->AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT);
-            p->AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
-
-            p->Build(1);
+            p->AddBindings(m_modelLayout.sets[0]);
+            p->Build(m_modelLayout.setLayouts[0], m_descriptorAllocator);
 
             p->BindBuffer(0, m_cameraUniformBuffer.buffer, sizeof(CameraUBO));
             p->BindImage(1, tex->GetImageView(), tex->GetSampler());
@@ -558,6 +1207,9 @@ private:
     void HookInput()
     {
         m_window->SetUpMouseAndKeyboard();
+        m_window->OnResized([this](int width, int height) {
+            m_swapchainDirty.store(true, std::memory_order_release);
+            });
         m_window->OnKeyEvent([&](int keyCode, bool isPressed) {
             Debug::DebugOutput::outputDebug("Key pressed: " + std::to_string(keyCode));
             });
@@ -570,16 +1222,37 @@ private:
         std::cout << m_swapchain->GetSwapchainInfo() << "\n";
         std::cout << m_renderPass->GetRenderPassInfo() << "\n";
         std::cout << m_pipeline->GetPipelineInfo() << "\n";
+
+        // Compare a first launch (cold) against a second (warm) to see what the cache saves
+        const bool warm = m_pipelineCache && m_pipelineCache->GetStats().warm;
+        std::cout << "Startup: " << m_startupMs << " ms, pipelines: " << m_pipelineMs
+                  << " ms, pipeline cache " << (warm ? "warm" : "cold") << "\n";
+        if (m_pipelineCache)
+            std::cout << m_pipelineCache->GetCacheInfo() << "\n";
+        std::cout << m_shaderCache->GetCacheInfo() << "\n";
+        std::cout << m_layoutCache.GetCacheInfo() << "\n";
+        std::cout << m_descriptorAllocator.GetAllocatorInfo() << "\n";
+        std::cout << "Graphics pipeline library: "
+                  << (m_device->IsGraphicsPipelineLibraryEnabled()
+                      ? (m_device->HasGraphicsPipelineLibraryFastLinking() ? "enabled, fast linking" : "enabled")
+                      : "unavailable, monolithic pipelines") << "\n";
     }
 
-    void BeginRenderPass(VkCommandBuffer cmd, uint32_t imageIndex)
+    VkFramebuffer GetFramebuffer(uint32_t imageIndex) const
+    {
+        return m_framebuffers[imageIndex]->GetFramebuffer();
+    }
+
+    void BeginRenderPass(VkCommandBuffer cmd, uint32_t imageIndex,
+        VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE)
     {
         auto clearValues = m_renderPass->GetDefaultClearValues();
         m_renderPass->Begin(
             cmd,
-            m_framebuffers[imageIndex]->GetFramebuffer(),
+            GetFramebuffer(imageIndex),
             m_swapchain->GetExtent(),
-            clearValues
+            clearValues,
+            contents
         );
     }
 
@@ -588,6 +1261,128 @@ private:
         m_renderPass->End(cmd);
     }
 
+    // Shows the telemetry copied at the last PublishSnapshot, one frame behind
+    void DrawMemoryPanel()
+    {
+        constexpr float toMB = 1.0f / (1024.0f * 1024.0f);
+        const MemoryStatistics& stats = m_memoryTelemetry.stats;
+
+        ImGui::Begin("Memory");
+        ImGui::Text("Used: %.1f MB / Blocks: %.1f MB (%u allocations)",
+            stats.totalUsedBytes * toMB, stats.totalAllocatedBytes * toMB, stats.allocationCount);
+        ImGui::Text("Device local: %.1f MB  Host visible: %.1f MB",
+            stats.deviceLocalBytes * toMB, stats.hostVisibleBytes * toMB);
+
+        for (size_t heap = 0; heap < stats.heapBudgets.size(); ++heap)
+        {
+            const VmaBudget& budget = stats.heapBudgets[heap];
+            const float fraction = budget.budget ? static_cast<float>(budget.usage) / static_cast<float>(budget.budget) : 0.0f;
+            const bool deviceLocal = (stats.heapFlags[heap] & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+
+            char overlay[64];
+            std::snprintf(overlay, sizeof(overlay), "%.0f / %.0f MB", budget.usage * toMB, budget.budget * toMB);
+            ImGui::Text("Heap %zu (%s)", heap, deviceLocal ? "VRAM" : "System");
+            ImGui::ProgressBar(fraction, ImVec2(-1.0f, 0.0f), overlay);
+        }
+
+        ImGui::Text("Pending deletions: %zu", m_memoryTelemetry.pendingDeletions);
+        if (m_sync->IsTimelineEnabled())
+            ImGui::Text("GPU timeline: %llu / %llu",
+                static_cast<unsigned long long>(m_memoryTelemetry.completedValue),
+                static_cast<unsigned long long>(m_memoryTelemetry.signaledValue));
+
+        const TransientAllocatorStats& transient = m_memoryTelemetry.transient;
+        ImGui::Text("Transient: %.1f MB for %.1f MB requested (%u images, %u slots, %.1f MB lazy)",
+            transient.allocatedBytes * toMB, transient.requestedBytes * toMB,
+            transient.imageCount, transient.slotCount, transient.lazyBytes * toMB);
+        ImGui::Text("Host-visible VRAM: %.0f MB  Uploads: %llu direct / %llu staged (%.2f MB staged)",
+            stats.hostVisibleDeviceLocalHeapBytes * toMB,
+            static_cast<unsigned long long>(stats.uploads.directUploads),
+            static_cast<unsigned long long>(stats.uploads.stagedUploads),
+            stats.uploads.stagedBytes * toMB);
+
+        ImGui::Separator();
+        for (size_t i = 0; i < stats.tags.size(); ++i)
+        {
+            ImGui::Text("%-12s %8.2f MB  (%u)", MemoryUsageTagToString(static_cast<MemoryUsageTag>(i)),
+                stats.tags[i].bytes * toMB, stats.tags[i].allocationCount);
+        }
+
+        ImGui::Separator();
+        for (size_t i = 1; i < stats.pools.size(); ++i)
+        {
+            const MemoryPoolStatistics& pool = stats.pools[i];
+            if (!pool.active)
+                continue;
+
+            char overlay[64];
+            std::snprintf(overlay, sizeof(overlay), "%.1f / %.1f MB (%u blocks)",
+                pool.allocationBytes * toMB, pool.blockBytes * toMB, pool.blockCount);
+
+            const float fraction = pool.budgetBytes
+                ? static_cast<float>(pool.blockBytes) / static_cast<float>(pool.budgetBytes)
+                : (pool.blockBytes ? static_cast<float>(pool.allocationBytes) / static_cast<float>(pool.blockBytes) : 0.0f);
+
+            ImGui::Text("Pool %s%s", MemoryPoolClassToString(static_cast<MemoryPoolClass>(i)),
+                pool.budgetBytes ? "" : " (unbounded)");
+            ImGui::ProgressBar(fraction, ImVec2(-1.0f, 0.0f), overlay);
+        }
+
+        if (ImGui::Button("Export JSON"))
+            m_exportRequested = true; // Written in PublishSnapshot, with the render thread idle
+
+        ImGui::SameLine();
+        if (m_memoryTelemetry.defragmenting)
+        {
+            ImGui::TextUnformatted("Defragmenting...");
+        }
+        else if (ImGui::Button("Defragment"))
+        {
+            m_defragRequested = true; // Started by the render thread, which owns the allocator's frame loop
+        }
+
+        const DefragmentationStats& defrag = m_memoryTelemetry.defrag;
+        ImGui::Text("Last defrag: %u moves, %.2f MB moved, %.2f MB freed (%u passes)",
+            defrag.allocationsMoved, defrag.bytesMoved * toMB, defrag.bytesFreed * toMB, defrag.passCount);
+
+        ImGui::End();
+    }
+
+    // Input is consumed once per frame, either in Update or late in Render
+    void ConsumeInput(float deltaTime)
+    {
+        if (!m_manualOverride)
+            CameraMovement(deltaTime);
+
+        if (Input::Get().IsKeyPressed(VK::Escape))
+        {
+            Quit(); 
+        }
+
+        Input::Get().Update();
+    }
+
+    void DrawPacingControls()
+    {
+        if (ImGui::Checkbox("Pipelined", &m_pipelined))
+            SetPipelined(m_pipelined);
+        if (ImGui::Checkbox("Late latching", &m_lateLatching))
+            SetLateLatching(m_lateLatching);
+        if (m_lateLatching && IsPipelined())
+        {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(serial only)");
+        }
+
+        if (ImGui::Checkbox("Cap frame rate", &m_capped))
+            setCapped(m_capped);
+
+        const FramePacerStats pacing = GetFramePacerStats();
+        ImGui::Text("Frame %.2f ms (target %.2f), jitter %.2f ms, worst %.2f ms",
+            pacing.averageMs, pacing.targetMs, pacing.jitterMs, pacing.worstMs);
+        ImGui::Text("Spin margin %.2f ms, missed %u", pacing.sleepMarginMs, pacing.missed);
+    }
+
     void CameraMovement(float deltaTime)
     {
         if (Input::Get().IsKeyDown(VK::W))
@@ -621,6 +1416,14 @@ private:
     std::shared_ptr<VulkanRenderPass> m_renderPass;
     std::vector<std::shared_ptr<VulkanFrameBuffer>> m_framebuffers;
     std::shared_ptr<VulkanGraphicsPipeline> m_pipeline;
+    std::shared_ptr<VulkanGraphicsPipeline> m_pullPipeline;
+    std::shared_ptr<VulkanPipelineCache> m_pipelineCache;
+    std::shared_ptr<VulkanShaderModuleCache> m_shaderCache;
+    VulkanDescriptorLayoutCache m_layoutCache;
+    VulkanDescriptorAllocator m_descriptorAllocator;
+    ReflectedPipelineLayout m_modelLayout;
+    VulkanPipelineLibrary m_pipelineLibrary;
+    VulkanGraphicsPipeline* m_framePipelines[2] = {}; // [untextured, textured]; render thread only
     std::shared_ptr<VulkanCommandBuffer> m_commandBuffer;
     std::shared_ptr<VulkanSynchronization> m_sync;
     std::shared_ptr<VulkanMemoryAllocator> m_allocator;
@@ -631,19 +1434,27 @@ private:
 
     std::vector<std::shared_ptr<VulkanDescriptor>> m_materialDescriptors;
     std::vector<std::shared_ptr<Texture>> m_materialDiffuseTextures;
+    std::vector<uint8_t> m_materialTextured; // Picks the USE_TEXTURE variant per material
 
     std::shared_ptr<VulkanDescriptor> m_defaultMaterialDescriptor;
     std::shared_ptr<Texture> m_defaultDiffuseTexture;
     
-    std::vector<TextureInfo> m_depthImages; 
+    VulkanRenderGraph m_renderGraph;
+    uint32_t m_backbufferResource = VulkanRenderGraph::InvalidResource;
+    uint32_t m_depthResource = VulkanRenderGraph::InvalidResource;
+    uint32_t m_sceneImageIndex = 0;
+    std::vector<VkCommandBuffer> m_sceneSecondaries;
 
     VkDescriptorPool m_imguiPool = VK_NULL_HANDLE;
 
-    std::vector<VkCommandBuffer> m_commandBuffers;
-    uint32_t m_currentFrame = 0;
+    FrameContexts m_frames;
+    FrameContext m_frame; // Slot Render is recording; read by its recording jobs
+    uint32_t m_rejectedFramesInFlight = 0; // Last count m_frames refused
+    uint64_t m_frameNumber = 0;
 
     AllocatedBuffer m_vertexBuffer;
     AllocatedBuffer m_cameraUniformBuffer;
+    uint32_t m_cameraStride = 0;
     AllocatedBuffer m_ModelIndexBuffer;
     AllocatedBuffer m_modelVertexBuffer;
 
@@ -654,9 +1465,23 @@ private:
     std::shared_ptr<Texture> m_brickTexture;
 
     GraphicsPipelineConfig m_pendingPipelineConfig{};
+    GraphicsPipelineConfig m_pullPipelineConfig{};
     Model::ModelMesh m_model;
     uint32_t m_modelIndexCount = 0;
+    VertexPullLayout m_modelPullLayout;
+    bool m_useVertexPulling = false;
+    int m_cullMode = 0;
+    bool m_lighting = true;
+    bool m_alphaTest = false;
+    bool m_defragRequested = false;
+    bool m_exportRequested = false;
+    MemoryTelemetry m_memoryTelemetry; // Main thread only
     float m_rotation = 0.0f;
+    FrameSnapshot<RenderSnapshot> m_snapshots;
+    double m_startupMs = 0.0;
+    double m_pipelineMs = 0.0;
+    std::atomic<bool> m_swapchainDirty = false; // Set by resize or out-of-date, taken by RecreateSwapchain
+    double m_resizeMs = 0.0;
     int maxFOV = 90; 
     float r{ 0 }, b{ 0 }, g{ 0 }, alpha{ 1 };
 };
@@ -11,19 +11,29 @@
 #include "../Core/Renderer/VulkanRenderPass/VulkanRenderPass.h"
 #include "../Core/Renderer/VulkanFrameBuffer/VulkanFrameBuffer.h"
 #include "../Core/Renderer/VulkanGraphicsPipeline/VulkanGraphicsPipeline.h"
+#include "../Core/Renderer/VulkanPipelineCache/VulkanPipelineCache.h"
+#include "../Core/Renderer/VulkanPipelineLibrary/VulkanPipelineLibrary.h"
+#include "../Core/Renderer/VulkanShaderModuleCache/VulkanShaderModuleCache.h"
+#include "../Core/Renderer/VulkanShaderReflection/VulkanDescriptorLayoutCache.h"
 #include "../Core/Renderer/VulkanCommandBuffer/VulkanCommandBuffer.h"
 #include "../Core/Renderer/VulkanMemoryAllocator/VulkanMemoryAllocator.h"
 #include "../Core/Renderer/VulkanSynchronization/VulkanSynchronization.h"
+#include "../Core/Renderer/VulkanTransientAllocator/VulkanTransientAllocator.h"
+#include "../Core/Renderer/VulkanRenderGraph/VulkanRenderGraph.h"
 #include "../Core/Application/Application.h"
 #include "../Core/Application/WindowSpec/WindowSpec.h"
 #include "../Core/Renderer/VertexTypes/Vertex.h"
+#include "../Core/Renderer/VertexTypes/VertexPulling.h"
 #include "../Core/Camera/Camera.h"
 #include "../Core/Renderer/VulkanDescriptor/VulkanDescriptor.h"
+#include "../Core/Renderer/VulkanDescriptor/VulkanDescriptorAllocator.h"
 #include "../Core/TextureManager/Vulkan/TextureManager.h"
 #include "../Core/Loaders/ModelLoader.h"
 #include "../Core/Input/Input.h"
 #include <chrono>
+#include <thread>
 #include <algorithm>
+#include <utility>
 #include <print>
 #include <cmath>
 #include "imgui.h"
@@ -1,30 +1,45 @@
 #include "Application.h"
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <iostream>
 
 // Update(float deltaTime) and Render() not defined here and are virtual;
 
 //Constructor And The Deconstructor
-Application::Application() : options(60, 1920, 1080) {}
+Application::Application() : options(60, 1920, 1080) { m_jobs.Initialize(); }
 
 Application::Application(int frameRate, int width, int height)
-	: options(frameRate, width, height) {}
+	: options(frameRate, width, height) { m_jobs.Initialize(); }
 
-Application::~Application() {}
+Application::~Application() { m_jobs.Shutdown(); }
 
 // Engine Specific Functions
 
 void Application::Run() {
+	//Each mode returns when the other is requested, so the loop can switch at runtime
+	while (m_running) {
+		if (UsePipelined())
+			RunPipelined(); 
+		else
+			RunSerial(); 
+	}
+
+	//Workers finish what is queued before the derived class starts tearing down
+	m_jobs.Shutdown(); 
+}
+
+void Application::RunSerial() {
 	//Intailizing the lastTime to start run as well as target time for frames
 	auto lastTime = chronoHighResClock::now();
-	const float targetFrameTime = 1.0f / options.targetFrameRate; 
 	// Calling update every frame and calculate deltaTime;  
-	while (m_running) {
+	while (m_running && !UsePipelined()) {
 		auto timeNow = chronoHighResClock::now();
 		auto deltaTime = std::chrono::duration<float>(timeNow - lastTime).count(); 
+		m_jobs.PumpMainThread(); 
 		Update(deltaTime); 
+		PublishSnapshot(); 
 		Render();
-		const float frameTime = std::chrono::duration<float>(chronoHighResClock::now() - timeNow).count();
 		/*
 		
 		{
@@ -33,14 +48,79 @@ void Application::Run() {
 		}
 	
 		*/
-		if (options.capped)
-		{
-			if (frameTime < targetFrameTime) {
-				std::this_thread::sleep_for(std::chrono::duration<float>(targetFrameTime - frameTime)); 
+		PaceFrame(); 
+		lastTime = timeNow; 
+	}
+}
+
+void Application::RunPipelined() {
+	//Handoff between this (simulation) thread and the render thread: frameReady means a
+	//published snapshot is waiting for or being rendered
+	std::mutex handoffMutex; 
+	std::condition_variable handoff; 
+	bool frameReady = false; 
+	bool stopping = false; 
+
+	m_renderThreadActive = true; 
+	std::thread renderThread([&]() {
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(handoffMutex);
+				handoff.wait(lock, [&]() { return frameReady || stopping; });
+				if (!frameReady)
+					break;
+			}
+
+			Render();
+
+			{
+				std::lock_guard<std::mutex> lock(handoffMutex);
+				frameReady = false;
 			}
+			handoff.notify_all();
 		}
+	});
+
+	auto lastTime = chronoHighResClock::now();
+	while (m_running && UsePipelined()) {
+		auto timeNow = chronoHighResClock::now();
+		auto deltaTime = std::chrono::duration<float>(timeNow - lastTime).count(); 
+		m_jobs.PumpMainThread(); 
+
+		//Overlaps with the render thread recording the previous frame
+		Update(deltaTime); 
+
+		{
+			std::unique_lock<std::mutex> lock(handoffMutex);
+			handoff.wait(lock, [&]() { return !frameReady; });
+		}
+
+		PublishSnapshot(); 
+
+		{
+			std::lock_guard<std::mutex> lock(handoffMutex);
+			frameReady = true;
+		}
+		handoff.notify_all();
+
+		PaceFrame(); 
 		lastTime = timeNow; 
 	}
+
+	{
+		std::unique_lock<std::mutex> lock(handoffMutex);
+		handoff.wait(lock, [&]() { return !frameReady; });
+		stopping = true;
+	}
+	handoff.notify_all();
+	renderThread.join(); 
+	m_renderThreadActive = false; 
+}
+
+void Application::PaceFrame() {
+	//Deadline based, so time spent in Update and Render comes out of the wait rather than adding to it
+	m_pacer.SetTarget(options.targetFrameRate, options.capped); 
+	m_pacer.Wait(); 
 }
 
 // Window Specific Options
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <chrono>
+#include <atomic>
 #include "WindowSpec/WindowSpec.h"
+#include "../Jobs/JobSystem.h"
+#include "FrameSnapshot.h"
+#include "FramePacer.h"
 
 using chronoHighResClock = std::chrono::high_resolution_clock; 
 
@@ -17,19 +21,53 @@ public:
 	virtual void Update(float deltaTime) {};
 	virtual void Render() {};
 
+	//Called between Update and Render with the render thread idle; swap FrameSnapshots here
+	virtual void PublishSnapshot() {};
+
 	//Engine Implemented Functions. 
 	void Run(); 
 	void Quit() { m_running = false;}
 
+	//Pipelined: Update for frame N+1 runs while a render thread records frame N. Can change
+	//from Update; the switch happens between frames.
+	void SetPipelined(bool pipelined) { m_pipelined = pipelined; }
+	bool IsPipelined() const { return m_pipelined; }
+
+	//Late latching: sample input and the camera in Render right before recording instead of
+	//in Update. Window messages must be pumped on the window's thread, so it only applies
+	//while Render runs on the main thread (serial mode).
+	void SetLateLatching(bool lateLatching) { m_lateLatching = lateLatching; }
+	bool IsLateLatching() const { return m_lateLatching && !m_renderThreadActive; }
+
+	//Frame pacing, measured even when uncapped
+	void setCapped(bool capped) { options.setCapped(capped); }
+	FramePacerStats GetFramePacerStats() const { return m_pacer.GetStats(); }
+
 	//Set Window Settings
 	void setWindowOptions(int frameRate, int width, int height); 
 	const windowSpec::WindowOptions& getWindowSettings() const; 
 
+	//Job system, running from construction until Run returns
+	JobSystem& GetJobSystem() { return m_jobs; }
+
 private:
 
 	//Running bool and options for window;
-	bool m_running = true; 
+	std::atomic<bool> m_running = true; 
+	bool m_pipelined = false;
+	bool m_lateLatching = false;
+	bool m_renderThreadActive = false;
 	windowSpec::WindowOptions options;
+	FramePacer m_pacer;
+
+	//Started before the derived constructor so loading can already use it
+	JobSystem m_jobs;
+
+	void RunSerial();
+	void RunPipelined();
+	//Pipelining needs a worker besides the render thread, or its jobs would have nowhere to run
+	bool UsePipelined() const { return m_pipelined && m_jobs.GetWorkerCount() > 0; }
+	void PaceFrame();
 
 };
 
@@ -0,0 +1,115 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+	constexpr auto MinSleepMargin = std::chrono::microseconds(250);
+	constexpr auto MaxSleepMargin = std::chrono::microseconds(16000); // Worst case default timer tick on Windows
+}
+
+void FramePacer::SetTarget(int frameRate, bool capped)
+{
+	if (frameRate == m_frameRate && capped == m_capped)
+		return;
+
+	m_frameRate = frameRate;
+	m_capped = capped && frameRate > 0;
+	m_period = m_capped
+		? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / frameRate))
+		: Clock::duration::zero();
+	Reset();
+}
+
+void FramePacer::Reset()
+{
+	m_deadline = Clock::now() + m_period;
+	m_historyCount = 0;
+	m_historyNext = 0;
+	m_missed = 0;
+	m_started = false;
+}
+
+void FramePacer::Wait()
+{
+	if (m_capped)
+	{
+		const auto now = Clock::now();
+		if (now < m_deadline)
+		{
+			SleepUntil(m_deadline);
+		}
+		else if (now - m_deadline > m_period)
+		{
+			// Too far behind to catch up; racing through the missed slots would only add jitter
+			m_deadline = now;
+			m_missed++;
+		}
+
+		m_deadline += m_period;
+	}
+
+	Record(Clock::now());
+}
+
+void FramePacer::SleepUntil(Clock::time_point deadline)
+{
+	const auto wakeTarget = deadline - m_sleepMargin;
+	if (Clock::now() < wakeTarget)
+	{
+		std::this_thread::sleep_until(wakeTarget);
+
+		// Keep the margin just above what the OS overshoots by, decaying slowly so one
+		// bad wake does not cost spin time forever
+		const auto overshoot = Clock::now() - wakeTarget;
+		const auto decayed = m_sleepMargin - m_sleepMargin / 64;
+		const Clock::duration ceiling = std::min<Clock::duration>(MaxSleepMargin, m_period);
+		m_sleepMargin = std::clamp<Clock::duration>(std::max<Clock::duration>(decayed, overshoot + overshoot / 4),
+			std::min<Clock::duration>(MinSleepMargin, ceiling), ceiling);
+	}
+
+	while (Clock::now() < deadline)
+		std::this_thread::yield();
+}
+
+void FramePacer::Record(Clock::time_point now)
+{
+	if (m_started)
+	{
+		m_history[m_historyNext] = std::chrono::duration<float, std::milli>(now - m_lastFrame).count();
+		m_historyNext = (m_historyNext + 1) % HistorySize;
+		m_historyCount = std::min(m_historyCount + 1, HistorySize);
+	}
+
+	m_lastFrame = now;
+	m_started = true;
+}
+
+FramePacerStats FramePacer::GetStats() const
+{
+	FramePacerStats stats;
+	stats.targetMs = std::chrono::duration<float, std::milli>(m_period).count();
+	stats.sleepMarginMs = m_capped ? std::chrono::duration<float, std::milli>(m_sleepMargin).count() : 0.0f;
+	stats.samples = m_historyCount;
+	stats.missed = m_missed;
+
+	if (m_historyCount == 0)
+		return stats;
+
+	float sum = 0.0f;
+	for (uint32_t i = 0; i < m_historyCount; i++)
+		sum += m_history[i];
+	stats.averageMs = sum / m_historyCount;
+
+	float variance = 0.0f;
+	for (uint32_t i = 0; i < m_historyCount; i++)
+	{
+		const float deviation = m_history[i] - stats.averageMs;
+		variance += deviation * deviation;
+		stats.worstMs = std::max(stats.worstMs, std::abs(deviation));
+	}
+	stats.jitterMs = std::sqrt(variance / m_historyCount);
+
+	return stats;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+struct FramePacerStats
+{
+	float targetMs = 0.0f;      // 0 when uncapped
+	float averageMs = 0.0f;     // Achieved frame time
+	float jitterMs = 0.0f;      // Standard deviation of the frame time
+	float worstMs = 0.0f;       // Largest distance from the average
+	float sleepMarginMs = 0.0f; // Spun instead of slept before each deadline
+	uint32_t samples = 0;
+	uint32_t missed = 0;        // Deadlines passed by more than a whole frame
+};
+
+// Holds frames to a fixed period against absolute deadlines, so an early or late frame
+// does not shift every frame after it. The OS sleep overshoots by up to a timer tick, so
+// it sleeps until a margin before the deadline and spins the rest on the high resolution
+// clock. The margin follows the overshoot it observes.
+class FramePacer
+{
+public:
+	using Clock = std::chrono::high_resolution_clock;
+
+	// Config
+	void SetTarget(int frameRate, bool capped); // Cheap to call every frame; restarts the schedule on change
+	void Reset(); // Next deadline is a period from now
+
+	// Call once per frame. Returns immediately when uncapped but still measures the frame.
+	void Wait();
+
+	// Getters
+	bool IsCapped() const { return m_capped; }
+	FramePacerStats GetStats() const;
+
+private:
+	static constexpr uint32_t HistorySize = 120;
+
+	Clock::duration m_period{};
+	Clock::time_point m_deadline{};
+	Clock::time_point m_lastFrame{};
+	Clock::duration m_sleepMargin = std::chrono::microseconds(2000);
+	int m_frameRate = 0;
+	bool m_capped = false;
+	bool m_started = false;
+
+	std::array<float, HistorySize> m_history{}; // Frame times in ms
+	uint32_t m_historyNext = 0;
+	uint32_t m_historyCount = 0;
+	uint32_t m_missed = 0;
+
+	void SleepUntil(Clock::time_point deadline);
+	void Record(Clock::time_point now);
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Double-buffered render state. The simulation fills Write() while the render thread
+// reads Read(); Publish() swaps them and must only run while neither side is using
+// them (Application calls PublishSnapshot at exactly that point).
+template <typename T>
+class FrameSnapshot
+{
+public:
+	T& Write() { return m_slots[m_write]; }
+	T& Read() { return m_slots[m_write ^ 1u]; }
+	const T& Read() const { return m_slots[m_write ^ 1u]; }
+	void Publish() { m_write ^= 1u; }
+
+private:
+	std::array<T, 2> m_slots{};
+	uint32_t m_write = 0;
+};
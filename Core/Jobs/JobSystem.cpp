@@ -0,0 +1,371 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+const Debug::DebugOutput JobSystem::DebugOut;
+
+// Index of the calling thread within the running system; one system per process
+static thread_local uint32_t t_threadIndex = JobSystem::InvalidThread;
+
+JobSystem::JobSystem()
+{}
+
+JobSystem::~JobSystem()
+{
+    Shutdown();
+}
+
+bool JobSystem::Initialize(uint32_t workerCount)
+{
+    if (m_initialized)
+    {
+        ReportWarning("Already initialized. 0x00024000");
+        return true;
+    }
+
+    if (workerCount == 0)
+    {
+        const uint32_t hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 1 ? hardware - 1 : 0; // With no workers the main thread runs everything in Wait
+    }
+
+    try
+    {
+        m_queues.clear();
+        for (uint32_t i = 0; i <= workerCount; i++)
+            m_queues.push_back(std::make_unique<WorkQueue>());
+
+        t_threadIndex = 0;
+        m_running = true;
+        m_initialized = true;
+
+        for (uint32_t i = 1; i <= workerCount; i++)
+            m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        ReportError("Exception during initialization: " + std::string(e.what()) + " 0x00024010");
+        Shutdown();
+        return false;
+    }
+    catch (...)
+    {
+        ReportError("Unknown exception during initialization. 0x00024020");
+        Shutdown();
+        return false;
+    }
+}
+
+void JobSystem::Shutdown()
+{
+    if (!m_initialized)
+        return;
+
+    m_running = false;
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_workers.clear();
+
+    // Anything scheduled by the last jobs still runs, here on the main thread
+    Job job;
+    while (TryPop(0, job) || TryPopMain(job))
+        Run(job);
+
+    m_queues.clear();
+    m_pending = 0;
+    m_initialized = false;
+    t_threadIndex = InvalidThread;
+}
+
+uint32_t JobSystem::GetCurrentThreadIndex()
+{
+    return t_threadIndex;
+}
+
+JobSystemStats JobSystem::GetStats() const
+{
+    JobSystemStats stats;
+    stats.executed = m_executed.load(std::memory_order_relaxed);
+    stats.stolen = m_stolen.load(std::memory_order_relaxed);
+    stats.mainThread = m_mainExecuted.load(std::memory_order_relaxed);
+    return stats;
+}
+
+JobSystem::Job JobSystem::Wrap(std::function<void()> work, JobCounter* counter)
+{
+    return [this, work = std::move(work), counter]()
+    {
+        try
+        {
+            work();
+        }
+        catch (const std::exception& e)
+        {
+            ReportError("Job threw: " + std::string(e.what()) + " 0x00024100");
+        }
+        catch (...)
+        {
+            ReportError("Job threw an unknown exception. 0x00024110");
+        }
+
+        Finish(counter);
+    };
+}
+
+void JobSystem::Finish(JobCounter* counter)
+{
+    if (!counter)
+        return;
+
+    // The count drops under the counter's lock, and the continuations leave with it, so
+    // once Wait has taken the lock after seeing zero this call is done with the counter
+    // and the owner may destroy it. Their own counters were incremented when scheduled.
+    std::vector<JobCounter::Continuation> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->m_mutex);
+        if (counter->m_count.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        ready.swap(counter->m_continuations);
+    }
+
+    for (auto& continuation : ready)
+    {
+        Job job = Wrap(std::move(continuation.work), continuation.counter);
+        if (m_initialized)
+            Push(std::move(job), continuation.affinity);
+        else
+            job();
+    }
+}
+
+void JobSystem::Schedule(std::function<void()> work, JobCounter* counter, JobAffinity affinity)
+{
+    if (counter)
+        counter->m_count.fetch_add(1, std::memory_order_relaxed);
+
+    Job job = Wrap(std::move(work), counter);
+
+    if (!m_initialized)
+    {
+        job(); // No threads to hand it to
+        return;
+    }
+
+    Push(std::move(job), affinity);
+}
+
+void JobSystem::ScheduleAfter(JobCounter& dependency, std::function<void()> work,
+    JobCounter* counter, JobAffinity affinity)
+{
+    if (counter)
+        counter->m_count.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        // Finish drops the count under this lock, so a continuation added while the
+        // count is still non-zero is always picked up
+        std::lock_guard<std::mutex> lock(dependency.m_mutex);
+        if (dependency.m_count.load(std::memory_order_acquire) != 0)
+        {
+            dependency.m_continuations.push_back({ std::move(work), counter, affinity });
+            return;
+        }
+    }
+
+    Job job = Wrap(std::move(work), counter);
+    if (m_initialized)
+        Push(std::move(job), affinity);
+    else
+        job();
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t minBatch,
+    const std::function<void(uint32_t, uint32_t)>& work, JobCounter& counter)
+{
+    if (count == 0)
+        return;
+
+    minBatch = std::max(minBatch, 1u);
+    const uint32_t batches = std::clamp(count / minBatch, 1u, GetThreadCount());
+
+    // Shared so the ranges stay valid even if the caller's function goes out of scope
+    auto shared = std::make_shared<std::function<void(uint32_t, uint32_t)>>(work);
+
+    for (uint32_t batch = 0; batch < batches; batch++)
+    {
+        const uint32_t begin = static_cast<uint32_t>(uint64_t(count) * batch / batches);
+        const uint32_t end = static_cast<uint32_t>(uint64_t(count) * (batch + 1) / batches);
+        Schedule([shared, begin, end]() { (*shared)(begin, end); }, &counter);
+    }
+}
+
+void JobSystem::Push(Job job, JobAffinity affinity)
+{
+    if (affinity == JobAffinity::MainThread)
+    {
+        std::lock_guard<std::mutex> lock(m_mainQueue.mutex);
+        m_mainQueue.jobs.push_back(std::move(job));
+        return;
+    }
+
+    // Threads outside the system spread their jobs over the workers
+    uint32_t index = t_threadIndex;
+    if (index >= m_queues.size())
+    {
+        const uint32_t workers = GetWorkerCount();
+        index = workers ? 1 + m_nextQueue.fetch_add(1, std::memory_order_relaxed) % workers : 0;
+    }
+
+    // Counted before it is visible, so a thief's decrement can never run ahead of it
+    m_pending.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->jobs.push_back(std::move(job));
+    }
+
+    // Taking the lock orders this push against a worker checking m_pending before it sleeps
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+}
+
+bool JobSystem::TryPop(uint32_t index, Job& outJob)
+{
+    if (m_pending.load(std::memory_order_acquire) == 0)
+        return false;
+
+    {
+        WorkQueue& own = *m_queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            outJob = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    const uint32_t count = static_cast<uint32_t>(m_queues.size());
+    for (uint32_t offset = 1; offset < count; offset++)
+    {
+        WorkQueue& victim = *m_queues[(index + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.empty())
+            continue;
+
+        outJob = std::move(victim.jobs.front());
+        victim.jobs.pop_front();
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+        m_stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+bool JobSystem::TryPopMain(Job& outJob)
+{
+    std::lock_guard<std::mutex> lock(m_mainQueue.mutex);
+    if (m_mainQueue.jobs.empty())
+        return false;
+
+    outJob = std::move(m_mainQueue.jobs.front());
+    m_mainQueue.jobs.pop_front();
+    m_mainExecuted.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void JobSystem::Run(Job& job)
+{
+    job();
+    job = nullptr;
+    m_executed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JobSystem::WorkerLoop(uint32_t index)
+{
+    t_threadIndex = index;
+
+    Job job;
+    while (true)
+    {
+        if (TryPop(index, job))
+        {
+            Run(job);
+            continue;
+        }
+
+        if (!m_running.load(std::memory_order_acquire))
+            break;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this]() {
+            return m_pending.load(std::memory_order_acquire) > 0 || !m_running.load(std::memory_order_acquire);
+        });
+    }
+
+    t_threadIndex = InvalidThread;
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    if (!m_initialized)
+    {
+        if (!counter.IsDone())
+            ReportError("Waiting on a counter that cannot finish without workers. 0x00024200");
+        std::lock_guard<std::mutex> lock(counter.m_mutex);
+        return;
+    }
+
+    const uint32_t index = t_threadIndex;
+    const bool member = index < m_queues.size();
+
+    Job job;
+    while (!counter.IsDone())
+    {
+        if (index == 0 && TryPopMain(job))
+        {
+            Run(job);
+            continue;
+        }
+
+        // Helping instead of blocking keeps nested waits from starving the pool
+        if (member && TryPop(index, job))
+        {
+            Run(job);
+            continue;
+        }
+
+        std::this_thread::yield();
+    }
+
+    // The last Finish may still be inside its critical section; let it leave before the
+    // caller is free to destroy the counter
+    std::lock_guard<std::mutex> lock(counter.m_mutex);
+}
+
+void JobSystem::PumpMainThread()
+{
+    if (!m_initialized)
+        return;
+
+    if (!IsMainThread())
+    {
+        ReportError("PumpMainThread called off the main thread. 0x00024300");
+        return;
+    }
+
+    Job job;
+    while (TryPopMain(job))
+        Run(job);
+}
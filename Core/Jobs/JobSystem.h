@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../DebugOutput/DubugOutput.h"
+
+// Work-stealing job scheduler
+// Error codes: 0x00024000-0x00024FFF
+
+enum class JobAffinity
+{
+    Any,        // Runs on whichever thread gets to it first
+    MainThread  // Runs only on the thread that initialized the system
+};
+
+// Counts unfinished jobs. Scheduling against a counter increments it and the job
+// decrements it when done; jobs scheduled after a counter start once it reaches zero.
+// A counter can be reused, or destroyed, once a Wait on it has returned; IsDone alone
+// does not mean the last job has let go of it.
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const { return m_count.load(std::memory_order_acquire) == 0; }
+    uint32_t GetValue() const { return m_count.load(std::memory_order_acquire); }
+
+private:
+    friend class JobSystem;
+
+    struct Continuation
+    {
+        std::function<void()> work;
+        JobCounter* counter = nullptr;
+        JobAffinity affinity = JobAffinity::Any;
+    };
+
+    std::atomic<uint32_t> m_count{ 0 };
+    std::mutex m_mutex;
+    std::vector<Continuation> m_continuations;
+};
+
+struct JobSystemStats
+{
+    uint64_t executed = 0;
+    uint64_t stolen = 0;      // Taken from another thread's deque
+    uint64_t mainThread = 0;  // Main-thread affinity jobs run
+};
+
+// Each thread owns a deque: it pushes and pops at the back (most recent, cache-warm
+// work first), and idle threads steal from the front of others. The main thread owns
+// deque 0 and only runs jobs while it waits or pumps, so it never sleeps in here.
+class JobSystem
+{
+public:
+    static constexpr uint32_t InvalidThread = UINT32_MAX;
+
+    JobSystem();
+    ~JobSystem();
+
+    // RAII
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Lifecycle
+    bool Initialize(uint32_t workerCount = 0); // 0 picks hardware threads - 1; call on the main thread
+    void Shutdown(); // Finishes queued jobs, then joins the workers
+    bool IsInitialized() const { return m_initialized; }
+
+    // Scheduling
+    void Schedule(std::function<void()> work, JobCounter* counter = nullptr,
+        JobAffinity affinity = JobAffinity::Any);
+    void ScheduleAfter(JobCounter& dependency, std::function<void()> work,
+        JobCounter* counter = nullptr, JobAffinity affinity = JobAffinity::Any);
+
+    // Splits [0, count) into ranges of at least minBatch and calls work(begin, end) for each
+    void ParallelFor(uint32_t count, uint32_t minBatch,
+        const std::function<void(uint32_t, uint32_t)>& work, JobCounter& counter);
+
+    // Waiting
+    void Wait(JobCounter& counter); // Runs other jobs until the counter reaches zero
+    void PumpMainThread();          // Runs queued main-thread jobs; main thread only
+
+    // Getters
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+    uint32_t GetThreadCount() const { return GetWorkerCount() + 1; } // Workers plus the main thread
+    JobSystemStats GetStats() const;
+    static uint32_t GetCurrentThreadIndex(); // 0 is the main thread; InvalidThread outside the system
+    static bool IsMainThread() { return GetCurrentThreadIndex() == 0; }
+
+private:
+    using Job = std::function<void()>;
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues; // One per thread, index 0 is main
+    std::vector<std::thread> m_workers;
+    WorkQueue m_mainQueue; // Main-thread affinity
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<uint32_t> m_pending{ 0 }; // Jobs waiting in m_queues
+    std::atomic<bool> m_running{ false };
+    std::atomic<uint32_t> m_nextQueue{ 0 };
+    bool m_initialized = false;
+
+    std::atomic<uint64_t> m_executed{ 0 };
+    std::atomic<uint64_t> m_stolen{ 0 };
+    std::atomic<uint64_t> m_mainExecuted{ 0 };
+
+    static const Debug::DebugOutput DebugOut;
+
+    void WorkerLoop(uint32_t index);
+    void Push(Job job, JobAffinity affinity);
+    bool TryPop(uint32_t index, Job& outJob);
+    bool TryPopMain(Job& outJob);
+    void Run(Job& job);
+    Job Wrap(std::function<void()> work, JobCounter* counter);
+    void Finish(JobCounter* counter);
+
+    void ReportError(const std::string& message) const
+    {
+        DebugOut.outputDebug("JobSystem Error: " + message);
+    }
+
+    void ReportWarning(const std::string& message) const
+    {
+        DebugOut.outputDebug("JobSystem Warning: " + message);
+    }
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Hash
+{
+    // 64-bit FNV-1a. Stable across runs and platforms, so it is safe to store in files.
+    // It guards cache keys and checksums against truncation and bit rot, not tampering.
+    inline uint64_t Fnv1a(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    inline uint64_t Fnv1a(const std::string& bytes)
+    {
+        return Fnv1a(bytes.data(), bytes.size());
+    }
+}
@@ -108,6 +108,51 @@ void Texture::Destroy()
     }
 }
 
+void Texture::DeferDestroy()
+{
+    if (!IsValid()) {
+        return;
+    }
+
+    if (!m_imageManager || !m_device || !m_imageManager->GetAllocator()) {
+        Destroy();
+        return;
+    }
+
+    VkDevice device = m_device->GetDevice();
+    VkImageView view = m_info.imageView.view;
+    VkSampler sampler = m_info.sampler;
+
+    // View and sampler are queued ahead of the image so they go first
+    m_imageManager->GetAllocator()->DeferDestruction([device, view, sampler]() {
+        vkDestroyImageView(device, view, nullptr);
+        vkDestroySampler(device, sampler, nullptr);
+    });
+    m_imageManager->DeferDestroyImage(m_info.image);
+
+    m_info.imageView = {};
+    m_info.sampler = VK_NULL_HANDLE;
+}
+
+bool Texture::RecreateView()
+{
+    if (!m_viewManager || !m_info.image.IsValid())
+    {
+        ReportError("Cannot recreate view without image. 0x0013F300");
+        return false;
+    }
+
+    m_viewManager->DestroyView(m_info.imageView);
+
+    if (!m_viewManager->CreateView(m_info.image, m_info.imageView, ImageViewOptions::Default2D()))
+    {
+        ReportError("Failed to recreate view. 0x0013F310");
+        return false;
+    }
+
+    return true;
+}
+
 bool Texture::CreateSampler(const SamplerOptions& options) 
 {
     if (!m_device) 
@@ -174,6 +219,7 @@ bool Texture::LoadFromFile(
     imageOpts.format = VK_FORMAT_R8G8B8A8_SRGB;
 
     imageOpts.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
         VK_IMAGE_USAGE_SAMPLED_BIT;
     imageOpts.mipLevels = 1;
 
@@ -84,8 +84,12 @@ public:
         const SamplerOptions& samplerOpts = SamplerOptions::DefaultLinear());
 
     void Destroy();
+    void DeferDestroy(); // Frees once the GPU finished the current frame; no device stall
     bool IsValid() const { return m_info.IsValid(); }
 
+    // Rebuilds the view after the image handle changed (defragmentation)
+    bool RecreateView();
+
     VkImageView GetImageView() const { return m_info.imageView.view; }
     VkSampler GetSampler() const { return m_info.sampler; }
     const TextureInfo& GetInfo() const { return m_info; }
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "../../../Headers/GlmConfig.h"
+#include <cstddef>
+#include <cstdint>
+#include "Vertex.h"
+#include "ModelVertex.h"
+
+// Describes a vertex struct to Shaders/model_pull.vert, which reads vertices as raw
+// floats through a buffer reference. Stride and offsets are in floats, not bytes,
+// so one pipeline can draw any of these formats without vertex input state.
+struct VertexPullLayout
+{
+    static constexpr uint32_t Missing = UINT32_MAX; // Shader substitutes a default
+
+    uint32_t stride = 0;
+    uint32_t position = Missing;
+    uint32_t normal = Missing;
+    uint32_t texCoord = Missing;
+    uint32_t color = Missing;
+
+    static VertexPullLayout ForVertex()
+    {
+        VertexPullLayout layout;
+        layout.stride = sizeof(Vertex) / sizeof(float);
+        layout.position = offsetof(Vertex, position) / sizeof(float);
+        layout.color = offsetof(Vertex, color) / sizeof(float);
+        return layout;
+    }
+
+    static VertexPullLayout ForModelVertex()
+    {
+        VertexPullLayout layout;
+        layout.stride = sizeof(ModelVertex) / sizeof(float);
+        layout.position = offsetof(ModelVertex, position) / sizeof(float);
+        layout.normal = offsetof(ModelVertex, normal) / sizeof(float);
+        layout.texCoord = offsetof(ModelVertex, texCoord) / sizeof(float);
+        layout.color = offsetof(ModelVertex, color) / sizeof(float);
+        return layout;
+    }
+};
+
+// Matches the push_constant block in model_pull.vert (std430). The first 76 bytes
+// are shared with model.frag.
+struct VertexPullPushConstants
+{
+    glm::mat4 model;
+    float light[3];
+    uint32_t stride;
+    VkDeviceAddress vertices;
+    uint32_t position;
+    uint32_t normal;
+    uint32_t texCoord;
+    uint32_t color;
+
+    void SetLayout(const VertexPullLayout& layout)
+    {
+        stride = layout.stride;
+        position = layout.position;
+        normal = layout.normal;
+        texCoord = layout.texCoord;
+        color = layout.color;
+    }
+};
+
+static_assert(offsetof(VertexPullPushConstants, light) == 64, "light must follow the model matrix");
+static_assert(offsetof(VertexPullPushConstants, vertices) == 80, "buffer reference must be 8-byte aligned at 80");
+static_assert(sizeof(VertexPullPushConstants) <= 128, "exceeds the guaranteed push constant size");
@@ -10,6 +10,8 @@ VulkanCommandBuffer::VulkanCommandBuffer()
 
 void VulkanCommandBuffer::Cleanup()
 {
+	DestroyThreadPools();
+
 	if (m_commandPool != VK_NULL_HANDLE)
 	{
 		if (m_device && m_device->IsInitialized())
@@ -344,7 +346,8 @@ bool VulkanCommandBuffer::Submit(
 	const std::vector<VkSemaphore>& waitSemaphores,
 	const std::vector<VkPipelineStageFlags>& waitStages,
 	const std::vector<VkSemaphore>& signalSemaphores,
-	VkFence fence)
+	VkFence fence,
+	const TimelineSignal& timeline)
 {
 	if (commandBuffer == VK_NULL_HANDLE)
 	{
@@ -364,21 +367,7 @@ bool VulkanCommandBuffer::Submit(
 		return false;
 	}
 
-	VkSubmitInfo submitInfo = {};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
-	submitInfo.pWaitSemaphores = waitSemaphores.empty() ? nullptr : waitSemaphores.data();
-	submitInfo.pWaitDstStageMask = waitStages.empty() ? nullptr : waitStages.data();
-
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &commandBuffer;
-
-	submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
-	submitInfo.pSignalSemaphores = signalSemaphores.empty() ? nullptr : signalSemaphores.data();
-
-	VkResult result = vkQueueSubmit(queue, 1, &submitInfo, fence);
-	if (result != VK_SUCCESS)
+	if (!QueueSubmit(queue, &commandBuffer, 1, waitSemaphores, waitStages, signalSemaphores, fence, timeline))
 	{
 		ReportError("Failed to submit command buffer to queue. 0x00006B20");
 		return false;
@@ -393,7 +382,8 @@ bool VulkanCommandBuffer::SubmitMultiple(
 	const std::vector<VkSemaphore>& waitSemaphores,
 	const std::vector<VkPipelineStageFlags>& waitStages,
 	const std::vector<VkSemaphore>& signalSemaphores,
-	VkFence fence)
+	VkFence fence,
+	const TimelineSignal& timeline)
 {
 
 	if (commandBuffers.empty())
@@ -413,50 +403,242 @@ bool VulkanCommandBuffer::SubmitMultiple(
 		return false;
 	}
 
+	if (!QueueSubmit(queue, commandBuffers.data(), static_cast<uint32_t>(commandBuffers.size()),
+		waitSemaphores, waitStages, signalSemaphores, fence, timeline))
+	{
+		ReportError("Failed to submit command buffer to queue. 0x00006C20");
+		return false;
+	}
+
+	return true;
+
+}
+
+bool VulkanCommandBuffer::QueueSubmit(
+	VkQueue queue,
+	const VkCommandBuffer* commandBuffers,
+	uint32_t commandBufferCount,
+	const std::vector<VkSemaphore>& waitSemaphores,
+	const std::vector<VkPipelineStageFlags>& waitStages,
+	const std::vector<VkSemaphore>& signalSemaphores,
+	VkFence fence,
+	const TimelineSignal& timeline)
+{
+	std::vector<VkSemaphore> signals = signalSemaphores;
+	std::vector<uint64_t> signalValues(signals.size(), 0); // Ignored for binary semaphores
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+
 	VkSubmitInfo submitInfo = {};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
+	if (timeline.IsValid())
+	{
+		signals.push_back(timeline.semaphore);
+		signalValues.push_back(timeline.value);
+
+		timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+		timelineInfo.pSignalSemaphoreValues = signalValues.data();
+		submitInfo.pNext = &timelineInfo;
+	}
+
 	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
 	submitInfo.pWaitSemaphores = waitSemaphores.empty() ? nullptr : waitSemaphores.data();
 	submitInfo.pWaitDstStageMask = waitStages.empty() ? nullptr : waitStages.data();
 
-	submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
-	submitInfo.pCommandBuffers = commandBuffers.data();
+	submitInfo.commandBufferCount = commandBufferCount;
+	submitInfo.pCommandBuffers = commandBuffers;
+
+	submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signals.size());
+	submitInfo.pSignalSemaphores = signals.empty() ? nullptr : signals.data();
+
+	return vkQueueSubmit(queue, 1, &submitInfo, fence) == VK_SUCCESS;
+}
 
-	submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
-	submitInfo.pSignalSemaphores = signalSemaphores.empty() ? nullptr : signalSemaphores.data();
+bool VulkanCommandBuffer::ResetPool(VkCommandPoolResetFlags flags)
+{
+
+	if (m_commandPool == VK_NULL_HANDLE || !IsInitialized())
+	{
+		ReportError("Failed to reset pool, VulkanCommandBuffer not initlized or commandpool null. 0x00006D00");
+		return false;
+	}
+
+	VkResult result = vkResetCommandPool(m_device->GetDevice(), m_commandPool, flags);
 
-	VkResult result = vkQueueSubmit(queue, 1, &submitInfo, fence);
 	if (result != VK_SUCCESS)
 	{
-		ReportError("Failed to submit command buffer to queue. 0x00006C20");
+		ReportError("Failed to reset command pool. 0x00006D10");
+		return false;
+	}
+
+	return true;
+}
+
+bool VulkanCommandBuffer::InitializeThreadPools(uint32_t threadCount, uint32_t framesInFlight)
+{
+	if (!IsInitialized())
+	{
+		ReportError("Command buffer system not initialized. 0x00006E00");
+		return false;
+	}
+
+	if (threadCount == 0 || framesInFlight == 0)
+	{
+		ReportError("Thread pools need at least one thread and one frame. 0x00006E05");
+		return false;
+	}
+
+	DestroyThreadPools();
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = m_queueFamilyIndex;
+
+	m_threadPools.resize(static_cast<size_t>(threadCount) * framesInFlight);
+
+	for (auto& threadPool : m_threadPools)
+	{
+		if (vkCreateCommandPool(m_device->GetDevice(), &poolInfo, nullptr, &threadPool.pool) != VK_SUCCESS)
+		{
+			ReportError("Failed to create thread command pool. 0x00006E10");
+			DestroyThreadPools();
+			return false;
+		}
+	}
+
+	m_threadCount = threadCount;
+	m_threadFrames = framesInFlight;
+	return true;
+}
+
+void VulkanCommandBuffer::DestroyThreadPools()
+{
+	if (m_device && m_device->IsInitialized())
+	{
+		for (auto& threadPool : m_threadPools)
+		{
+			// Destroying the pool frees its command buffers
+			if (threadPool.pool != VK_NULL_HANDLE)
+				vkDestroyCommandPool(m_device->GetDevice(), threadPool.pool, nullptr);
+		}
+	}
+
+	m_threadPools.clear();
+	m_threadCount = 0;
+	m_threadFrames = 0;
+}
+
+bool VulkanCommandBuffer::ResetThreadPools(uint32_t frameIndex)
+{
+	if (frameIndex >= m_threadFrames)
+	{
+		ReportError("Thread pool frame index out of range. 0x00006E20");
 		return false;
 	}
 
+	for (uint32_t thread = 0; thread < m_threadCount; ++thread)
+	{
+		ThreadPool& threadPool = m_threadPools[static_cast<size_t>(frameIndex) * m_threadCount + thread];
+
+		if (vkResetCommandPool(m_device->GetDevice(), threadPool.pool, 0) != VK_SUCCESS)
+		{
+			ReportError("Failed to reset thread command pool. 0x00006E25");
+			return false;
+		}
+
+		threadPool.usedPrimaries = 0;
+		threadPool.usedSecondaries = 0;
+	}
+
 	return true;
+}
 
+VkCommandBuffer VulkanCommandBuffer::AcquirePrimary(uint32_t frameIndex, uint32_t threadIndex)
+{
+	return AcquireFromThreadPool(frameIndex, threadIndex, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 }
 
-bool VulkanCommandBuffer::ResetPool(VkCommandPoolResetFlags flags)
+VkCommandBuffer VulkanCommandBuffer::AcquireSecondary(uint32_t frameIndex, uint32_t threadIndex)
+{
+	return AcquireFromThreadPool(frameIndex, threadIndex, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+}
+
+VkCommandBuffer VulkanCommandBuffer::AcquireFromThreadPool(uint32_t frameIndex, uint32_t threadIndex, VkCommandBufferLevel level)
 {
+	if (frameIndex >= m_threadFrames || threadIndex >= m_threadCount)
+	{
+		ReportError("Thread pool index out of range. 0x00006E30");
+		return VK_NULL_HANDLE;
+	}
 
-	if (m_commandPool == VK_NULL_HANDLE || !IsInitialized())
+	ThreadPool& threadPool = m_threadPools[static_cast<size_t>(frameIndex) * m_threadCount + threadIndex];
+	const bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	std::vector<VkCommandBuffer>& buffers = primary ? threadPool.primaries : threadPool.secondaries;
+	uint32_t& used = primary ? threadPool.usedPrimaries : threadPool.usedSecondaries;
+
+	// Reuse buffers recycled by the last pool reset before allocating more
+	if (used < buffers.size())
+		return buffers[used++];
+
+	VkCommandBufferAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = threadPool.pool;
+	allocInfo.level = level;
+	allocInfo.commandBufferCount = 1;
+
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	if (vkAllocateCommandBuffers(m_device->GetDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS)
 	{
-		ReportError("Failed to reset pool, VulkanCommandBuffer not initlized or commandpool null. 0x00006D00");
+		ReportError(primary
+			? "Failed to allocate frame command buffer. 0x00006E33"
+			: "Failed to allocate secondary command buffer. 0x00006E35");
+		return VK_NULL_HANDLE;
+	}
+
+	buffers.push_back(commandBuffer);
+	used++;
+	return commandBuffer;
+}
+
+bool VulkanCommandBuffer::BeginSecondary(VkCommandBuffer commandBuffer, const SecondaryInheritance& inheritance)
+{
+	if (commandBuffer == VK_NULL_HANDLE || inheritance.renderPass == VK_NULL_HANDLE)
+	{
+		ReportError("Secondary command buffer or render pass null. 0x00006E40");
 		return false;
 	}
 
-	VkResult result = vkResetCommandPool(m_device->GetDevice(), m_commandPool, flags);
+	VkCommandBufferInheritanceInfo inheritanceInfo = {};
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.renderPass = inheritance.renderPass;
+	inheritanceInfo.subpass = inheritance.subpass;
+	inheritanceInfo.framebuffer = inheritance.framebuffer;
 
-	if (result != VK_SUCCESS)
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
 	{
-		ReportError("Failed to reset command pool. 0x00006D10");
+		ReportError("Failed to begin secondary command buffer. 0x00006E45");
 		return false;
 	}
 
 	return true;
 }
 
+void VulkanCommandBuffer::ExecuteSecondaries(VkCommandBuffer primary, const std::vector<VkCommandBuffer>& secondaries)
+{
+	if (primary == VK_NULL_HANDLE || secondaries.empty())
+		return;
+
+	vkCmdExecuteCommands(primary, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+}
+
 std::string VulkanCommandBuffer::GetCommandBufferInfo() const
 {
 	if (!IsInitialized())
@@ -470,5 +652,7 @@ std::string VulkanCommandBuffer::GetCommandBufferInfo() const
 
 	info += "  Allocated Buffers: " + std::to_string(m_allocatedBuffers.size()) + "\n";
 
+	info += "  Thread Pools: " + std::to_string(m_threadPools.size()) + "\n";
+
 	return info;
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <functional>
 #include "../VulkanInstance/VulkanInstance.h"
 #include "../VulkanDevice/VulkanDevice.h"
+#include "../VulkanSynchronization/VulkanSynchronization.h"
 #include "../../DebugOutput/DubugOutput.h"
 
 // Types
@@ -25,6 +26,23 @@ struct CommandBufferConfig
     bool oneTimeSubmit = false;
 };
 
+// Render pass state a secondary command buffer continues
+struct SecondaryInheritance
+{
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE; // Optional, lets drivers specialize
+
+    static SecondaryInheritance RenderPass(VkRenderPass renderPass, VkFramebuffer framebuffer, uint32_t subpass = 0)
+    {
+        SecondaryInheritance inheritance;
+        inheritance.renderPass = renderPass;
+        inheritance.framebuffer = framebuffer;
+        inheritance.subpass = subpass;
+        return inheritance;
+    }
+};
+
 class VulkanCommandBuffer
 {
 public:
@@ -68,18 +86,37 @@ public:
         const std::vector<VkSemaphore>& waitSemaphores = {},
         const std::vector<VkPipelineStageFlags>& waitStages = {},
         const std::vector<VkSemaphore>& signalSemaphores = {},
-        VkFence fence = VK_NULL_HANDLE);
+        VkFence fence = VK_NULL_HANDLE,
+        const TimelineSignal& timeline = {});
 
     bool SubmitMultiple(const std::vector<VkCommandBuffer>& commandBuffers,
         VkQueue queue,
         const std::vector<VkSemaphore>& waitSemaphores = {},
         const std::vector<VkPipelineStageFlags>& waitStages = {},
         const std::vector<VkSemaphore>& signalSemaphores = {},
-        VkFence fence = VK_NULL_HANDLE);
+        VkFence fence = VK_NULL_HANDLE,
+        const TimelineSignal& timeline = {});
 
     // Pool ops
     bool ResetPool(VkCommandPoolResetFlags flags = 0);
 
+    // Frame recording
+    // Every per-frame command buffer comes from here: one transient pool per (frame, thread)
+    // hands out the frame's primaries and the secondaries recorded into them. A thread may
+    // only touch its own pool, so acquiring needs no locking. ResetThreadPools recycles a
+    // frame's buffers with one reset per pool and must run after that frame's fence has
+    // signaled. The shared pool above is left to single-time commands, which wait idle and
+    // free their buffer before returning.
+    bool InitializeThreadPools(uint32_t threadCount, uint32_t framesInFlight); // Also resizes
+    void DestroyThreadPools();
+    bool ResetThreadPools(uint32_t frameIndex);
+    VkCommandBuffer AcquirePrimary(uint32_t frameIndex, uint32_t threadIndex);
+    VkCommandBuffer AcquireSecondary(uint32_t frameIndex, uint32_t threadIndex);
+    bool BeginSecondary(VkCommandBuffer commandBuffer, const SecondaryInheritance& inheritance);
+    void ExecuteSecondaries(VkCommandBuffer primary, const std::vector<VkCommandBuffer>& secondaries);
+    uint32_t GetThreadCount() const { return m_threadCount; }
+    uint32_t GetFrameCount() const { return m_threadFrames; }
+
     // Getters
     VkCommandPool GetCommandPool() const { return m_commandPool; }
     uint32_t GetQueueFamilyIndex() const { return m_queueFamilyIndex; }
@@ -98,11 +135,30 @@ private:
     // Tracking
     std::vector<VkCommandBuffer> m_allocatedBuffers;
 
+    // Frame recording
+    // Buffers from earlier frames on the slot were reset with the pool and are handed out again
+    struct ThreadPool
+    {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> primaries;
+        std::vector<VkCommandBuffer> secondaries;
+        uint32_t usedPrimaries = 0;
+        uint32_t usedSecondaries = 0;
+    };
+
+    std::vector<ThreadPool> m_threadPools; // [frame * m_threadCount + thread]
+    uint32_t m_threadCount = 0;
+    uint32_t m_threadFrames = 0;
+
     // Logging
     static const Debug::DebugOutput DebugOut;
 
     // Internals
     bool CreateCommandPool();
+    VkCommandBuffer AcquireFromThreadPool(uint32_t frameIndex, uint32_t threadIndex, VkCommandBufferLevel level);
+    bool QueueSubmit(VkQueue queue, const VkCommandBuffer* commandBuffers, uint32_t commandBufferCount,
+        const std::vector<VkSemaphore>& waitSemaphores, const std::vector<VkPipelineStageFlags>& waitStages,
+        const std::vector<VkSemaphore>& signalSemaphores, VkFence fence, const TimelineSignal& timeline);
     bool ValidateDependencies() const;
 
     // Errors
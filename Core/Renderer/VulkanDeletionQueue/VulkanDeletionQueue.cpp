@@ -0,0 +1,69 @@
+#include "VulkanDeletionQueue.h"
+#include <algorithm>
+
+const Debug::DebugOutput VulkanDeletionQueue::DebugOut;
+
+VulkanDeletionQueue::~VulkanDeletionQueue()
+{
+    if (!m_queue.empty())
+        ReportWarning("Destroyed with " + std::to_string(m_queue.size()) + " pending deletions. 0x00020000");
+}
+
+void VulkanDeletionQueue::Push(uint64_t retireValue, std::function<void()> deleter)
+{
+    if (!deleter)
+    {
+        ReportWarning("Ignoring empty deleter. 0x00020010");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Values normally arrive in order; keep the queue sorted if one does not.
+    auto it = m_queue.end();
+    while (it != m_queue.begin() && std::prev(it)->retireValue > retireValue)
+        --it;
+
+    m_queue.insert(it, DeferredDeletion{ retireValue, std::move(deleter) });
+}
+
+size_t VulkanDeletionQueue::Collect(uint64_t completedValue)
+{
+    std::deque<DeferredDeletion> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (!m_queue.empty() && m_queue.front().retireValue <= completedValue)
+        {
+            ready.push_back(std::move(m_queue.front()));
+            m_queue.pop_front();
+        }
+    }
+
+    // Run outside the lock so deleters may queue further work
+    return Run(ready);
+}
+
+size_t VulkanDeletionQueue::Flush()
+{
+    std::deque<DeferredDeletion> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ready.swap(m_queue);
+    }
+
+    return Run(ready);
+}
+
+size_t VulkanDeletionQueue::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size();
+}
+
+size_t VulkanDeletionQueue::Run(std::deque<DeferredDeletion>& entries)
+{
+    for (auto& entry : entries)
+        entry.deleter();
+
+    return entries.size();
+}
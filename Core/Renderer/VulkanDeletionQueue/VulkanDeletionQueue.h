@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include "../../DebugOutput/DubugOutput.h"
+
+// Types
+struct DeferredDeletion
+{
+    uint64_t retireValue = 0; // Frame index / timeline value the resource was released in
+    std::function<void()> deleter;
+};
+
+// Holds GPU resources released during frame N until the GPU has finished frame N.
+class VulkanDeletionQueue
+{
+public:
+    VulkanDeletionQueue() = default;
+    ~VulkanDeletionQueue();
+
+    // RAII
+    VulkanDeletionQueue(const VulkanDeletionQueue&) = delete;
+    VulkanDeletionQueue& operator=(const VulkanDeletionQueue&) = delete;
+
+    // Queue
+    void Push(uint64_t retireValue, std::function<void()> deleter);
+    size_t Collect(uint64_t completedValue); // Runs every deleter with retireValue <= completedValue
+    size_t Flush();                          // Caller guarantees the device is idle
+
+    // Getters
+    size_t GetPendingCount() const;
+    bool IsEmpty() const { return GetPendingCount() == 0; }
+
+private:
+    std::deque<DeferredDeletion> m_queue;
+    mutable std::mutex m_mutex;
+
+    static const Debug::DebugOutput DebugOut;
+
+    size_t Run(std::deque<DeferredDeletion>& entries);
+
+    void ReportWarning(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanDeletionQueue Warning: " + message);
+    }
+};
@@ -1,4 +1,5 @@
 #include "VulkanDescriptor.h"
+#include "VulkanDescriptorAllocator.h"
 
 
 VulkanDescriptor::VulkanDescriptor(){}
@@ -13,16 +14,15 @@ void VulkanDescriptor::Cleanup()
             m_descriptorPool = VK_NULL_HANDLE;
         }
 
-        if (m_descriptorSetLayout != VK_NULL_HANDLE)
-        {
+        if (m_descriptorSetLayout != VK_NULL_HANDLE && m_ownsLayout)
             vkDestroyDescriptorSetLayout(m_device->GetDevice(), m_descriptorSetLayout, nullptr);
-            m_descriptorSetLayout = VK_NULL_HANDLE;
-        }
+        m_descriptorSetLayout = VK_NULL_HANDLE;
 
         m_descriptorSet = VK_NULL_HANDLE;
     }
 
     m_bindings.clear();
+    m_ownsLayout = true;
     m_instance.reset();
     m_device.reset();
 }
@@ -102,6 +102,11 @@ void VulkanDescriptor::AddBinding(
     m_bindings.push_back(std::move(bind)); 
 }
 
+void VulkanDescriptor::AddBindings(const std::vector<DescriptorBinding>& bindings)
+{
+    m_bindings.insert(m_bindings.end(), bindings.begin(), bindings.end());
+}
+
 bool VulkanDescriptor::CreateDescriptorSetLayout()
 {
     std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
@@ -322,5 +327,75 @@ bool VulkanDescriptor::Build(uint32_t maxSets)
         return false;
     }
 
+    return true;
+}
+
+bool VulkanDescriptor::Build(VkDescriptorSetLayout sharedLayout, uint32_t maxSets)
+{
+    if (m_bindings.empty())
+    {
+        ReportError("No bindings added. 0x0000D200");
+        return false;
+    }
+
+    if (sharedLayout == VK_NULL_HANDLE)
+    {
+        ReportError("Shared layout is null. 0x0000D240");
+        return false;
+    }
+
+    // The bindings must describe sharedLayout; they size the pool and type the writes
+    m_descriptorSetLayout = sharedLayout;
+    m_ownsLayout = false;
+
+    if (!CreateDescriptorPool(maxSets))
+    {
+        return false;
+    }
+
+    if (!AllocateDescriptorSet())
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanDescriptor::Build(VkDescriptorSetLayout sharedLayout, VulkanDescriptorAllocator& allocator)
+{
+    return BuildShared(sharedLayout, allocator, false);
+}
+
+bool VulkanDescriptor::BuildFrame(VkDescriptorSetLayout sharedLayout, VulkanDescriptorAllocator& allocator)
+{
+    return BuildShared(sharedLayout, allocator, true);
+}
+
+bool VulkanDescriptor::BuildShared(VkDescriptorSetLayout sharedLayout, VulkanDescriptorAllocator& allocator, bool perFrame)
+{
+    if (m_bindings.empty())
+    {
+        ReportError("No bindings added. 0x0000D200");
+        return false;
+    }
+
+    if (sharedLayout == VK_NULL_HANDLE)
+    {
+        ReportError("Shared layout is null. 0x0000D240");
+        return false;
+    }
+
+    // The bindings must describe sharedLayout; they only type the writes here
+    m_descriptorSetLayout = sharedLayout;
+    m_ownsLayout = false;
+
+    // Left null on failure, so a frame set from a slot that has since been reset is never reused
+    m_descriptorSet = perFrame ? allocator.AllocateFrame(sharedLayout) : allocator.Allocate(sharedLayout);
+    if (m_descriptorSet == VK_NULL_HANDLE)
+    {
+        ReportError("Failed to allocate descriptor set from the shared allocator. 0x0000D250");
+        return false;
+    }
+
     return true;
 }
\ No newline at end of file
@@ -16,6 +16,8 @@ struct DescriptorBinding
     uint32_t count = 1;
 };
 
+class VulkanDescriptorAllocator;
+
 class VulkanDescriptor
 {
 public:
@@ -39,9 +41,18 @@ public:
         VkDescriptorType type,
         VkShaderStageFlags stages,
         uint32_t count = 1);
+    void AddBindings(const std::vector<DescriptorBinding>& bindings);
 
     // Build layout and allocate set
     bool Build(uint32_t maxSets = 1);
+    // Allocates against a layout owned elsewhere (e.g. VulkanDescriptorLayoutCache); it is not destroyed here
+    bool Build(VkDescriptorSetLayout sharedLayout, uint32_t maxSets = 1);
+    // Shared layout and a set from the allocator's pools; no pool of its own. The set
+    // lives as long as the allocator does.
+    bool Build(VkDescriptorSetLayout sharedLayout, VulkanDescriptorAllocator& allocator);
+    // Same, but the set comes from the allocator's current frame slot and is gone once the
+    // slot comes around again. Called every frame, followed by the binds.
+    bool BuildFrame(VkDescriptorSetLayout sharedLayout, VulkanDescriptorAllocator& allocator);
 
     // Bindings
     bool BindBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize size, VkDeviceSize offset = 0, uint32_t arrayElement = 0);
@@ -62,12 +73,14 @@ private:
     VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
     VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
     VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+    bool m_ownsLayout = true;
 
     static const Debug::DebugOutput DebugOut;
 
     bool CreateDescriptorSetLayout();
     bool CreateDescriptorPool(uint32_t maxSets);
     bool AllocateDescriptorSet();
+    bool BuildShared(VkDescriptorSetLayout sharedLayout, VulkanDescriptorAllocator& allocator, bool perFrame);
 
     void ReportError(const std::string& message) const
     {
@@ -0,0 +1,300 @@
+#include "VulkanDescriptorAllocator.h"
+#include <algorithm>
+
+const Debug::DebugOutput VulkanDescriptorAllocator::DebugOut;
+
+VulkanDescriptorAllocator::VulkanDescriptorAllocator()
+{}
+
+VulkanDescriptorAllocator::~VulkanDescriptorAllocator()
+{
+    Cleanup();
+}
+
+bool VulkanDescriptorAllocator::ValidateDependencies() const
+{
+    if (!m_instance || !m_instance->IsInitialized())
+    {
+        ReportError("Instance not initialized. 0x00029000");
+        return false;
+    }
+
+    if (!m_device || !m_device->IsInitialized())
+    {
+        ReportError("Device not initialized. 0x00029010");
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<DescriptorPoolRatio> VulkanDescriptorAllocator::DefaultRatios()
+{
+    return {
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f },
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 0.5f },
+        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0.5f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0.5f },
+        { VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f }
+    };
+}
+
+bool VulkanDescriptorAllocator::Initialize(
+    std::shared_ptr<VulkanInstance> instance,
+    std::shared_ptr<VulkanDevice> device,
+    uint32_t framesInFlight,
+    uint32_t setsPerPool,
+    const std::vector<DescriptorPoolRatio>& ratios)
+{
+    m_instance = instance;
+    m_device = device;
+
+    if (!ValidateDependencies())
+    {
+        Cleanup();
+        return false;
+    }
+
+    if (framesInFlight == 0 || setsPerPool == 0 || ratios.empty())
+    {
+        ReportError("Frames in flight, sets per pool and ratios must be non-empty. 0x00029020");
+        Cleanup();
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ratios = ratios;
+    m_initialSetsPerPool = std::min(setsPerPool, MaxSetsPerPool);
+    m_persistent.setsPerPool = m_initialSetsPerPool;
+    m_frames.assign(framesInFlight, PoolList{ {}, {}, m_initialSetsPerPool });
+    m_frameIndex = 0;
+    return true;
+}
+
+void VulkanDescriptorAllocator::Cleanup()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Destroying a pool frees every set allocated from it
+    DestroyPools(m_persistent);
+    for (auto& frame : m_frames)
+        DestroyPools(frame);
+
+    m_frames.clear();
+    m_frameIndex = 0;
+    m_ratios.clear();
+    m_stats = DescriptorAllocatorStats();
+    m_device.reset();
+    m_instance.reset();
+}
+
+void VulkanDescriptorAllocator::DestroyPools(PoolList& list)
+{
+    if (m_device && m_device->IsInitialized())
+    {
+        for (VkDescriptorPool pool : list.ready)
+            vkDestroyDescriptorPool(m_device->GetDevice(), pool, nullptr);
+        for (VkDescriptorPool pool : list.full)
+            vkDestroyDescriptorPool(m_device->GetDevice(), pool, nullptr);
+    }
+
+    list.ready.clear();
+    list.full.clear();
+    list.setsPerPool = m_initialSetsPerPool;
+}
+
+bool VulkanDescriptorAllocator::Resize(uint32_t framesInFlight)
+{
+    if (!IsInitialized())
+    {
+        ReportError("Allocator not initialized. 0x00029030");
+        return false;
+    }
+
+    if (framesInFlight == 0)
+    {
+        ReportError("Frames in flight must be at least 1. 0x00029040");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (framesInFlight == m_frames.size())
+        return true;
+
+    for (auto& frame : m_frames)
+    {
+        m_stats.framePools -= static_cast<uint32_t>(frame.ready.size() + frame.full.size());
+        DestroyPools(frame);
+    }
+
+    m_frames.assign(framesInFlight, PoolList{ {}, {}, m_initialSetsPerPool });
+    m_frameIndex = 0;
+    return true;
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::CreatePool(uint32_t maxSets)
+{
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    poolSizes.reserve(m_ratios.size());
+    for (const auto& ratio : m_ratios)
+    {
+        VkDescriptorPoolSize poolSize = {};
+        poolSize.type = ratio.type;
+        poolSize.descriptorCount = std::max(1u, static_cast<uint32_t>(ratio.ratio * maxSets));
+        poolSizes.push_back(poolSize);
+    }
+
+    // No FREE_DESCRIPTOR_SET_BIT: sets are only ever released by resetting or destroying the pool
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = 0;
+    poolInfo.maxSets = maxSets;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if (vkCreateDescriptorPool(m_device->GetDevice(), &poolInfo, nullptr, &pool) != VK_SUCCESS)
+    {
+        ReportError("Failed to create descriptor pool. 0x00029100");
+        return VK_NULL_HANDLE;
+    }
+
+    return pool;
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::AcquirePool(PoolList& list)
+{
+    if (!list.ready.empty())
+        return list.ready.back();
+
+    VkDescriptorPool pool = CreatePool(list.setsPerPool);
+    if (pool == VK_NULL_HANDLE)
+        return VK_NULL_HANDLE;
+
+    // Each pool is half again as large as the last, so a busy list settles on a few big pools
+    list.setsPerPool = std::min(list.setsPerPool + list.setsPerPool / 2, MaxSetsPerPool);
+    list.ready.push_back(pool);
+
+    if (&list == &m_persistent)
+        m_stats.pools++;
+    else
+        m_stats.framePools++;
+    return pool;
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::AllocateFrom(PoolList& list, VkDescriptorSetLayout layout)
+{
+    VkDescriptorPool pool = AcquirePool(list);
+    if (pool == VK_NULL_HANDLE)
+        return VK_NULL_HANDLE;
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    VkResult result = vkAllocateDescriptorSets(m_device->GetDevice(), &allocInfo, &set);
+
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+    {
+        // The pool is spent; park it and retry once in a fresh one
+        list.ready.pop_back();
+        list.full.push_back(pool);
+        m_stats.grown++;
+
+        pool = AcquirePool(list);
+        if (pool == VK_NULL_HANDLE)
+            return VK_NULL_HANDLE;
+
+        allocInfo.descriptorPool = pool;
+        result = vkAllocateDescriptorSets(m_device->GetDevice(), &allocInfo, &set);
+    }
+
+    if (result != VK_SUCCESS)
+    {
+        // A fresh pool failing means the layout uses a type or count the ratios do not cover
+        ReportError("Failed to allocate descriptor set; check the pool ratios. 0x00029200");
+        return VK_NULL_HANDLE;
+    }
+
+    return set;
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::Allocate(VkDescriptorSetLayout layout)
+{
+    if (!IsInitialized())
+    {
+        ReportError("Allocator not initialized. 0x00029210");
+        return VK_NULL_HANDLE;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    VkDescriptorSet set = AllocateFrom(m_persistent, layout);
+    if (set != VK_NULL_HANDLE)
+        m_stats.allocated++;
+    return set;
+}
+
+VkDescriptorSet VulkanDescriptorAllocator::AllocateFrame(VkDescriptorSetLayout layout)
+{
+    if (!IsInitialized())
+    {
+        ReportError("Allocator not initialized. 0x00029220");
+        return VK_NULL_HANDLE;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    VkDescriptorSet set = AllocateFrom(m_frames[m_frameIndex], layout);
+    if (set != VK_NULL_HANDLE)
+        m_stats.frameAllocated++;
+    return set;
+}
+
+bool VulkanDescriptorAllocator::BeginFrame(uint32_t frameIndex)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (frameIndex >= m_frames.size())
+    {
+        ReportError("Frame index out of range. 0x00029300");
+        return false;
+    }
+
+    // One reset per pool returns every set the slot handed out last time around
+    PoolList& frame = m_frames[frameIndex];
+    frame.ready.insert(frame.ready.end(), frame.full.begin(), frame.full.end());
+    frame.full.clear();
+
+    for (VkDescriptorPool pool : frame.ready)
+    {
+        if (vkResetDescriptorPool(m_device->GetDevice(), pool, 0) != VK_SUCCESS)
+        {
+            ReportError("Failed to reset frame descriptor pool. 0x00029310");
+            return false;
+        }
+    }
+
+    m_frameIndex = frameIndex;
+    return true;
+}
+
+DescriptorAllocatorStats VulkanDescriptorAllocator::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::string VulkanDescriptorAllocator::GetAllocatorInfo() const
+{
+    const DescriptorAllocatorStats stats = GetStats();
+
+    std::string output = "VulkanDescriptorAllocator Info:\n";
+    output += "  Pools: " + std::to_string(stats.pools) + " persistent, " + std::to_string(stats.framePools) + " per-frame\n";
+    output += "  Sets: " + std::to_string(stats.allocated) + " persistent, " + std::to_string(stats.frameAllocated) + " per-frame\n";
+    output += "  Grown: " + std::to_string(stats.grown) + "\n";
+    return output;
+}
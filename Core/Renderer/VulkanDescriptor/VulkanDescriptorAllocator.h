@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../VulkanInstance/VulkanInstance.h"
+#include "../VulkanDevice/VulkanDevice.h"
+#include "../../DebugOutput/DubugOutput.h"
+
+// Config
+// Descriptors of one type a pool reserves per set it can hold
+struct DescriptorPoolRatio
+{
+    VkDescriptorType type;
+    float ratio;
+};
+
+// Types
+struct DescriptorAllocatorStats
+{
+    uint32_t pools = 0;          // Persistent pools
+    uint32_t framePools = 0;     // Pools across every frame slot
+    uint64_t allocated = 0;      // Persistent sets
+    uint64_t frameAllocated = 0; // Per-frame sets, since startup
+    uint64_t grown = 0;          // Pools added because the others ran out
+};
+
+// Hands out descriptor sets from a few large pools shared by every layout. A list of
+// pools grows by one whenever the current pool runs out, each new pool bigger than the
+// last, so the pool count stays small however many sets are made.
+// Persistent sets live until Cleanup. Frame sets come from the current frame slot's
+// pools, which BeginFrame resets wholesale instead of freeing sets one by one.
+// Calls are serialized by one lock; sets are allocated rarely enough for that to be cheap.
+class VulkanDescriptorAllocator
+{
+public:
+    VulkanDescriptorAllocator();
+    ~VulkanDescriptorAllocator();
+
+    // RAII
+    VulkanDescriptorAllocator(const VulkanDescriptorAllocator&) = delete;
+    VulkanDescriptorAllocator& operator=(const VulkanDescriptorAllocator&) = delete;
+
+    // Lifecycle
+    bool Initialize(std::shared_ptr<VulkanInstance> instance,
+        std::shared_ptr<VulkanDevice> device,
+        uint32_t framesInFlight,
+        uint32_t setsPerPool = 64,
+        const std::vector<DescriptorPoolRatio>& ratios = DefaultRatios());
+    void Cleanup(); // The GPU must be done with every set
+    bool IsInitialized() const { return m_device != nullptr; }
+    bool Resize(uint32_t framesInFlight); // Device must be idle; frame sets are dropped
+
+    // Allocation
+    VkDescriptorSet Allocate(VkDescriptorSetLayout layout); // Null on failure
+    // Valid until the current frame slot begins again
+    VkDescriptorSet AllocateFrame(VkDescriptorSetLayout layout);
+
+    // Frame
+    // Resets the slot's pools, so the slot's fence must have signaled.
+    bool BeginFrame(uint32_t frameIndex);
+
+    // Config
+    static std::vector<DescriptorPoolRatio> DefaultRatios();
+
+    // Getters
+    DescriptorAllocatorStats GetStats() const;
+    uint32_t GetFrameCount() const { return static_cast<uint32_t>(m_frames.size()); }
+
+    // Debug
+    std::string GetAllocatorInfo() const;
+
+private:
+    // Pools with room come last in ready, so the newest (largest) is tried first
+    struct PoolList
+    {
+        std::vector<VkDescriptorPool> ready;
+        std::vector<VkDescriptorPool> full;
+        uint32_t setsPerPool = 0;
+    };
+
+    static constexpr uint32_t MaxSetsPerPool = 4096;
+
+    std::shared_ptr<VulkanInstance> m_instance;
+    std::shared_ptr<VulkanDevice> m_device;
+
+    std::vector<DescriptorPoolRatio> m_ratios;
+    uint32_t m_initialSetsPerPool = 0;
+    PoolList m_persistent;
+    std::vector<PoolList> m_frames;
+    uint32_t m_frameIndex = 0;
+
+    mutable std::mutex m_mutex; // Guards the pool lists and m_stats
+    DescriptorAllocatorStats m_stats;
+
+    static const Debug::DebugOutput DebugOut;
+
+    bool ValidateDependencies() const;
+    VkDescriptorSet AllocateFrom(PoolList& list, VkDescriptorSetLayout layout);
+    VkDescriptorPool AcquirePool(PoolList& list);
+    VkDescriptorPool CreatePool(uint32_t maxSets);
+    void DestroyPools(PoolList& list);
+
+    void ReportError(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanDescriptorAllocator Error: " + message);
+    }
+};
@@ -23,6 +23,8 @@ void VulkanDevice::Cleanup()
 	m_enabledExtensions.clear();
 	m_supportedExtensions.clear();
 
+	m_enabledFeatures12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+	m_enabledFeatures13 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
 }
 
 VulkanDevice::~VulkanDevice()
@@ -195,14 +197,19 @@ bool VulkanDevice::CreateLogicalDevice()
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
-	VkPhysicalDeviceFeatures deviceFeatures = {};
-	deviceFeatures.samplerAnisotropy = VK_TRUE; 
+	SelectOptionalFeatures();
+
+	VkPhysicalDeviceFeatures2 deviceFeatures = {};
+	deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	deviceFeatures.pNext = &m_enabledFeatures12;
+	deviceFeatures.features.samplerAnisotropy = VK_TRUE; 
 
 	VkDeviceCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.pNext = &deviceFeatures;
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
-	createInfo.pEnabledFeatures = &deviceFeatures;
+	createInfo.pEnabledFeatures = nullptr;
 
 	// Extensions
 	createInfo.enabledExtensionCount = static_cast<uint32_t>(m_enabledExtensions.size());
@@ -214,6 +221,68 @@ bool VulkanDevice::CreateLogicalDevice()
 	return result == VK_SUCCESS;
 }
 
+void VulkanDevice::SelectOptionalFeatures()
+{
+	VkPhysicalDeviceVulkan13Features supported13 = {};
+	supported13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+	VkPhysicalDeviceVulkan12Features supported12 = {};
+	supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	supported12.pNext = &supported13;
+
+	VkPhysicalDeviceFeatures2 supported = {};
+	supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	supported.pNext = &supported12;
+	vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supported);
+
+	m_enabledFeatures12 = {};
+	m_enabledFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	// Only request what the device reports; callers query the getters to pick a path
+	m_enabledFeatures12.bufferDeviceAddress = supported12.bufferDeviceAddress;
+	m_enabledFeatures12.timelineSemaphore = supported12.timelineSemaphore;
+
+	m_enabledFeatures13 = {};
+	m_enabledFeatures13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+	m_enabledFeatures13.synchronization2 = supported13.synchronization2; // Required by 1.3, queried anyway
+	m_enabledFeatures12.pNext = &m_enabledFeatures13;
+
+	if (!supported13.synchronization2)
+		ReportWarning("synchronization2 not supported; barrier batches fall back to vkCmdPipelineBarrier. 0x00002050");
+
+	// Pipeline libraries are only chained when both extensions made it into the enabled list
+	m_enabledGraphicsPipelineLibrary = {};
+	m_enabledGraphicsPipelineLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+	m_graphicsPipelineLibraryFastLinking = false;
+
+	if (!IsExtensionSupported(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) ||
+		!IsExtensionSupported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+		return;
+
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT supportedLibrary = {};
+	supportedLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+	VkPhysicalDeviceFeatures2 supportedLibraryFeatures = {};
+	supportedLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	supportedLibraryFeatures.pNext = &supportedLibrary;
+	vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supportedLibraryFeatures);
+
+	if (!supportedLibrary.graphicsPipelineLibrary)
+		return;
+
+	VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT libraryProperties = {};
+	libraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+
+	VkPhysicalDeviceProperties2 properties = {};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &libraryProperties;
+	vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+
+	m_enabledGraphicsPipelineLibrary.graphicsPipelineLibrary = VK_TRUE;
+	m_enabledFeatures13.pNext = &m_enabledGraphicsPipelineLibrary;
+	m_graphicsPipelineLibraryFastLinking = libraryProperties.graphicsPipelineLibraryFastLinking == VK_TRUE;
+}
+
 void VulkanDevice::QuerySupportedExtensions(VkPhysicalDevice device)
 {
 	uint32_t supportedExtensionCount; 
@@ -258,7 +327,9 @@ void VulkanDevice::SetupRequiredExtensions()
 	{
 		VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME,
 		VK_EXT_MESH_SHADER_EXTENSION_NAME,
-		VK_KHR_SHADER_NON_SEMANTIC_INFO_EXTENSION_NAME  
+		VK_KHR_SHADER_NON_SEMANTIC_INFO_EXTENSION_NAME,
+		VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+		VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME
 	};
 
 	QuerySupportedExtensions(m_physicalDevice);
@@ -79,6 +79,19 @@ public:
     const VkPhysicalDeviceFeatures& GetDeviceFeatures() const { return m_deviceFeatures; }
     const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const { return m_memoryProperties; }
 
+    // Enabled core 1.2 features
+    const VkPhysicalDeviceVulkan12Features& GetEnabledFeatures12() const { return m_enabledFeatures12; }
+    bool IsBufferDeviceAddressEnabled() const { return m_enabledFeatures12.bufferDeviceAddress == VK_TRUE; }
+    bool IsTimelineSemaphoreEnabled() const { return m_enabledFeatures12.timelineSemaphore == VK_TRUE; }
+
+    // Enabled core 1.3 features
+    const VkPhysicalDeviceVulkan13Features& GetEnabledFeatures13() const { return m_enabledFeatures13; }
+    bool IsSynchronization2Enabled() const { return m_enabledFeatures13.synchronization2 == VK_TRUE; }
+
+    // VK_EXT_graphics_pipeline_library; pipelines can be built as parts and linked
+    bool IsGraphicsPipelineLibraryEnabled() const { return m_enabledGraphicsPipelineLibrary.graphicsPipelineLibrary == VK_TRUE; }
+    bool HasGraphicsPipelineLibraryFastLinking() const { return m_graphicsPipelineLibraryFastLinking; }
+
     // Extension support
     bool IsExtensionSupported(const std::string& extensionName) const;
     const std::vector<std::string>& GetSupportedExtensions() const { return m_supportedExtensions; }
@@ -121,6 +134,12 @@ private:
     VkPhysicalDeviceFeatures m_deviceFeatures = {};
     VkPhysicalDeviceMemoryProperties m_memoryProperties = {};
 
+    // Features enabled at device creation (chained through VkPhysicalDeviceFeatures2)
+    VkPhysicalDeviceVulkan12Features m_enabledFeatures12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+    VkPhysicalDeviceVulkan13Features m_enabledFeatures13 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT m_enabledGraphicsPipelineLibrary = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT };
+    bool m_graphicsPipelineLibraryFastLinking = false; // Linking without link-time optimization is cheap
+
     // Extensions
     std::vector<std::string> m_supportedExtensions;
     std::vector<const char*> m_enabledExtensions;
@@ -137,6 +156,7 @@ private:
     // Device creation
     bool CreateLogicalDevice();
     void SetupRequiredExtensions();
+    void SelectOptionalFeatures();
 
     // Extension checks
     bool CheckDeviceExtensionSupport(VkPhysicalDevice device) const;
@@ -158,4 +178,8 @@ private:
     void ReportError(const std::string& message) const {
         DebugOut.outputDebug("VulkanDevice Error: " + message);
     }
+
+    void ReportWarning(const std::string& message) const {
+        DebugOut.outputDebug("VulkanDevice Warning: " + message);
+    }
 };
@@ -1,5 +1,7 @@
 #include "VulkanGraphicsPipeline.h"
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 
 const Debug::DebugOutput VulkanGraphicsPipeline::DebugOut;
 
@@ -24,15 +26,15 @@ void VulkanGraphicsPipeline::Cleanup()
             vkDestroyPipelineLayout(m_device->GetDevice(), m_pipelineLayout, nullptr);
             m_pipelineLayout = VK_NULL_HANDLE;
         }
-
-        for (auto shaderModule : m_shaderModules)
-        {
-            vkDestroyShaderModule(m_device->GetDevice(), shaderModule, nullptr);
-        }
-        m_shaderModules.clear();
     }
 
+    m_shaderModules.clear(); // Destroyed by the last pipeline using them
+    m_linkedParts.clear();
+    m_part = PipelinePart::Complete;
+    m_optimized = true;
     m_renderPass.reset();
+    m_pipelineCache.reset();
+    m_shaderCache.reset();
     m_device.reset();
     m_instance.reset();
     m_config = GraphicsPipelineConfig();
@@ -92,12 +94,6 @@ bool VulkanGraphicsPipeline::ValidateConfig(const GraphicsPipelineConfig& config
         return false;
     }
 
-    if (config.viewport.width == 0 || config.viewport.height == 0)
-    {
-        ReportError("Viewport dimensions cannot be zero. 0x00009110");
-        return false;
-    }
-
     for (const auto& shader : config.shaders)
     {
         if (shader.filepath.empty())
@@ -130,8 +126,19 @@ std::vector<char> VulkanGraphicsPipeline::ReadFile(const std::string& filename)
     return buffer;
 }
 
-bool VulkanGraphicsPipeline::LoadShaderModule(const std::string& filepath, VkShaderModule& outModule)
+bool VulkanGraphicsPipeline::LoadShaderModule(const std::string& filepath, std::shared_ptr<VulkanShaderModule>& outModule)
 {
+    if (m_shaderCache)
+    {
+        outModule = m_shaderCache->Acquire(filepath);
+        if (!outModule)
+        {
+            ReportError("Failed to load shader module: " + filepath + " 0x00009230");
+            return false;
+        }
+        return true;
+    }
+
     std::vector<char> code = ReadFile(filepath);
     if (code.empty())
     {
@@ -144,13 +151,15 @@ bool VulkanGraphicsPipeline::LoadShaderModule(const std::string& filepath, VkSha
     createInfo.codeSize = code.size();
     createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
 
-    VkResult result = vkCreateShaderModule(m_device->GetDevice(), &createInfo, nullptr, &outModule);
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    VkResult result = vkCreateShaderModule(m_device->GetDevice(), &createInfo, nullptr, &shaderModule);
     if (result != VK_SUCCESS)
     {
         ReportError("Failed to create shader module: " + filepath + " 0x00009220");
         return false;
     }
 
+    outModule = std::make_shared<VulkanShaderModule>(m_device, shaderModule, filepath, 0);
 
     return true;
 }
@@ -190,7 +199,7 @@ bool VulkanGraphicsPipeline::CreatePipeline()
     // Section 1: Load shader modules and create stage info
     // Section 2: Vertex input state
     // Section 3: Input assembly state
-    // Section 4: Viewport and scissor
+    // Section 4: Viewport and scissor (dynamic)
     // Section 5: Rasterization state
     // Section 6: Multisampling state
     // Section 7: Depth/stencil state
@@ -199,9 +208,18 @@ bool VulkanGraphicsPipeline::CreatePipeline()
 
     std::vector<VkPipelineShaderStageCreateInfo> shaderStageInfos;
 
-    for (const auto& shaderStage : m_config.shaders)
+    // Sized up front; stage infos point into these until the pipeline is created
+    std::vector<VkSpecializationInfo> specializationInfos(m_config.shaders.size());
+    std::vector<std::vector<VkSpecializationMapEntry>> specializationEntries(m_config.shaders.size());
+    std::vector<std::vector<uint32_t>> specializationData(m_config.shaders.size());
+
+    for (size_t i = 0; i < m_config.shaders.size(); i++)
     {
-        VkShaderModule shaderModule;
+        const ShaderStage& shaderStage = m_config.shaders[i];
+        if (!UsesShader(shaderStage))
+            continue;
+
+        std::shared_ptr<VulkanShaderModule> shaderModule;
         if (!LoadShaderModule(shaderStage.filepath, shaderModule))
             return false;
 
@@ -210,9 +228,33 @@ bool VulkanGraphicsPipeline::CreatePipeline()
         VkPipelineShaderStageCreateInfo stageInfo = {};
         stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         stageInfo.stage = shaderStage.stage;
-        stageInfo.module = shaderModule;
+        stageInfo.module = shaderModule->GetModule();
         stageInfo.pName = shaderStage.entryPoint.c_str();
 
+        if (!shaderStage.specialization.empty())
+        {
+            const auto& declared = shaderModule->GetReflection().specializationIds;
+            for (const auto& [constantId, value] : shaderStage.specialization)
+            {
+                if (shaderModule->IsReflected() && std::find(declared.begin(), declared.end(), constantId) == declared.end())
+                    ReportWarning("Specialization constant " + std::to_string(constantId) + " not declared in " + shaderStage.filepath + ". 0x00009240");
+
+                VkSpecializationMapEntry entry = {};
+                entry.constantID = constantId;
+                entry.offset = static_cast<uint32_t>(specializationData[i].size() * sizeof(uint32_t));
+                entry.size = sizeof(uint32_t);
+                specializationEntries[i].push_back(entry);
+                specializationData[i].push_back(value);
+            }
+
+            VkSpecializationInfo& specializationInfo = specializationInfos[i];
+            specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries[i].size());
+            specializationInfo.pMapEntries = specializationEntries[i].data();
+            specializationInfo.dataSize = specializationData[i].size() * sizeof(uint32_t);
+            specializationInfo.pData = specializationData[i].data();
+            stageInfo.pSpecializationInfo = &specializationInfo;
+        }
+
         shaderStageInfos.push_back(stageInfo); 
     }
 
@@ -229,25 +271,19 @@ bool VulkanGraphicsPipeline::CreatePipeline()
     inputAssembly.topology = m_config.topology;  
     inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-    VkViewport viewport = {};
-
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    viewport.height = static_cast<float>(m_config.viewport.height);
-    viewport.width = static_cast<float>(m_config.viewport.width);
-
-    VkRect2D scissor = {};
-    scissor.offset = { 0, 0 }; 
-    scissor.extent = m_config.viewport;
-
+    // Counts only; the rectangles are recorded per draw so resizes never rebuild the pipeline
     VkPipelineViewportStateCreateInfo viewportState = {};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
+    viewportState.pViewports = nullptr;
     viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
+    viewportState.pScissors = nullptr;
+
+    const VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(std::size(dynamicStates));
+    dynamicState.pDynamicStates = dynamicStates;
 
     VkPipelineRasterizationStateCreateInfo rasterizer = {};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -283,23 +319,50 @@ bool VulkanGraphicsPipeline::CreatePipeline()
     colorBlending.attachmentCount = 1;
     colorBlending.pAttachments = &colorBlendAttachment;
 
+    // A part only reads the state its slice owns; the rest stays null
+    const bool complete = m_part == PipelinePart::Complete;
+    const bool vertexInput = complete || m_part == PipelinePart::VertexInput;
+    const bool preRasterization = complete || m_part == PipelinePart::PreRasterization;
+    const bool fragmentShader = complete || m_part == PipelinePart::FragmentShader;
+    const bool fragmentOutput = complete || m_part == PipelinePart::FragmentOutput;
+
     VkGraphicsPipelineCreateInfo pipelineInfo = {};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.stageCount = static_cast<uint32_t>(shaderStageInfos.size());
-    pipelineInfo.pStages = shaderStageInfos.data();
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pDepthStencilState = &depthStencil;
-    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pStages = shaderStageInfos.empty() ? nullptr : shaderStageInfos.data();
+    pipelineInfo.pVertexInputState = vertexInput ? &vertexInputInfo : nullptr;
+    pipelineInfo.pInputAssemblyState = vertexInput ? &inputAssembly : nullptr;
+    pipelineInfo.pViewportState = preRasterization ? &viewportState : nullptr;
+    pipelineInfo.pRasterizationState = preRasterization ? &rasterizer : nullptr;
+    pipelineInfo.pMultisampleState = (fragmentShader || fragmentOutput) ? &multisampling : nullptr;
+    pipelineInfo.pDepthStencilState = fragmentShader ? &depthStencil : nullptr;
+    pipelineInfo.pColorBlendState = fragmentOutput ? &colorBlending : nullptr;
+    pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = m_pipelineLayout;
     pipelineInfo.renderPass = m_renderPass->GetRenderPass();
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    VkResult result = vkCreateGraphicsPipelines(m_device->GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo = {};
+    libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+    if (!complete)
+    {
+        switch (m_part)
+        {
+        case PipelinePart::VertexInput: libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT; break;
+        case PipelinePart::PreRasterization: libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT; break;
+        case PipelinePart::FragmentShader: libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT; break;
+        case PipelinePart::FragmentOutput: libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT; break;
+        default: break;
+        }
+
+        // Retaining the optimization info lets a later link still optimize across parts
+        pipelineInfo.pNext = &libraryInfo;
+        pipelineInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    }
+
+    const VkPipelineCache cache = m_pipelineCache ? m_pipelineCache->GetCache() : VK_NULL_HANDLE;
+    VkResult result = vkCreateGraphicsPipelines(m_device->GetDevice(), cache, 1, &pipelineInfo, nullptr, &m_pipeline);
     if (result != VK_SUCCESS)
     {
         ReportError("Failed to create graphics pipeline. 0x00009400");
@@ -309,17 +372,154 @@ bool VulkanGraphicsPipeline::CreatePipeline()
     return true;
 }
 
+bool VulkanGraphicsPipeline::CreateLinkedPipeline()
+{
+    // Every piece of state comes from the parts; only the layout is given again
+    std::vector<VkPipeline> libraries;
+    libraries.reserve(m_linkedParts.size());
+    for (const auto& part : m_linkedParts)
+        libraries.push_back(part->GetPipeline());
+
+    VkPipelineLibraryCreateInfoKHR libraryInfo = {};
+    libraryInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+    libraryInfo.libraryCount = static_cast<uint32_t>(libraries.size());
+    libraryInfo.pLibraries = libraries.data();
+
+    VkGraphicsPipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = &libraryInfo;
+    pipelineInfo.flags = m_optimized ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    pipelineInfo.layout = m_pipelineLayout;
+    pipelineInfo.renderPass = m_renderPass->GetRenderPass();
+    pipelineInfo.subpass = 0;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    const VkPipelineCache cache = m_pipelineCache ? m_pipelineCache->GetCache() : VK_NULL_HANDLE;
+    VkResult result = vkCreateGraphicsPipelines(m_device->GetDevice(), cache, 1, &pipelineInfo, nullptr, &m_pipeline);
+    if (result != VK_SUCCESS)
+    {
+        ReportError("Failed to link graphics pipeline. 0x00009410");
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanGraphicsPipeline::UsesLayout() const
+{
+    // Vertex input and fragment output parts never see descriptors or push constants
+    return m_part != PipelinePart::VertexInput && m_part != PipelinePart::FragmentOutput;
+}
+
+bool VulkanGraphicsPipeline::UsesShader(const ShaderStage& shader) const
+{
+    switch (m_part)
+    {
+    case PipelinePart::Complete: return !IsLinked();
+    case PipelinePart::PreRasterization: return shader.stage != VK_SHADER_STAGE_FRAGMENT_BIT;
+    case PipelinePart::FragmentShader: return shader.stage == VK_SHADER_STAGE_FRAGMENT_BIT;
+    default: return false;
+    }
+}
+
 bool VulkanGraphicsPipeline::Initialize(
     std::shared_ptr<VulkanInstance> instance,
     std::shared_ptr<VulkanDevice> device,
     std::shared_ptr<VulkanRenderPass> renderPass,
-    const GraphicsPipelineConfig& config)
+    const GraphicsPipelineConfig& config,
+    std::shared_ptr<VulkanPipelineCache> pipelineCache,
+    std::shared_ptr<VulkanShaderModuleCache> shaderCache)
+{
+    m_part = PipelinePart::Complete;
+    m_linkedParts.clear();
+    m_optimized = true;
+
+    return InitializeCommon(instance, device, renderPass, config, pipelineCache, shaderCache);
+}
+
+bool VulkanGraphicsPipeline::InitializePart(
+    std::shared_ptr<VulkanInstance> instance,
+    std::shared_ptr<VulkanDevice> device,
+    std::shared_ptr<VulkanRenderPass> renderPass,
+    const GraphicsPipelineConfig& config,
+    PipelinePart part,
+    std::shared_ptr<VulkanPipelineCache> pipelineCache,
+    std::shared_ptr<VulkanShaderModuleCache> shaderCache)
+{
+    if (!device || !device->IsGraphicsPipelineLibraryEnabled())
+    {
+        ReportError("Graphics pipeline library not enabled on this device. 0x00009600");
+        return false;
+    }
+
+    if (part == PipelinePart::Complete)
+    {
+        ReportError("A part must name a slice of the pipeline. 0x00009610");
+        return false;
+    }
+
+    m_part = part;
+    m_linkedParts.clear();
+    m_optimized = false;
+
+    return InitializeCommon(instance, device, renderPass, config, pipelineCache, shaderCache);
+}
+
+bool VulkanGraphicsPipeline::InitializeLinked(
+    std::shared_ptr<VulkanInstance> instance,
+    std::shared_ptr<VulkanDevice> device,
+    std::shared_ptr<VulkanRenderPass> renderPass,
+    const GraphicsPipelineConfig& config,
+    const std::vector<std::shared_ptr<VulkanGraphicsPipeline>>& parts,
+    bool optimize,
+    std::shared_ptr<VulkanPipelineCache> pipelineCache)
+{
+    if (!device || !device->IsGraphicsPipelineLibraryEnabled())
+    {
+        ReportError("Graphics pipeline library not enabled on this device. 0x00009600");
+        return false;
+    }
+
+    // One of each slice, so the linked pipeline ends up complete
+    uint32_t seen = 0;
+    for (const auto& part : parts)
+    {
+        if (!part || !part->IsInitialized() || part->GetPart() == PipelinePart::Complete)
+        {
+            ReportError("Linking needs initialized parts. 0x00009620");
+            return false;
+        }
+        seen |= 1u << static_cast<uint32_t>(part->GetPart());
+    }
+
+    if (parts.size() != 4 || seen != 0x1Eu)
+    {
+        ReportError("Linking needs exactly one part of each kind. 0x00009630");
+        return false;
+    }
+
+    m_part = PipelinePart::Complete;
+    m_linkedParts = parts;
+    m_optimized = optimize;
+
+    return InitializeCommon(instance, device, renderPass, config, pipelineCache, nullptr);
+}
+
+bool VulkanGraphicsPipeline::InitializeCommon(
+    std::shared_ptr<VulkanInstance> instance,
+    std::shared_ptr<VulkanDevice> device,
+    std::shared_ptr<VulkanRenderPass> renderPass,
+    const GraphicsPipelineConfig& config,
+    std::shared_ptr<VulkanPipelineCache> pipelineCache,
+    std::shared_ptr<VulkanShaderModuleCache> shaderCache)
 {
     try
     {
         m_instance = instance;
         m_device = device;
         m_renderPass = renderPass;
+        m_pipelineCache = pipelineCache;
+        m_shaderCache = shaderCache;
         m_config = config;
 
         if (!ValidateDependencies())
@@ -328,10 +528,11 @@ bool VulkanGraphicsPipeline::Initialize(
         if (!ValidateConfig(m_config))
             return false;
 
-        if (!CreatePipelineLayout())
+        // Parts and the pipeline linked from them each get an identically defined layout
+        if (UsesLayout() && !CreatePipelineLayout())
             return false;
 
-        if (!CreatePipeline())
+        if (!(IsLinked() ? CreateLinkedPipeline() : CreatePipeline()))
             return false;
 
         return true;
@@ -354,6 +555,24 @@ void VulkanGraphicsPipeline::Bind(VkCommandBuffer commandBuffer)
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
 }
 
+void VulkanGraphicsPipeline::SetViewportAndScissor(VkCommandBuffer commandBuffer, VkExtent2D extent)
+{
+    VkViewport viewport = {};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    VkRect2D scissor = {};
+    scissor.offset = { 0, 0 };
+    scissor.extent = extent;
+
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
 std::string VulkanGraphicsPipeline::GetPipelineInfo() const
 {
     if (!IsInitialized())
@@ -365,6 +584,12 @@ std::string VulkanGraphicsPipeline::GetPipelineInfo() const
     output += "  Pipeline Handle: " + std::to_string(reinterpret_cast<uint64_t>(m_pipeline)) + "\n";
     output += "  Layout Handle: " + std::to_string(reinterpret_cast<uint64_t>(m_pipelineLayout)) + "\n";
     output += "  Shader Count: " + std::to_string(m_shaderModules.size()) + "\n";
-    output += "  Viewport: " + std::to_string(m_config.viewport.width) + "x" + std::to_string(m_config.viewport.height) + "\n";
+    output += "  Viewport: dynamic\n";
+    if (m_part != PipelinePart::Complete)
+        output += "  Built as: library part " + std::to_string(static_cast<uint32_t>(m_part)) + "\n";
+    else if (IsLinked())
+        output += std::string("  Built as: linked from parts, ") + (m_optimized ? "optimized\n" : "fast-linked\n");
+    else
+        output += "  Built as: monolithic\n";
     return output;
 }
\ No newline at end of file
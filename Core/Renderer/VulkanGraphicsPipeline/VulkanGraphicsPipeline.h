@@ -1,12 +1,16 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <bit>
+#include <map>
 #include <memory>
 #include <vector>
 #include <string>
 #include "../VulkanInstance/VulkanInstance.h"
 #include "../VulkanDevice/VulkanDevice.h"
 #include "../VulkanRenderPass/VulkanRenderPass.h"
+#include "../VulkanPipelineCache/VulkanPipelineCache.h"
+#include "../VulkanShaderModuleCache/VulkanShaderModuleCache.h"
 #include "../../DebugOutput/DubugOutput.h"
 
 // Types
@@ -15,15 +19,23 @@ struct ShaderStage
     std::string filepath;
     VkShaderStageFlagBits stage;
     std::string entryPoint = "main";
+    // constant_id -> value, 32-bit constants only. Each distinct map is its own pipeline
+    // variant, so the driver can strip the branches a variant turns off.
+    std::map<uint32_t, uint32_t> specialization;
+
+    ShaderStage& Specialize(uint32_t constantId, uint32_t value) { specialization[constantId] = value; return *this; }
+    ShaderStage& Specialize(uint32_t constantId, int32_t value) { return Specialize(constantId, std::bit_cast<uint32_t>(value)); }
+    ShaderStage& Specialize(uint32_t constantId, float value) { return Specialize(constantId, std::bit_cast<uint32_t>(value)); }
+    ShaderStage& Specialize(uint32_t constantId, bool value) { return Specialize(constantId, static_cast<uint32_t>(value ? VK_TRUE : VK_FALSE)); }
 
     static ShaderStage Vertex(const std::string& path)
     {
-        return { path, VK_SHADER_STAGE_VERTEX_BIT, "main" };
+        return { path, VK_SHADER_STAGE_VERTEX_BIT, "main", {} };
     }
 
     static ShaderStage Fragment(const std::string& path)
     {
-        return { path, VK_SHADER_STAGE_FRAGMENT_BIT, "main" };
+        return { path, VK_SHADER_STAGE_FRAGMENT_BIT, "main", {} };
     }
 };
 
@@ -55,7 +67,8 @@ struct GraphicsPipelineConfig
     bool depthWriteEnable = false;
     VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
     bool blendEnable = false;
-    VkExtent2D viewport = { 0, 0 };
+    // Viewport and scissor are dynamic state, so a pipeline outlives swapchain resizes.
+    // Set them after binding with SetViewportAndScissor.
 
     static GraphicsPipelineConfig SimpleTriangle(const std::string& vertPath, const std::string& fragPath)
     {
@@ -72,6 +85,18 @@ struct GraphicsPipelineConfig
     }
 };
 
+// Types
+// What a VulkanGraphicsPipeline holds. Parts are VK_EXT_graphics_pipeline_library
+// libraries covering one slice of the state; they cannot be bound, only linked.
+enum class PipelinePart : uint32_t
+{
+    Complete,         // Monolithic, or linked from parts
+    VertexInput,      // Vertex input and input assembly
+    PreRasterization, // Non-fragment shaders, viewport, rasterization
+    FragmentShader,   // Fragment shader, depth/stencil
+    FragmentOutput    // Color blend, multisampling
+};
+
 class VulkanGraphicsPipeline
 {
 public:
@@ -85,19 +110,47 @@ public:
     VulkanGraphicsPipeline& operator=(VulkanGraphicsPipeline&& other) noexcept;
 
     // Core
+    // pipelineCache is optional; without one every launch compiles from scratch.
+    // shaderCache is optional; without one each pipeline loads its own modules.
     bool Initialize(std::shared_ptr<VulkanInstance> instance,
         std::shared_ptr<VulkanDevice> device,
         std::shared_ptr<VulkanRenderPass> renderPass,
-        const GraphicsPipelineConfig& config);
+        const GraphicsPipelineConfig& config,
+        std::shared_ptr<VulkanPipelineCache> pipelineCache = nullptr,
+        std::shared_ptr<VulkanShaderModuleCache> shaderCache = nullptr);
+
+    // Graphics pipeline library
+    // Builds one part of config as a library; needs IsGraphicsPipelineLibraryEnabled.
+    bool InitializePart(std::shared_ptr<VulkanInstance> instance,
+        std::shared_ptr<VulkanDevice> device,
+        std::shared_ptr<VulkanRenderPass> renderPass,
+        const GraphicsPipelineConfig& config,
+        PipelinePart part,
+        std::shared_ptr<VulkanPipelineCache> pipelineCache = nullptr,
+        std::shared_ptr<VulkanShaderModuleCache> shaderCache = nullptr);
+    // Links one part of each kind, all built from config. Without optimize this is the
+    // fast link: near free, but the code may run slower than a monolithic pipeline.
+    bool InitializeLinked(std::shared_ptr<VulkanInstance> instance,
+        std::shared_ptr<VulkanDevice> device,
+        std::shared_ptr<VulkanRenderPass> renderPass,
+        const GraphicsPipelineConfig& config,
+        const std::vector<std::shared_ptr<VulkanGraphicsPipeline>>& parts,
+        bool optimize,
+        std::shared_ptr<VulkanPipelineCache> pipelineCache = nullptr);
+
     void Cleanup();
     bool IsInitialized() const { return m_pipeline != VK_NULL_HANDLE; }
 
     // Bind
     void Bind(VkCommandBuffer commandBuffer);
+    static void SetViewportAndScissor(VkCommandBuffer commandBuffer, VkExtent2D extent);
 
     // Getters
     VkPipeline GetPipeline() const { return m_pipeline; }
     VkPipelineLayout GetLayout() const { return m_pipelineLayout; }
+    PipelinePart GetPart() const { return m_part; }
+    bool IsLinked() const { return !m_linkedParts.empty(); }
+    bool IsOptimized() const { return m_optimized; } // Monolithic, or linked with link-time optimization
 
     // Debug
     std::string GetPipelineInfo() const;
@@ -106,19 +159,33 @@ private:
     std::shared_ptr<VulkanInstance> m_instance;
     std::shared_ptr<VulkanDevice> m_device;
     std::shared_ptr<VulkanRenderPass> m_renderPass;
+    std::shared_ptr<VulkanPipelineCache> m_pipelineCache;
+    std::shared_ptr<VulkanShaderModuleCache> m_shaderCache;
     VkPipeline m_pipeline = VK_NULL_HANDLE;
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
-    std::vector<VkShaderModule> m_shaderModules;
+    std::vector<std::shared_ptr<VulkanShaderModule>> m_shaderModules; // Possibly shared with other pipelines
     GraphicsPipelineConfig m_config;
+    PipelinePart m_part = PipelinePart::Complete;
+    std::vector<std::shared_ptr<VulkanGraphicsPipeline>> m_linkedParts; // Kept alive while linked
+    bool m_optimized = true;
 
     static const Debug::DebugOutput DebugOut;
 
     // Internal helpers
     bool ValidateDependencies() const;
     bool ValidateConfig(const GraphicsPipelineConfig& config) const;
-    bool LoadShaderModule(const std::string& filepath, VkShaderModule& outModule);
+    bool LoadShaderModule(const std::string& filepath, std::shared_ptr<VulkanShaderModule>& outModule);
     bool CreatePipelineLayout();
     bool CreatePipeline();
+    bool CreateLinkedPipeline();
+    bool InitializeCommon(std::shared_ptr<VulkanInstance> instance,
+        std::shared_ptr<VulkanDevice> device,
+        std::shared_ptr<VulkanRenderPass> renderPass,
+        const GraphicsPipelineConfig& config,
+        std::shared_ptr<VulkanPipelineCache> pipelineCache,
+        std::shared_ptr<VulkanShaderModuleCache> shaderCache);
+    bool UsesLayout() const;
+    bool UsesShader(const ShaderStage& shader) const;
     std::vector<char> ReadFile(const std::string& filename);
 
     void ReportError(const std::string& message) const
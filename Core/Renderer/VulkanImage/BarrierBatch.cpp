@@ -0,0 +1,302 @@
+#include "BarrierBatch.h"
+
+const Debug::DebugOutput BarrierBatch::DebugOut;
+
+static constexpr VkAccessFlags2 WriteAccessMask2 =
+    VK_ACCESS_2_SHADER_WRITE_BIT |
+    VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+    VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_2_TRANSFER_WRITE_BIT |
+    VK_ACCESS_2_HOST_WRITE_BIT |
+    VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+// The low 32 bits of the *2 flags match the original enums; only the split-out
+// stages and accesses above them need folding back into their legacy parents.
+static VkPipelineStageFlags ToLegacyStages(VkPipelineStageFlags2 stages, VkPipelineStageFlags fallback)
+{
+    VkPipelineStageFlags legacy = static_cast<VkPipelineStageFlags>(stages & 0xFFFFFFFFull);
+
+    if (stages & (VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT |
+        VK_PIPELINE_STAGE_2_RESOLVE_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT))
+        legacy |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+    if (stages & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT))
+        legacy |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+
+    if (stages & VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT)
+        legacy |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT |
+            VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT;
+
+    return legacy ? legacy : fallback;
+}
+
+static VkAccessFlags ToLegacyAccess(VkAccessFlags2 access)
+{
+    VkAccessFlags legacy = static_cast<VkAccessFlags>(access & 0xFFFFFFFFull);
+
+    if (access & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT))
+        legacy |= VK_ACCESS_SHADER_READ_BIT;
+
+    if (access & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT)
+        legacy |= VK_ACCESS_SHADER_WRITE_BIT;
+
+    return legacy;
+}
+
+VkImageAspectFlags BarrierBatch::AspectFromFormat(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_S8_UINT:
+        return VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+BarrierScope BarrierScope::ForLayout(VkImageLayout layout)
+{
+    switch (layout)
+    {
+    case VK_IMAGE_LAYOUT_UNDEFINED:
+    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+        return None();
+
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+        return Make(VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT,
+            VK_ACCESS_2_TRANSFER_WRITE_BIT);
+
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        return Make(VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT,
+            VK_ACCESS_2_TRANSFER_READ_BIT);
+
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+        return Make(VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        return Make(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+    case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
+        return Make(VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+    case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL:
+        return Make(VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT |
+            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+
+    default:
+        // GENERAL and anything unusual: no way to narrow it down
+        return Make(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT);
+    }
+}
+
+BarrierScope BarrierScope::WritesOnly() const
+{
+    return Make(stages, access & WriteAccessMask2);
+}
+
+BarrierBatch& BarrierBatch::Transition(AllocatedImage& image, VkImageLayout newLayout)
+{
+    return Transition(image, newLayout,
+        BarrierScope::ForLayout(image.currentLayout).WritesOnly(),
+        BarrierScope::ForLayout(newLayout));
+}
+
+BarrierBatch& BarrierBatch::Transition(AllocatedImage& image, VkImageLayout newLayout,
+    const BarrierScope& src, const BarrierScope& dst)
+{
+    // A second transition in the same batch skips the intermediate layout
+    for (auto& barrier : m_imageBarriers)
+    {
+        if (barrier.image != image.image)
+            continue;
+
+        barrier.newLayout = newLayout;
+        barrier.dstStageMask = dst.stages;
+        barrier.dstAccessMask = dst.access;
+        image.currentLayout = newLayout;
+        return *this;
+    }
+
+    VkImageSubresourceRange range = {};
+    range.aspectMask = AspectFromFormat(image.format);
+    range.baseMipLevel = 0;
+    range.levelCount = image.mipLevels;
+    range.baseArrayLayer = 0;
+    range.layerCount = image.arrayLayers;
+
+    Image(image.image, range, image.currentLayout, newLayout, src, dst);
+    image.currentLayout = newLayout;
+    return *this;
+}
+
+BarrierBatch& BarrierBatch::Image(VkImage image, const VkImageSubresourceRange& range,
+    VkImageLayout oldLayout, VkImageLayout newLayout,
+    const BarrierScope& src, const BarrierScope& dst)
+{
+    VkImageMemoryBarrier2 barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = src.stages;
+    barrier.srcAccessMask = src.access;
+    barrier.dstStageMask = dst.stages;
+    barrier.dstAccessMask = dst.access;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = range;
+
+    m_imageBarriers.push_back(barrier);
+    return *this;
+}
+
+BarrierBatch& BarrierBatch::Buffer(VkBuffer buffer, const BarrierScope& src, const BarrierScope& dst,
+    VkDeviceSize offset, VkDeviceSize size)
+{
+    VkBufferMemoryBarrier2 barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+    barrier.srcStageMask = src.stages;
+    barrier.srcAccessMask = src.access;
+    barrier.dstStageMask = dst.stages;
+    barrier.dstAccessMask = dst.access;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+
+    m_bufferBarriers.push_back(barrier);
+    return *this;
+}
+
+BarrierBatch& BarrierBatch::Memory(const BarrierScope& src, const BarrierScope& dst)
+{
+    VkMemoryBarrier2 barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = src.stages;
+    barrier.srcAccessMask = src.access;
+    barrier.dstStageMask = dst.stages;
+    barrier.dstAccessMask = dst.access;
+
+    m_memoryBarriers.push_back(barrier);
+    return *this;
+}
+
+void BarrierBatch::Flush(VkCommandBuffer commandBuffer)
+{
+    if (IsEmpty())
+        return;
+
+    if (commandBuffer == VK_NULL_HANDLE)
+    {
+        ReportError("Invalid command buffer. 0x00012300");
+        Clear();
+        return;
+    }
+
+    if (m_synchronization2)
+    {
+        VkDependencyInfo dependency = {};
+        dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependency.memoryBarrierCount = static_cast<uint32_t>(m_memoryBarriers.size());
+        dependency.pMemoryBarriers = m_memoryBarriers.data();
+        dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(m_bufferBarriers.size());
+        dependency.pBufferMemoryBarriers = m_bufferBarriers.data();
+        dependency.imageMemoryBarrierCount = static_cast<uint32_t>(m_imageBarriers.size());
+        dependency.pImageMemoryBarriers = m_imageBarriers.data();
+
+        vkCmdPipelineBarrier2(commandBuffer, &dependency);
+    }
+    else
+    {
+        FlushLegacy(commandBuffer);
+    }
+
+    m_flushCount++;
+    Clear();
+}
+
+void BarrierBatch::FlushLegacy(VkCommandBuffer commandBuffer) const
+{
+    // One call still, but stages are the union of every barrier's
+    VkPipelineStageFlags2 srcStages = 0;
+    VkPipelineStageFlags2 dstStages = 0;
+
+    std::vector<VkMemoryBarrier> memory;
+    for (const auto& barrier : m_memoryBarriers)
+    {
+        VkMemoryBarrier legacy = {};
+        legacy.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        legacy.srcAccessMask = ToLegacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = ToLegacyAccess(barrier.dstAccessMask);
+        memory.push_back(legacy);
+        srcStages |= barrier.srcStageMask;
+        dstStages |= barrier.dstStageMask;
+    }
+
+    std::vector<VkBufferMemoryBarrier> buffers;
+    for (const auto& barrier : m_bufferBarriers)
+    {
+        VkBufferMemoryBarrier legacy = {};
+        legacy.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        legacy.srcAccessMask = ToLegacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = ToLegacyAccess(barrier.dstAccessMask);
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.buffer = barrier.buffer;
+        legacy.offset = barrier.offset;
+        legacy.size = barrier.size;
+        buffers.push_back(legacy);
+        srcStages |= barrier.srcStageMask;
+        dstStages |= barrier.dstStageMask;
+    }
+
+    std::vector<VkImageMemoryBarrier> images;
+    for (const auto& barrier : m_imageBarriers)
+    {
+        VkImageMemoryBarrier legacy = {};
+        legacy.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        legacy.srcAccessMask = ToLegacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = ToLegacyAccess(barrier.dstAccessMask);
+        legacy.oldLayout = barrier.oldLayout;
+        legacy.newLayout = barrier.newLayout;
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.image = barrier.image;
+        legacy.subresourceRange = barrier.subresourceRange;
+        images.push_back(legacy);
+        srcStages |= barrier.srcStageMask;
+        dstStages |= barrier.dstStageMask;
+    }
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        ToLegacyStages(srcStages, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+        ToLegacyStages(dstStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT),
+        0,
+        static_cast<uint32_t>(memory.size()), memory.data(),
+        static_cast<uint32_t>(buffers.size()), buffers.data(),
+        static_cast<uint32_t>(images.size()), images.data()
+    );
+}
+
+void BarrierBatch::Clear()
+{
+    m_memoryBarriers.clear();
+    m_bufferBarriers.clear();
+    m_imageBarriers.clear();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+#include "../VulkanMemoryAllocator/VulkanMemoryAllocator.h"
+#include "../../DebugOutput/DubugOutput.h"
+
+// Types
+// Stages and accesses on one side of a barrier
+struct BarrierScope
+{
+    VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 access = VK_ACCESS_2_NONE;
+
+    // How an image in this layout is normally used. UNDEFINED and PRESENT_SRC have an
+    // empty scope: nothing to wait for, or a semaphore does the waiting.
+    static BarrierScope ForLayout(VkImageLayout layout);
+
+    static BarrierScope None() { return {}; }
+    static BarrierScope Make(VkPipelineStageFlags2 stages, VkAccessFlags2 access)
+    {
+        BarrierScope scope;
+        scope.stages = stages;
+        scope.access = access;
+        return scope;
+    }
+
+    BarrierScope WritesOnly() const; // Reads never need to be made available
+};
+
+// Accumulates memory, buffer and image barriers and records all of them with one
+// vkCmdPipelineBarrier2. Transitions of the same image within a batch collapse into
+// one barrier, since barriers in a single call are not ordered against each other.
+class BarrierBatch
+{
+public:
+    explicit BarrierBatch(bool synchronization2 = true) : m_synchronization2(synchronization2) {}
+
+    // Image
+    BarrierBatch& Transition(AllocatedImage& image, VkImageLayout newLayout); // Scopes from the layouts
+    BarrierBatch& Transition(AllocatedImage& image, VkImageLayout newLayout,
+        const BarrierScope& src, const BarrierScope& dst);
+    BarrierBatch& Image(VkImage image, const VkImageSubresourceRange& range,
+        VkImageLayout oldLayout, VkImageLayout newLayout,
+        const BarrierScope& src, const BarrierScope& dst);
+
+    // Buffer
+    BarrierBatch& Buffer(VkBuffer buffer, const BarrierScope& src, const BarrierScope& dst,
+        VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+    // Global
+    BarrierBatch& Memory(const BarrierScope& src, const BarrierScope& dst);
+
+    // Recording
+    void Flush(VkCommandBuffer commandBuffer); // Records everything in one call and empties the batch
+    void Clear();
+
+    // Getters
+    bool IsEmpty() const { return m_memoryBarriers.empty() && m_bufferBarriers.empty() && m_imageBarriers.empty(); }
+    const std::vector<VkMemoryBarrier2>& GetMemoryBarriers() const { return m_memoryBarriers; }
+    const std::vector<VkBufferMemoryBarrier2>& GetBufferBarriers() const { return m_bufferBarriers; }
+    const std::vector<VkImageMemoryBarrier2>& GetImageBarriers() const { return m_imageBarriers; }
+    uint32_t GetFlushCount() const { return m_flushCount; }
+
+    static VkImageAspectFlags AspectFromFormat(VkFormat format);
+
+private:
+    bool m_synchronization2 = true;
+    std::vector<VkMemoryBarrier2> m_memoryBarriers;
+    std::vector<VkBufferMemoryBarrier2> m_bufferBarriers;
+    std::vector<VkImageMemoryBarrier2> m_imageBarriers;
+    uint32_t m_flushCount = 0;
+
+    static const Debug::DebugOutput DebugOut;
+
+    void FlushLegacy(VkCommandBuffer commandBuffer) const;
+
+    void ReportError(const std::string& message) const
+    {
+        DebugOut.outputDebug("BarrierBatch Error: " + message);
+    }
+};
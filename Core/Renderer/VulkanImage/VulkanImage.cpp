@@ -189,6 +189,11 @@ bool VulkanImage::CreateImage(const ImageCreateInfo& createInfo, AllocatedImage&
         allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
         allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
+        const bool renderTarget = (createInfo.usage &
+            (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) != 0;
+        MemoryPoolClass poolClass = renderTarget ? MemoryPoolClass::RenderTargets : MemoryPoolClass::StreamingTextures;
+        allocInfo.pool = m_allocator->GetPool(poolClass);
+
         VkImage image = VK_NULL_HANDLE;
         VmaAllocation allocation = VK_NULL_HANDLE;
         VmaAllocationInfo allocationInfo = {};
@@ -202,6 +207,20 @@ bool VulkanImage::CreateImage(const ImageCreateInfo& createInfo, AllocatedImage&
             &allocationInfo
         );
 
+        if (result != VK_SUCCESS && allocInfo.pool != VK_NULL_HANDLE &&
+            m_allocator->GetPoolConfig(poolClass).allowOverflow)
+        {
+            ReportWarning(std::string("Pool '") + MemoryPoolClassToString(poolClass) +
+                "' cannot fit image, using default heaps. 0x00011015");
+
+            allocInfo.pool = VK_NULL_HANDLE;
+            result = vmaCreateImage(m_allocator->GetAllocator(), &imageInfo, &allocInfo,
+                &image, &allocation, &allocationInfo);
+        }
+
+        if (allocInfo.pool == VK_NULL_HANDLE)
+            poolClass = MemoryPoolClass::Default;
+
         if (result != VK_SUCCESS)
         {
             ReportError("Failed to create image. 0x00011020");
@@ -218,6 +237,11 @@ bool VulkanImage::CreateImage(const ImageCreateInfo& createInfo, AllocatedImage&
         outImage.mipLevels = createInfo.mipLevels;
         outImage.arrayLayers = createInfo.arrayLayers;
         outImage.currentLayout = createInfo.initialLayout;
+        outImage.usage = createInfo.usage;
+        outImage.pool = poolClass;
+        outImage.tag = renderTarget ? MemoryUsageTag::RenderTarget : MemoryUsageTag::Texture;
+
+        m_allocator->TrackAllocation(outImage.tag, allocationInfo.size);
 
         return true;
     }
@@ -247,6 +271,9 @@ void VulkanImage::DestroyImage(AllocatedImage& image)
         return;
     }
 
+    m_allocator->ForgetMovable(image.allocation);
+    m_allocator->UntrackAllocation(image.tag, image.allocationInfo.size);
+
     vmaDestroyImage(m_allocator->GetAllocator(), image.image, image.allocation);
 
     image.image = VK_NULL_HANDLE;
@@ -259,40 +286,48 @@ void VulkanImage::DestroyImage(AllocatedImage& image)
     image.currentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 }
 
-VkAccessFlags VulkanImage::GetAccessMask(VkImageLayout layout) const
+void VulkanImage::DeferDestroyImage(AllocatedImage& image)
 {
-    switch (layout)
-    {
-    case VK_IMAGE_LAYOUT_UNDEFINED:
-        return 0;  
-
-    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-        return VK_ACCESS_TRANSFER_WRITE_BIT;  // Writing w/ transfer
+    if (!image.IsValid())
+        return;
 
-    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-        return VK_ACCESS_TRANSFER_READ_BIT;  // Reading w/ transfer
+    if (!m_allocator || !m_allocator->IsInitialized())
+    {
+        ReportError("Cannot defer image destruction: allocator not initialized. 0x00011120");
+        return;
+    }
 
-    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-        return VK_ACCESS_SHADER_READ_BIT;  // Reading in shader
+    m_allocator->ForgetMovable(image.allocation);
 
-    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-        return VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;  // Writing as render target
+    VulkanMemoryAllocator* allocator = m_allocator.get();
+    AllocatedImage retired = image;
 
-    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
-        return 0; 
+    m_allocator->DeferDestruction([allocator, retired]() {
+        allocator->UntrackAllocation(retired.tag, retired.allocationInfo.size);
+        vmaDestroyImage(allocator->GetAllocator(), retired.image, retired.allocation);
+    });
 
-    default:
-        return 0;
-    }
+    image = AllocatedImage{};
 }
 
 bool VulkanImage::TransitionLayout(
     VkCommandBuffer cmd,
     AllocatedImage& image,
-    VkImageLayout newLayout,
-    VkPipelineStageFlags srcStage,
-    VkPipelineStageFlags dstStage
+    VkImageLayout newLayout
+)
+{
+    BarrierBatch batch = CreateBarrierBatch();
+    if (!TransitionLayout(batch, image, newLayout))
+        return false;
+
+    batch.Flush(cmd);
+    return true;
+}
 
+bool VulkanImage::TransitionLayout(
+    BarrierBatch& batch,
+    AllocatedImage& image,
+    VkImageLayout newLayout
 )
 {
     if (!IsInitialized())
@@ -306,38 +341,15 @@ bool VulkanImage::TransitionLayout(
         ReportError("Image provided not valid. 0x00012010");
         return false;
     }
-    
-    VkImageMemoryBarrier barrier{}; 
-    barrier.image = image.image; 
-    barrier.oldLayout = image.currentLayout; 
-    barrier.newLayout = newLayout; 
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED; // Ignoring here | Not transferring bewteen
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED; // Same reason here  
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER; 
-    barrier.subresourceRange.aspectMask = AspectFromFormat(image.format);
-    barrier.subresourceRange.baseMipLevel = 0;
-    
-    barrier.subresourceRange.levelCount = image.mipLevels; 
-    barrier.subresourceRange.baseArrayLayer = 0; 
-    barrier.subresourceRange.layerCount = image.arrayLayers; 
-
-    barrier.srcAccessMask = GetAccessMask(image.currentLayout); 
-    barrier.dstAccessMask = GetAccessMask(newLayout); 
-
-    vkCmdPipelineBarrier(
-        cmd,
-        srcStage,
-        dstStage,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier
-    ); 
-
-    image.currentLayout = newLayout; 
 
+    // Stages and accesses come from the layouts, e.g. COPY -> FRAGMENT_SHADER for an upload
+    batch.Transition(image, newLayout);
     return true;
+}
 
+BarrierBatch VulkanImage::CreateBarrierBatch() const
+{
+    return BarrierBatch(m_device && m_device->IsSynchronization2Enabled());
 }
 
 bool VulkanImage::UploadData(
@@ -390,12 +402,7 @@ bool VulkanImage::UploadData(
         return false;
     }
 
-    if (!TransitionLayout(
-        cmd,
-        image,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-        VK_PIPELINE_STAGE_TRANSFER_BIT))
+    if (!TransitionLayout(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL))
     {
         m_allocator->DestroyBuffer(stagingBuffer);
         ReportError("Failed to transition to TRANSFER_DST. 0x00012065");
@@ -427,13 +434,7 @@ bool VulkanImage::UploadData(
     );
 
     if (transitionToShaderOptimal) {
-        if (!TransitionLayout(
-            cmd,
-            image,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,       
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT  
-        )) {
+        if (!TransitionLayout(cmd, image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)) {
             m_allocator->DestroyBuffer(stagingBuffer);
             ReportError("Failed to transition to SHADER_READ. 0x00012067");
             return false;
@@ -8,6 +8,7 @@
 #include "../VulkanDevice/VulkanDevice.h"
 #include "../VulkanMemoryAllocator/VulkanMemoryAllocator.h"
 #include "../VulkanCommandBuffer/VulkanCommandBuffer.h"
+#include "BarrierBatch.h"
 #include "../../DebugOutput/DubugOutput.h"
 
 struct ImageOptions 
@@ -120,14 +121,22 @@ public:
     bool CreateImage(const ImageCreateInfo& createInfo, AllocatedImage& outImage);
 
     void DestroyImage(AllocatedImage& image);
+    void DeferDestroyImage(AllocatedImage& image); // Destroyed once the GPU finished the current frame
 
+    // Records one barrier now
     bool TransitionLayout(
         VkCommandBuffer cmd,
         AllocatedImage& image,
-        VkImageLayout newLayout,
-        VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-        VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+        VkImageLayout newLayout
     );
+
+    // Queues the barrier; many transitions share one vkCmdPipelineBarrier2 at batch.Flush
+    bool TransitionLayout(
+        BarrierBatch& batch,
+        AllocatedImage& image,
+        VkImageLayout newLayout
+    );
+    BarrierBatch CreateBarrierBatch() const; // Falls back to legacy barriers without synchronization2
     
     bool UploadData(
         VulkanCommandBuffer* commandBuffer,
@@ -150,8 +159,6 @@ private:
     bool ValidateDependencies() const;
     bool ValidateImageCreateInfo(const ImageCreateInfo& createInfo) const;
 
-    VkAccessFlags GetAccessMask(VkImageLayout layout) const; 
-
     void ReportError(const std::string& message) const {
         DebugOut.outputDebug("VulkanImage Error: " + message);
     }
@@ -3,6 +3,38 @@
 
 #include "VulkanMemoryAllocator.h"
 #include <memory>
+#include <fstream>
+#include <algorithm>
+
+const Debug::DebugOutput VulkanMemoryAllocator::DebugOut;
+
+const char* MemoryUsageTagToString(MemoryUsageTag tag)
+{
+	switch (tag)
+	{
+	case MemoryUsageTag::Vertex:       return "vertex";
+	case MemoryUsageTag::Index:        return "index";
+	case MemoryUsageTag::Texture:      return "texture";
+	case MemoryUsageTag::Staging:      return "staging";
+	case MemoryUsageTag::Uniform:      return "uniform";
+	case MemoryUsageTag::RenderTarget: return "renderTarget";
+	case MemoryUsageTag::Other:
+	default:                           return "other";
+	}
+}
+
+const char* MemoryPoolClassToString(MemoryPoolClass pool)
+{
+	switch (pool)
+	{
+	case MemoryPoolClass::RenderTargets:     return "renderTargets";
+	case MemoryPoolClass::StreamingTextures: return "streamingTextures";
+	case MemoryPoolClass::StaticGeometry:    return "staticGeometry";
+	case MemoryPoolClass::Staging:           return "staging";
+	case MemoryPoolClass::Default:
+	default:                                 return "default";
+	}
+}
 
 VulkanMemoryAllocator::VulkanMemoryAllocator()
 {
@@ -14,10 +46,31 @@ void VulkanMemoryAllocator::Cleanup()
 {
 	if (m_allocator != VK_NULL_HANDLE)
 	{
+		EndDefragmentation();
+		m_movables.clear();
+		m_defragListeners.clear();
+
+		FlushDeletionQueue();
+		DestroyPools();
+
 		vmaDestroyAllocator(m_allocator);
 		m_allocator = VK_NULL_HANDLE;
 	}
 
+	for (size_t i = 0; i < m_tagBytes.size(); ++i)
+	{
+		m_tagBytes[i] = 0;
+		m_tagCounts[i] = 0;
+	}
+	m_lastBudgetSnapshot.clear();
+	m_directUploads = 0;
+	m_stagedUploads = 0;
+	m_directUploadBytes = 0;
+	m_stagedUploadBytes = 0;
+	m_hostVisibleDeviceLocalBytes = 0;
+	m_bufferDeviceAddress = false;
+
+	m_timeline.reset();
 	m_device.reset(); 
 	m_instance.reset(); 
 	m_preferredLargeHeapBlockSize = 0;
@@ -126,8 +179,8 @@ bool VulkanMemoryAllocator::CreateVertexBuffer(
 	memcpy(stagingBuffer.mappedData, vertices, size);
 	UnmapMemory(stagingBuffer);
 
-	if (!CreateBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-		MemoryAllocationInfo::DeviceLocal(), outBuffer))
+	if (!CreateBuffer(size, GeometryUsage(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT),
+		MemoryAllocationInfo::StaticGeometry(), outBuffer))
 	{
 		DestroyBuffer(stagingBuffer);
 		ReportError("Failed to create vertex buffer. 0x00003315");
@@ -173,8 +226,8 @@ bool VulkanMemoryAllocator::CreateIndexBuffer(
 	memcpy(stagingBuffer.mappedData, indices, size);
 	UnmapMemory(stagingBuffer);
 
-	if (!CreateBuffer(size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-		MemoryAllocationInfo::DeviceLocal(), outBuffer))
+	if (!CreateBuffer(size, GeometryUsage(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT),
+		MemoryAllocationInfo::StaticGeometry(), outBuffer))
 	{
 		DestroyBuffer(stagingBuffer);
 		ReportError("Failed to create vertex buffer. 0x00003315");
@@ -242,7 +295,7 @@ bool VulkanMemoryAllocator::CreateUniformBuffer(
 	}
 
 	if (!CreateBuffer(size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-		MemoryAllocationInfo::HostVisible(), outBuffer))
+		MemoryAllocationInfo::HostVisiblePreferDevice(), outBuffer))
 	{
 		ReportError("Failed to create uniform buffer. 0x000030B0");
 		return false;
@@ -320,9 +373,13 @@ void VulkanMemoryAllocator::DestroyBuffer(AllocatedBuffer& buffer)
 	if (!buffer.IsValid())
 		return;
 
+	ForgetMovable(buffer.allocation);
+
 	if (buffer.isPersistentlyMapped && buffer.mappedData)
 		UnmapMemory(buffer);
 
+	UntrackAllocation(buffer.tag, buffer.allocationInfo.size);
+
 	vmaDestroyBuffer(m_allocator, buffer.buffer, buffer.allocation);
 
 	buffer.buffer = VK_NULL_HANDLE; 
@@ -333,6 +390,20 @@ void VulkanMemoryAllocator::DestroyBuffer(AllocatedBuffer& buffer)
 	buffer.allocationInfo = {};
 }
 
+void VulkanMemoryAllocator::DeferDestroyBuffer(AllocatedBuffer& buffer)
+{
+	if (!buffer.IsValid())
+		return;
+
+	// The caller's struct goes away now, so it must leave the defrag registry now too.
+	ForgetMovable(buffer.allocation);
+
+	AllocatedBuffer retired = buffer;
+	DeferDestruction([this, retired]() mutable { DestroyBuffer(retired); });
+
+	buffer = AllocatedBuffer{};
+}
+
 bool VulkanMemoryAllocator::CreateBuffer(
 	size_t size, 
 	VkBufferUsageFlags usage,
@@ -340,6 +411,12 @@ bool VulkanMemoryAllocator::CreateBuffer(
 	AllocatedBuffer& outBuffer
 )
 {
+	if ((usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) && !m_bufferDeviceAddress)
+	{
+		ReportError("Buffer device address requested but not enabled on this device. 0x00003106");
+		return false;
+	}
+
 	VkBufferCreateInfo bufferInfo = {}; 
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	bufferInfo.size = size; 
@@ -352,6 +429,7 @@ bool VulkanMemoryAllocator::CreateBuffer(
 	allocInfo.requiredFlags = memInfo.requiredFlags;
 	allocInfo.preferredFlags = memInfo.preferredFlags; 
 	allocInfo.priority = memInfo.priority; 
+	allocInfo.pool = GetPool(memInfo.pool);
 
 	VkResult result = vmaCreateBuffer(
 		m_allocator,
@@ -360,6 +438,19 @@ bool VulkanMemoryAllocator::CreateBuffer(
 		&outBuffer.buffer,
 		&outBuffer.allocation,
 		&outBuffer.allocationInfo); 
+
+	outBuffer.pool = allocInfo.pool != VK_NULL_HANDLE ? memInfo.pool : MemoryPoolClass::Default;
+
+	if (result != VK_SUCCESS && allocInfo.pool != VK_NULL_HANDLE && GetPoolConfig(memInfo.pool).allowOverflow)
+	{
+		ReportWarning(std::string("Pool '") + MemoryPoolClassToString(memInfo.pool) +
+			"' cannot fit buffer, using default heaps. 0x00003105");
+
+		allocInfo.pool = VK_NULL_HANDLE;
+		outBuffer.pool = MemoryPoolClass::Default;
+		result = vmaCreateBuffer(m_allocator, &bufferInfo, &allocInfo,
+			&outBuffer.buffer, &outBuffer.allocation, &outBuffer.allocationInfo);
+	}
 	
 	if (result != VK_SUCCESS)
 	{
@@ -369,6 +460,10 @@ bool VulkanMemoryAllocator::CreateBuffer(
 
 	outBuffer.size = size; 
 	outBuffer.usage = usage; 
+	outBuffer.deviceAddress = (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) ? GetBufferAddress(outBuffer.buffer) : 0;
+	outBuffer.tag = memInfo.tag != MemoryUsageTag::Other ? memInfo.tag : InferUsageTag(usage);
+
+	TrackAllocation(outBuffer.tag, outBuffer.allocationInfo.size);
 
 	return true;
 
@@ -405,6 +500,11 @@ bool VulkanMemoryAllocator::Initialize(
 	if (preferredLargeHeapBlockSize > 0)
 		allocatorInfo.preferredLargeHeapBlockSize = preferredLargeHeapBlockSize; 
 
+	// Memory blocks need VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT before buffers in them can be addressed.
+	m_bufferDeviceAddress = m_device->IsBufferDeviceAddressEnabled();
+	if (m_bufferDeviceAddress)
+		allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+
 	VkResult result = vmaCreateAllocator(&allocatorInfo, &m_allocator);
 
 	if (result != VK_SUCCESS)
@@ -412,7 +512,1219 @@ bool VulkanMemoryAllocator::Initialize(
 		ReportError("Failed to create VMA allocator. 0x00003020");
 		return false;
 	}
+
+	DetectHostVisibleDeviceLocal();
+
+	for (uint32_t i = 1; i < static_cast<uint32_t>(MemoryPoolClass::Count); ++i)
+	{
+		const MemoryPoolClass pool = static_cast<MemoryPoolClass>(i);
+
+		// A missing pool only costs isolation; allocations fall back to the default heaps.
+		if (!CreatePool(pool, MemoryPoolConfig::For(pool)))
+			ReportWarning(std::string("Pool '") + MemoryPoolClassToString(pool) + "' unavailable. 0x00003025");
+	}
 	
 	return true; 
 
 }
+
+MemoryUsageTag VulkanMemoryAllocator::InferUsageTag(VkBufferUsageFlags usage) const
+{
+	if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+		return MemoryUsageTag::Vertex;
+
+	if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+		return MemoryUsageTag::Index;
+
+	if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+		return MemoryUsageTag::Uniform;
+
+	if (usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+		return MemoryUsageTag::Staging;
+
+	return MemoryUsageTag::Other;
+}
+
+void VulkanMemoryAllocator::TrackAllocation(MemoryUsageTag tag, VkDeviceSize size)
+{
+	const size_t index = static_cast<size_t>(tag);
+	if (index >= m_tagBytes.size())
+		return;
+
+	m_tagBytes[index].fetch_add(size, std::memory_order_relaxed);
+	m_tagCounts[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+void VulkanMemoryAllocator::UntrackAllocation(MemoryUsageTag tag, VkDeviceSize size)
+{
+	const size_t index = static_cast<size_t>(tag);
+	if (index >= m_tagBytes.size())
+		return;
+
+	m_tagBytes[index].fetch_sub(size, std::memory_order_relaxed);
+	m_tagCounts[index].fetch_sub(1, std::memory_order_relaxed);
+}
+
+void VulkanMemoryAllocator::SnapshotBudgets() const
+{
+	const VkPhysicalDeviceMemoryProperties* memProps = nullptr;
+	vmaGetMemoryProperties(m_allocator, &memProps);
+
+	m_lastBudgetSnapshot.resize(memProps->memoryHeapCount);
+	vmaGetHeapBudgets(m_allocator, m_lastBudgetSnapshot.data());
+}
+
+void VulkanMemoryAllocator::BeginFrame(uint32_t frameIndex)
+{
+	if (!IsInitialized())
+		return;
+
+	m_currentFrameIndex = frameIndex;
+	vmaSetCurrentFrameIndex(m_allocator, frameIndex);
+
+	if (m_timeline && m_timeline->IsTimelineEnabled())
+		CollectGarbage(m_timeline->GetCompletedValue());
+	else if (frameIndex >= m_framesInFlight)
+		CollectGarbage(frameIndex - m_framesInFlight);
+
+	SnapshotBudgets();
+}
+
+MemoryStatistics VulkanMemoryAllocator::GetStatistics(bool detailed) const
+{
+	MemoryStatistics stats;
+
+	if (!IsInitialized())
+	{
+		ReportWarning("Statistics requested before initialization. 0x00003800");
+		return stats;
+	}
+
+	if (m_lastBudgetSnapshot.empty())
+		SnapshotBudgets();
+
+	const VkPhysicalDeviceMemoryProperties* memProps = nullptr;
+	vmaGetMemoryProperties(m_allocator, &memProps);
+
+	stats.frameIndex = m_currentFrameIndex;
+	stats.heapBudgets = m_lastBudgetSnapshot;
+	stats.heapFlags.resize(memProps->memoryHeapCount);
+
+	for (uint32_t heap = 0; heap < memProps->memoryHeapCount; ++heap)
+	{
+		const VmaBudget& budget = stats.heapBudgets[heap];
+		stats.heapFlags[heap] = memProps->memoryHeaps[heap].flags;
+
+		stats.totalAllocatedBytes += static_cast<size_t>(budget.statistics.blockBytes);
+		stats.totalUsedBytes += static_cast<size_t>(budget.statistics.allocationBytes);
+		stats.allocationCount += budget.statistics.allocationCount;
+
+		bool hostVisible = false;
+		for (uint32_t type = 0; type < memProps->memoryTypeCount; ++type)
+		{
+			if (memProps->memoryTypes[type].heapIndex == heap &&
+				(memProps->memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+			{
+				hostVisible = true;
+				break;
+			}
+		}
+
+		// A ReBAR heap is both device local and host visible, so it is counted in both.
+		if (memProps->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			stats.deviceLocalBytes += static_cast<size_t>(budget.statistics.allocationBytes);
+
+		if (hostVisible)
+			stats.hostVisibleBytes += static_cast<size_t>(budget.statistics.allocationBytes);
+	}
+
+	for (size_t i = 0; i < stats.tags.size(); ++i)
+	{
+		stats.tags[i].bytes = static_cast<size_t>(m_tagBytes[i].load(std::memory_order_relaxed));
+		stats.tags[i].allocationCount = m_tagCounts[i].load(std::memory_order_relaxed);
+	}
+
+	stats.stagingBytes = stats.GetTag(MemoryUsageTag::Staging).bytes;
+
+	for (size_t i = 0; i < stats.pools.size(); ++i)
+		stats.pools[i] = GetPoolStatistics(static_cast<MemoryPoolClass>(i));
+
+	stats.hostVisibleDeviceLocalHeapBytes = m_hostVisibleDeviceLocalBytes;
+	stats.uploads.directUploads = m_directUploads.load(std::memory_order_relaxed);
+	stats.uploads.stagedUploads = m_stagedUploads.load(std::memory_order_relaxed);
+	stats.uploads.directBytes = m_directUploadBytes.load(std::memory_order_relaxed);
+	stats.uploads.stagedBytes = m_stagedUploadBytes.load(std::memory_order_relaxed);
+
+	if (detailed)
+	{
+		VmaTotalStatistics total = {};
+		vmaCalculateStatistics(m_allocator, &total);
+
+		stats.totalAllocatedBytes = static_cast<size_t>(total.total.statistics.blockBytes);
+		stats.totalUsedBytes = static_cast<size_t>(total.total.statistics.allocationBytes);
+		stats.allocationCount = total.total.statistics.allocationCount;
+		stats.unusedRangeCount = total.total.unusedRangeCount;
+		stats.detailed = true;
+	}
+
+	return stats;
+}
+
+std::string VulkanMemoryAllocator::GetStatisticsJson(bool detailed) const
+{
+	const MemoryStatistics stats = GetStatistics(detailed);
+
+	std::string json = "{\n";
+	json += "  \"frameIndex\": " + std::to_string(stats.frameIndex) + ",\n";
+	json += "  \"detailed\": " + std::string(stats.detailed ? "true" : "false") + ",\n";
+	json += "  \"totalAllocatedBytes\": " + std::to_string(stats.totalAllocatedBytes) + ",\n";
+	json += "  \"totalUsedBytes\": " + std::to_string(stats.totalUsedBytes) + ",\n";
+	json += "  \"allocationCount\": " + std::to_string(stats.allocationCount) + ",\n";
+	json += "  \"unusedRangeCount\": " + std::to_string(stats.unusedRangeCount) + ",\n";
+	json += "  \"deviceLocalBytes\": " + std::to_string(stats.deviceLocalBytes) + ",\n";
+	json += "  \"hostVisibleBytes\": " + std::to_string(stats.hostVisibleBytes) + ",\n";
+	json += "  \"stagingBytes\": " + std::to_string(stats.stagingBytes) + ",\n";
+	json += "  \"hostVisibleDeviceLocalHeapBytes\": " + std::to_string(stats.hostVisibleDeviceLocalHeapBytes) + ",\n";
+	json += "  \"uploads\": { \"direct\": " + std::to_string(stats.uploads.directUploads);
+	json += ", \"directBytes\": " + std::to_string(stats.uploads.directBytes);
+	json += ", \"staged\": " + std::to_string(stats.uploads.stagedUploads);
+	json += ", \"stagedBytes\": " + std::to_string(stats.uploads.stagedBytes) + " },\n";
+
+	json += "  \"heaps\": [";
+	for (size_t heap = 0; heap < stats.heapBudgets.size(); ++heap)
+	{
+		const VmaBudget& budget = stats.heapBudgets[heap];
+		json += heap ? ",\n" : "\n";
+		json += "    { \"index\": " + std::to_string(heap);
+		json += ", \"deviceLocal\": " + std::string((stats.heapFlags[heap] & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "true" : "false");
+		json += ", \"usage\": " + std::to_string(budget.usage);
+		json += ", \"budget\": " + std::to_string(budget.budget);
+		json += ", \"blockBytes\": " + std::to_string(budget.statistics.blockBytes);
+		json += ", \"allocationBytes\": " + std::to_string(budget.statistics.allocationBytes);
+		json += ", \"blockCount\": " + std::to_string(budget.statistics.blockCount);
+		json += ", \"allocationCount\": " + std::to_string(budget.statistics.allocationCount) + " }";
+	}
+	json += "\n  ],\n";
+
+	json += "  \"tags\": {";
+	for (size_t i = 0; i < stats.tags.size(); ++i)
+	{
+		json += i ? ",\n" : "\n";
+		json += "    \"" + std::string(MemoryUsageTagToString(static_cast<MemoryUsageTag>(i))) + "\": ";
+		json += "{ \"bytes\": " + std::to_string(stats.tags[i].bytes);
+		json += ", \"allocations\": " + std::to_string(stats.tags[i].allocationCount) + " }";
+	}
+	json += "\n  },\n";
+
+	json += "  \"pools\": {";
+	for (size_t i = 1; i < stats.pools.size(); ++i)
+	{
+		const MemoryPoolStatistics& pool = stats.pools[i];
+		json += i > 1 ? ",\n" : "\n";
+		json += "    \"" + std::string(MemoryPoolClassToString(static_cast<MemoryPoolClass>(i))) + "\": ";
+		json += "{ \"active\": " + std::string(pool.active ? "true" : "false");
+		json += ", \"memoryType\": " + std::to_string(pool.memoryTypeIndex);
+		json += ", \"budget\": " + std::to_string(pool.budgetBytes);
+		json += ", \"blockBytes\": " + std::to_string(pool.blockBytes);
+		json += ", \"allocationBytes\": " + std::to_string(pool.allocationBytes);
+		json += ", \"blockCount\": " + std::to_string(pool.blockCount);
+		json += ", \"allocationCount\": " + std::to_string(pool.allocationCount) + " }";
+	}
+	json += "\n  }\n}\n";
+
+	return json;
+}
+
+bool VulkanMemoryAllocator::ExportStatisticsJson(const std::string& filepath, bool detailed) const
+{
+	std::ofstream file(filepath, std::ios::out | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		ReportError("Failed to open statistics file: " + filepath + ". 0x00003810");
+		return false;
+	}
+
+	file << GetStatisticsJson(detailed);
+	return true;
+}
+
+bool VulkanMemoryAllocator::RegisterMovable(AllocatedBuffer* buffer)
+{
+	if (!buffer || !buffer->IsValid())
+	{
+		ReportError("Cannot register invalid buffer for defragmentation. 0x00003900");
+		return false;
+	}
+
+	const VkBufferUsageFlags copyUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	if ((buffer->usage & copyUsage) != copyUsage)
+	{
+		ReportWarning("Buffer needs TRANSFER_SRC and TRANSFER_DST usage to be movable. 0x00003905");
+		return false;
+	}
+
+	if (buffer->mappedData)
+	{
+		ReportWarning("Mapped buffers cannot be moved. 0x00003908");
+		return false;
+	}
+
+	m_movables[buffer->allocation] = { buffer, nullptr };
+	return true;
+}
+
+bool VulkanMemoryAllocator::RegisterMovable(AllocatedImage* image)
+{
+	if (!image || !image->IsValid())
+	{
+		ReportError("Cannot register invalid image for defragmentation. 0x00003910");
+		return false;
+	}
+
+	const VkImageUsageFlags copyUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	if ((image->usage & copyUsage) != copyUsage)
+	{
+		ReportWarning("Image needs TRANSFER_SRC and TRANSFER_DST usage to be movable. 0x00003915");
+		return false;
+	}
+
+	if (image->usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
+	{
+		ReportWarning("Depth/stencil images are not moved by defragmentation. 0x00003918");
+		return false;
+	}
+
+	m_movables[image->allocation] = { nullptr, image };
+	return true;
+}
+
+void VulkanMemoryAllocator::ForgetMovable(VmaAllocation allocation)
+{
+	if (allocation == VK_NULL_HANDLE)
+		return;
+
+	for (const auto& pending : m_pendingMoves)
+	{
+		if (pending.allocation == allocation)
+		{
+			// The resource is mid-move; finish the pass so the caller destroys the new handles.
+			DrainDefragmentationPass();
+			break;
+		}
+	}
+
+	m_movables.erase(allocation);
+}
+
+uint32_t VulkanMemoryAllocator::AddDefragmentationListener(DefragmentationCallback callback)
+{
+	const uint32_t id = m_nextDefragListenerId++;
+	m_defragListeners.emplace_back(id, std::move(callback));
+	return id;
+}
+
+void VulkanMemoryAllocator::RemoveDefragmentationListener(uint32_t id)
+{
+	auto it = std::find_if(m_defragListeners.begin(), m_defragListeners.end(),
+		[id](const auto& listener) { return listener.first == id; });
+
+	if (it != m_defragListeners.end())
+		m_defragListeners.erase(it);
+}
+
+bool VulkanMemoryAllocator::BeginDefragmentation(const DefragmentationConfig& config)
+{
+	if (!IsInitialized())
+	{
+		ReportError("Cannot defragment before initialization. 0x00003920");
+		return false;
+	}
+
+	if (m_defragContext != VK_NULL_HANDLE)
+	{
+		ReportWarning("Defragmentation already running. 0x00003925");
+		return true;
+	}
+
+	// VMA defragments one pool per context, so the pools holding movable resources are
+	// queued and walked one after the other
+	m_defragQueue.clear();
+	if (config.allPools)
+	{
+		for (const auto& [allocation, resource] : m_movables)
+		{
+			const MemoryPoolClass pool = resource.buffer ? resource.buffer->pool : resource.image->pool;
+			if (std::find(m_defragQueue.begin(), m_defragQueue.end(), pool) == m_defragQueue.end())
+				m_defragQueue.push_back(pool);
+		}
+		std::sort(m_defragQueue.begin(), m_defragQueue.end());
+	}
+	else
+	{
+		m_defragQueue.push_back(config.pool);
+	}
+
+	if (m_defragQueue.empty())
+	{
+		ReportWarning("Nothing is registered as movable; defragmentation skipped. 0x00003928");
+		return false;
+	}
+
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	if (vkCreateFence(m_device->GetDevice(), &fenceInfo, nullptr, &m_defragFence) != VK_SUCCESS)
+	{
+		ReportError("Failed to create defragmentation fence. 0x00003930");
+		m_defragQueue.clear();
+		return false;
+	}
+
+	m_defragConfig = config;
+	m_defragStats = {};
+	m_defragPhase = DefragPhase::Idle;
+
+	// Starts the first queued pool that VMA accepts
+	FinishPoolDefragmentation();
+	return IsDefragmenting();
+}
+
+bool VulkanMemoryAllocator::BeginPoolDefragmentation(MemoryPoolClass pool)
+{
+	VmaDefragmentationInfo defragInfo = {};
+	defragInfo.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+	defragInfo.pool = GetPool(pool);
+	defragInfo.maxBytesPerPass = m_defragConfig.maxBytesPerPass;
+	defragInfo.maxAllocationsPerPass = m_defragConfig.maxMovesPerPass;
+
+	if (vmaBeginDefragmentation(m_allocator, &defragInfo, &m_defragContext) != VK_SUCCESS)
+	{
+		m_defragContext = VK_NULL_HANDLE;
+		ReportError(std::string("Failed to begin defragmentation of pool '") + MemoryPoolClassToString(pool) + "'. 0x00003935");
+		return false;
+	}
+
+	m_defragPhase = DefragPhase::Idle;
+	return true;
+}
+
+bool VulkanMemoryAllocator::DefragmentStep(VulkanCommandBuffer* commandBuffer)
+{
+	if (m_defragContext == VK_NULL_HANDLE)
+		return false;
+
+	switch (m_defragPhase)
+	{
+	case DefragPhase::Idle:
+		return BeginDefragmentationPass(commandBuffer);
+
+	case DefragPhase::Copying:
+		if (vkGetFenceStatus(m_device->GetDevice(), m_defragFence) != VK_SUCCESS)
+			return true;
+
+		PatchPendingMoves();
+		return true;
+
+	case DefragPhase::Retiring:
+		if (m_currentFrameIndex < m_defragRetireFrame)
+			return true;
+
+		if (!RetirePendingMoves())
+			FinishPoolDefragmentation();
+
+		return IsDefragmenting();
+	}
+
+	return false;
+}
+
+void VulkanMemoryAllocator::EndDefragmentation()
+{
+	// Aborts the whole run; the pool in progress still finishes its current pass
+	m_defragQueue.clear();
+	FinishPoolDefragmentation();
+}
+
+void VulkanMemoryAllocator::FinishPoolDefragmentation()
+{
+	if (m_defragContext != VK_NULL_HANDLE)
+	{
+		DrainDefragmentationPass();
+
+		VmaDefragmentationStats stats = {};
+		vmaEndDefragmentation(m_allocator, m_defragContext, &stats);
+		m_defragContext = VK_NULL_HANDLE;
+
+		m_defragStats.bytesMoved += stats.bytesMoved;
+		m_defragStats.bytesFreed += stats.bytesFreed;
+		m_defragStats.allocationsMoved += stats.allocationsMoved;
+		m_defragStats.deviceMemoryBlocksFreed += stats.deviceMemoryBlocksFreed;
+	}
+
+	while (!m_defragQueue.empty())
+	{
+		const MemoryPoolClass next = m_defragQueue.front();
+		m_defragQueue.erase(m_defragQueue.begin());
+		if (BeginPoolDefragmentation(next))
+			return;
+	}
+
+	if (m_defragFence == VK_NULL_HANDLE)
+		return;
+
+	vkDestroyFence(m_device->GetDevice(), m_defragFence, nullptr);
+	m_defragFence = VK_NULL_HANDLE;
+
+	DebugOut.outputDebug("VulkanMemoryAllocator: Defragmentation finished. Moved " +
+		std::to_string(m_defragStats.allocationsMoved) + " allocations (" +
+		std::to_string(m_defragStats.bytesMoved) + " bytes), reclaimed " +
+		std::to_string(m_defragStats.bytesFreed) + " bytes in " +
+		std::to_string(m_defragStats.deviceMemoryBlocksFreed) + " blocks over " +
+		std::to_string(m_defragStats.passCount) + " passes.");
+}
+
+bool VulkanMemoryAllocator::BeginDefragmentationPass(VulkanCommandBuffer* commandBuffer)
+{
+	if (!commandBuffer || !commandBuffer->IsInitialized())
+	{
+		ReportError("Invalid command buffer system for defragmentation. 0x00003940");
+		return false;
+	}
+
+	m_defragPass = {};
+	VkResult result = vmaBeginDefragmentationPass(m_allocator, m_defragContext, &m_defragPass);
+
+	if (result == VK_SUCCESS)
+	{
+		// Nothing left to move in this pool
+		FinishPoolDefragmentation();
+		return IsDefragmenting();
+	}
+
+	if (result != VK_INCOMPLETE)
+	{
+		ReportError("Failed to begin defragmentation pass. 0x00003945");
+		EndDefragmentation();
+		return false;
+	}
+
+	VkCommandBuffer cmd = commandBuffer->AllocateCommandBuffer();
+	bool recording = cmd != VK_NULL_HANDLE &&
+		commandBuffer->BeginRecording(cmd, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	for (uint32_t i = 0; i < m_defragPass.moveCount; ++i)
+	{
+		VmaDefragmentationMove& move = m_defragPass.pMoves[i];
+
+		if (!recording)
+		{
+			move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+			continue;
+		}
+
+		PendingMove pending;
+		if (PrepareMove(move, cmd, pending))
+			m_pendingMoves.push_back(pending);
+	}
+
+	if (recording)
+		commandBuffer->EndRecording(cmd);
+
+	if (m_pendingMoves.empty())
+	{
+		if (cmd != VK_NULL_HANDLE)
+			commandBuffer->FreeCommandBuffer(cmd);
+
+		result = vmaEndDefragmentationPass(m_allocator, m_defragContext, &m_defragPass);
+		m_defragPass = {};
+		++m_defragStats.passCount;
+
+		if (result == VK_SUCCESS)
+			FinishPoolDefragmentation();
+
+		return IsDefragmenting();
+	}
+
+	vkResetFences(m_device->GetDevice(), 1, &m_defragFence);
+
+	if (!commandBuffer->Submit(cmd, m_device->GetGraphicsQueue(), {}, {}, {}, m_defragFence))
+	{
+		ReportError("Failed to submit defragmentation copies. 0x00003950");
+		m_device->WaitIdle();
+
+		for (auto& pending : m_pendingMoves)
+		{
+			if (pending.newBuffer != VK_NULL_HANDLE)
+				vkDestroyBuffer(m_device->GetDevice(), pending.newBuffer, nullptr);
+			if (pending.newImage != VK_NULL_HANDLE)
+				vkDestroyImage(m_device->GetDevice(), pending.newImage, nullptr);
+		}
+
+		for (uint32_t i = 0; i < m_defragPass.moveCount; ++i)
+			m_defragPass.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+
+		m_pendingMoves.clear();
+		commandBuffer->FreeCommandBuffer(cmd);
+		vmaEndDefragmentationPass(m_allocator, m_defragContext, &m_defragPass);
+		m_defragPass = {};
+		EndDefragmentation();
+		return false;
+	}
+
+	m_defragCommands = commandBuffer;
+	m_defragCmd = cmd;
+	m_defragPhase = DefragPhase::Copying;
+
+	return true;
+}
+
+bool VulkanMemoryAllocator::PrepareMove(VmaDefragmentationMove& move, VkCommandBuffer cmd, PendingMove& outPending)
+{
+	auto it = m_movables.find(move.srcAllocation);
+
+	if (it == m_movables.end())
+	{
+		move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+		return false;
+	}
+
+	VkDevice device = m_device->GetDevice();
+	outPending.allocation = move.srcAllocation;
+	outPending.resource = it->second;
+
+	if (AllocatedBuffer* buffer = it->second.buffer)
+	{
+		VkBufferCreateInfo bufferInfo = {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = buffer->size;
+		bufferInfo.usage = buffer->usage;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if (vkCreateBuffer(device, &bufferInfo, nullptr, &outPending.newBuffer) != VK_SUCCESS)
+		{
+			move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+			return false;
+		}
+
+		if (vmaBindBufferMemory(m_allocator, move.dstTmpAllocation, outPending.newBuffer) != VK_SUCCESS)
+		{
+			vkDestroyBuffer(device, outPending.newBuffer, nullptr);
+			move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+			return false;
+		}
+
+		VkBufferCopy copy = {};
+		copy.size = buffer->size;
+		vkCmdCopyBuffer(cmd, buffer->buffer, outPending.newBuffer, 1, &copy);
+
+		outPending.oldBuffer = buffer->buffer;
+		return true;
+	}
+
+	AllocatedImage* image = it->second.image;
+
+	if (!image || image->currentLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+	{
+		// Nothing meaningful to copy yet
+		move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+		return false;
+	}
+
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = image->extent.depth > 1 ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
+	imageInfo.extent = image->extent;
+	imageInfo.mipLevels = image->mipLevels;
+	imageInfo.arrayLayers = image->arrayLayers;
+	imageInfo.format = image->format;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = image->usage;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateImage(device, &imageInfo, nullptr, &outPending.newImage) != VK_SUCCESS)
+	{
+		move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+		return false;
+	}
+
+	if (vmaBindImageMemory(m_allocator, move.dstTmpAllocation, outPending.newImage) != VK_SUCCESS)
+	{
+		vkDestroyImage(device, outPending.newImage, nullptr);
+		move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+		return false;
+	}
+
+	RecordImageCopy(cmd, *image, outPending.newImage);
+
+	outPending.oldImage = image->image;
+	return true;
+}
+
+void VulkanMemoryAllocator::RecordImageCopy(VkCommandBuffer cmd, const AllocatedImage& image, VkImage newImage) const
+{
+	VkImageSubresourceRange range = {};
+	range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	range.baseMipLevel = 0;
+	range.levelCount = image.mipLevels;
+	range.baseArrayLayer = 0;
+	range.layerCount = image.arrayLayers;
+
+	VkImageMemoryBarrier barriers[2] = {};
+	for (auto& barrier : barriers)
+	{
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.subresourceRange = range;
+	}
+
+	barriers[0].image = image.image;
+	barriers[0].oldLayout = image.currentLayout;
+	barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barriers[0].srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+	barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	barriers[1].image = newImage;
+	barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barriers[1].srcAccessMask = 0;
+	barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 0, nullptr, 0, nullptr, 2, barriers);
+
+	std::vector<VkImageCopy> regions(image.mipLevels);
+	for (uint32_t mip = 0; mip < image.mipLevels; ++mip)
+	{
+		VkImageCopy& region = regions[mip];
+		region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, image.arrayLayers };
+		region.dstSubresource = region.srcSubresource;
+		region.extent.width = std::max(1u, image.extent.width >> mip);
+		region.extent.height = std::max(1u, image.extent.height >> mip);
+		region.extent.depth = std::max(1u, image.extent.depth >> mip);
+	}
+
+	vkCmdCopyImage(cmd,
+		image.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		newImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		static_cast<uint32_t>(regions.size()), regions.data());
+
+	barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barriers[0].newLayout = image.currentLayout;
+	barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barriers[0].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+	barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barriers[1].newLayout = image.currentLayout;
+	barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barriers[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		0, 0, nullptr, 0, nullptr, 2, barriers);
+}
+
+void VulkanMemoryAllocator::PatchPendingMoves()
+{
+	if (m_defragCommands && m_defragCmd != VK_NULL_HANDLE)
+		m_defragCommands->FreeCommandBuffer(m_defragCmd);
+
+	m_defragCmd = VK_NULL_HANDLE;
+	m_defragCommands = nullptr;
+
+	bool movedImage = false;
+	for (const auto& pending : m_pendingMoves)
+		movedImage |= pending.newImage != VK_NULL_HANDLE;
+
+	// Listeners rewrite descriptor sets for moved images, which must not be in use.
+	if (movedImage)
+		m_device->WaitIdle();
+
+	for (auto& pending : m_pendingMoves)
+	{
+		DefragmentationMove notice;
+
+		if (pending.resource.buffer)
+		{
+			pending.resource.buffer->buffer = pending.newBuffer;
+			if (pending.resource.buffer->deviceAddress != 0)
+				pending.resource.buffer->deviceAddress = GetBufferAddress(pending.newBuffer);
+			notice.buffer = pending.resource.buffer;
+			notice.oldBuffer = pending.oldBuffer;
+		}
+		else if (pending.resource.image)
+		{
+			pending.resource.image->image = pending.newImage;
+			notice.image = pending.resource.image;
+			notice.oldImage = pending.oldImage;
+		}
+
+		for (const auto& listener : m_defragListeners)
+			listener.second(notice);
+	}
+
+	// Frames recorded before the patch may still read the old handles.
+	m_defragRetireFrame = m_currentFrameIndex + m_defragConfig.framesInFlight;
+	m_defragPhase = DefragPhase::Retiring;
+}
+
+bool VulkanMemoryAllocator::RetirePendingMoves()
+{
+	VkDevice device = m_device->GetDevice();
+
+	for (const auto& pending : m_pendingMoves)
+	{
+		if (pending.oldBuffer != VK_NULL_HANDLE)
+			vkDestroyBuffer(device, pending.oldBuffer, nullptr);
+		if (pending.oldImage != VK_NULL_HANDLE)
+			vkDestroyImage(device, pending.oldImage, nullptr);
+	}
+
+	VkResult result = vmaEndDefragmentationPass(m_allocator, m_defragContext, &m_defragPass);
+	m_defragPass = {};
+	++m_defragStats.passCount;
+
+	// The VmaAllocation now refers to the new place; refresh cached info.
+	for (const auto& pending : m_pendingMoves)
+	{
+		if (pending.resource.buffer)
+			vmaGetAllocationInfo(m_allocator, pending.allocation, &pending.resource.buffer->allocationInfo);
+		else if (pending.resource.image)
+			vmaGetAllocationInfo(m_allocator, pending.allocation, &pending.resource.image->allocationInfo);
+	}
+
+	m_pendingMoves.clear();
+	m_defragPhase = DefragPhase::Idle;
+
+	return result == VK_INCOMPLETE;
+}
+
+void VulkanMemoryAllocator::DrainDefragmentationPass()
+{
+	if (m_defragPhase == DefragPhase::Idle)
+		return;
+
+	m_device->WaitIdle();
+
+	if (m_defragPhase == DefragPhase::Copying)
+		PatchPendingMoves();
+
+	RetirePendingMoves();
+}
+
+void VulkanMemoryAllocator::SetFramesInFlight(uint32_t count)
+{
+	if (count == 0)
+	{
+		ReportWarning("Frames in flight must be at least 1. 0x00003A00");
+		count = 1;
+	}
+
+	m_framesInFlight = count;
+}
+
+void VulkanMemoryAllocator::DeferDestruction(std::function<void()> deleter)
+{
+	if (!IsInitialized())
+	{
+		// Nothing can be in flight without an allocator
+		if (deleter)
+			deleter();
+		return;
+	}
+
+	if (m_timeline && m_timeline->IsTimelineEnabled())
+	{
+		// The value is unknown until the frame that may still use this is submitted
+		std::lock_guard<std::mutex> lock(m_unsubmittedMutex);
+		m_unsubmittedDeletions.push_back(std::move(deleter));
+		return;
+	}
+
+	m_deletionQueue.Push(m_currentFrameIndex, std::move(deleter));
+}
+
+void VulkanMemoryAllocator::SetTimeline(std::shared_ptr<VulkanSynchronization> sync)
+{
+	m_timeline = sync;
+}
+
+void VulkanMemoryAllocator::SubmitFrame(uint64_t signalValue)
+{
+	std::vector<std::function<void()>> released;
+	{
+		std::lock_guard<std::mutex> lock(m_unsubmittedMutex);
+		released.swap(m_unsubmittedDeletions);
+	}
+
+	for (auto& deleter : released)
+		m_deletionQueue.Push(signalValue, std::move(deleter));
+}
+
+void VulkanMemoryAllocator::CollectGarbage(uint64_t completedValue)
+{
+	m_deletionQueue.Collect(completedValue);
+}
+
+size_t VulkanMemoryAllocator::GetPendingDeletionCount() const
+{
+	std::lock_guard<std::mutex> lock(m_unsubmittedMutex);
+	return m_deletionQueue.GetPendingCount() + m_unsubmittedDeletions.size();
+}
+
+void VulkanMemoryAllocator::FlushDeletionQueue()
+{
+	std::vector<std::function<void()>> unsubmitted;
+	{
+		std::lock_guard<std::mutex> lock(m_unsubmittedMutex);
+		unsubmitted.swap(m_unsubmittedDeletions);
+	}
+
+	if (m_deletionQueue.IsEmpty() && unsubmitted.empty())
+		return;
+
+	if (m_device)
+		m_device->WaitIdle();
+
+	m_deletionQueue.Flush();
+
+	for (auto& deleter : unsubmitted)
+	{
+		if (deleter)
+			deleter();
+	}
+}
+
+bool VulkanMemoryAllocator::FindPoolMemoryType(MemoryPoolClass pool, uint32_t& outTypeIndex) const
+{
+	VmaAllocationCreateInfo allocInfo = {};
+	VkResult result = VK_ERROR_FEATURE_NOT_PRESENT;
+
+	// Representative resources; on desktop drivers every optimal-tiling image and
+	// every device-local buffer of a class lands in the same memory type.
+	if (pool == MemoryPoolClass::RenderTargets || pool == MemoryPoolClass::StreamingTextures)
+	{
+		VkImageCreateInfo imageInfo = {};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent = { 1024, 1024, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if (pool == MemoryPoolClass::RenderTargets)
+		{
+			imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+			imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		}
+		else
+		{
+			imageInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+			imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		}
+
+		allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+		allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		result = vmaFindMemoryTypeIndexForImageInfo(m_allocator, &imageInfo, &allocInfo, &outTypeIndex);
+	}
+	else
+	{
+		VkBufferCreateInfo bufferInfo = {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = 64 * 1024;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		MemoryAllocationInfo memInfo;
+		if (pool == MemoryPoolClass::StaticGeometry)
+		{
+			bufferInfo.usage = GeometryUsage(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+			memInfo = MemoryAllocationInfo::StaticGeometry();
+		}
+		else
+		{
+			bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			memInfo = MemoryAllocationInfo::Staging();
+		}
+
+		allocInfo.usage = memInfo.usage;
+		allocInfo.flags = memInfo.flags;
+		allocInfo.requiredFlags = memInfo.requiredFlags;
+		allocInfo.preferredFlags = memInfo.preferredFlags;
+		result = vmaFindMemoryTypeIndexForBufferInfo(m_allocator, &bufferInfo, &allocInfo, &outTypeIndex);
+	}
+
+	return result == VK_SUCCESS;
+}
+
+bool VulkanMemoryAllocator::CreatePool(MemoryPoolClass pool, const MemoryPoolConfig& config)
+{
+	const size_t index = static_cast<size_t>(pool);
+
+	if (pool == MemoryPoolClass::Default || index >= m_pools.size())
+	{
+		ReportError("Cannot create a pool for the default class. 0x00003B00");
+		return false;
+	}
+
+	uint32_t memoryTypeIndex = 0;
+	if (!FindPoolMemoryType(pool, memoryTypeIndex))
+	{
+		ReportError(std::string("No memory type for pool '") + MemoryPoolClassToString(pool) + "'. 0x00003B10");
+		return false;
+	}
+
+	VmaPoolCreateInfo poolInfo = {};
+	poolInfo.memoryTypeIndex = memoryTypeIndex;
+	poolInfo.blockSize = config.blockSize;
+	poolInfo.minBlockCount = config.minBlockCount;
+	poolInfo.maxBlockCount = config.maxBlockCount;
+	poolInfo.priority = config.priority;
+
+	VmaPool vmaPool = VK_NULL_HANDLE;
+	if (vmaCreatePool(m_allocator, &poolInfo, &vmaPool) != VK_SUCCESS)
+	{
+		ReportError(std::string("Failed to create pool '") + MemoryPoolClassToString(pool) + "'. 0x00003B20");
+		return false;
+	}
+
+	vmaSetPoolName(m_allocator, vmaPool, MemoryPoolClassToString(pool));
+
+	m_pools[index] = vmaPool;
+	m_poolConfigs[index] = config;
+	m_poolMemoryTypes[index] = memoryTypeIndex;
+	return true;
+}
+
+bool VulkanMemoryAllocator::ConfigurePool(MemoryPoolClass pool, const MemoryPoolConfig& config)
+{
+	if (!IsInitialized())
+	{
+		ReportError("Cannot configure pools before initialization. 0x00003B30");
+		return false;
+	}
+
+	const size_t index = static_cast<size_t>(pool);
+	if (pool == MemoryPoolClass::Default || index >= m_pools.size())
+	{
+		ReportError("Cannot configure the default pool. 0x00003B35");
+		return false;
+	}
+
+	if (m_pools[index] != VK_NULL_HANDLE)
+	{
+		if (GetPoolStatistics(pool).allocationCount > 0)
+		{
+			ReportError(std::string("Pool '") + MemoryPoolClassToString(pool) + "' still has allocations. 0x00003B40");
+			return false;
+		}
+
+		vmaDestroyPool(m_allocator, m_pools[index]);
+		m_pools[index] = VK_NULL_HANDLE;
+	}
+
+	return CreatePool(pool, config);
+}
+
+void VulkanMemoryAllocator::DestroyPools()
+{
+	for (auto& pool : m_pools)
+	{
+		if (pool != VK_NULL_HANDLE)
+		{
+			vmaDestroyPool(m_allocator, pool);
+			pool = VK_NULL_HANDLE;
+		}
+	}
+}
+
+VmaPool VulkanMemoryAllocator::GetPool(MemoryPoolClass pool) const
+{
+	const size_t index = static_cast<size_t>(pool);
+	return index < m_pools.size() ? m_pools[index] : VK_NULL_HANDLE;
+}
+
+MemoryPoolStatistics VulkanMemoryAllocator::GetPoolStatistics(MemoryPoolClass pool) const
+{
+	MemoryPoolStatistics stats;
+	VmaPool vmaPool = GetPool(pool);
+
+	if (!IsInitialized() || vmaPool == VK_NULL_HANDLE)
+		return stats;
+
+	VmaStatistics vmaStats = {};
+	vmaGetPoolStatistics(m_allocator, vmaPool, &vmaStats);
+
+	const MemoryPoolConfig& config = GetPoolConfig(pool);
+	stats.blockBytes = vmaStats.blockBytes;
+	stats.allocationBytes = vmaStats.allocationBytes;
+	stats.blockCount = vmaStats.blockCount;
+	stats.allocationCount = vmaStats.allocationCount;
+	stats.budgetBytes = config.GetBudget();
+	stats.memoryTypeIndex = m_poolMemoryTypes[static_cast<size_t>(pool)];
+	stats.active = true;
+
+	return stats;
+}
+
+void VulkanMemoryAllocator::DetectHostVisibleDeviceLocal()
+{
+	const VkPhysicalDeviceMemoryProperties* memProps = nullptr;
+	vmaGetMemoryProperties(m_allocator, &memProps);
+
+	const VkMemoryPropertyFlags wanted = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+	m_hostVisibleDeviceLocalBytes = 0;
+
+	for (uint32_t type = 0; type < memProps->memoryTypeCount; ++type)
+	{
+		if ((memProps->memoryTypes[type].propertyFlags & wanted) != wanted)
+			continue;
+
+		const VkDeviceSize heapSize = memProps->memoryHeaps[memProps->memoryTypes[type].heapIndex].size;
+		m_hostVisibleDeviceLocalBytes = std::max(m_hostVisibleDeviceLocalBytes, heapSize);
+	}
+
+	if (m_hostVisibleDeviceLocalBytes > 0)
+	{
+		const bool resizableBar = m_hostVisibleDeviceLocalBytes > 256ull * 1024 * 1024;
+		DebugOut.outputDebug("VulkanMemoryAllocator: Host-visible device-local heap of " +
+			std::to_string(m_hostVisibleDeviceLocalBytes / (1024 * 1024)) + " MB" +
+			(resizableBar ? " (ReBAR)" : " (BAR)") + ", dynamic buffers are written directly.");
+	}
+}
+
+bool VulkanMemoryAllocator::IsHostWritable(const AllocatedBuffer& buffer) const
+{
+	if (!buffer.IsValid())
+		return false;
+
+	VkMemoryPropertyFlags flags = 0;
+	vmaGetAllocationMemoryProperties(m_allocator, buffer.allocation, &flags);
+
+	return (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+}
+
+VkDeviceAddress VulkanMemoryAllocator::GetBufferAddress(VkBuffer buffer) const
+{
+	if (!m_bufferDeviceAddress || buffer == VK_NULL_HANDLE)
+		return 0;
+
+	VkBufferDeviceAddressInfo addressInfo = {};
+	addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+	addressInfo.buffer = buffer;
+
+	return vkGetBufferDeviceAddress(m_device->GetDevice(), &addressInfo);
+}
+
+VkBufferUsageFlags VulkanMemoryAllocator::GeometryUsage(VkBufferUsageFlags usage) const
+{
+	return m_bufferDeviceAddress ? (usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) : usage;
+}
+
+bool VulkanMemoryAllocator::CreateDynamicBuffer(size_t size, VkBufferUsageFlags usage, AllocatedBuffer& outBuffer)
+{
+	if (!size)
+	{
+		ReportError("Cannot create dynamic buffer with size 0. 0x00003C00");
+		return false;
+	}
+
+	if (!CreateBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryAllocationInfo::DirectWrite(), outBuffer))
+	{
+		ReportError("Failed to create dynamic buffer. 0x00003C10");
+		return false;
+	}
+
+	// VMA only hands out non-mappable VRAM here when that is the better choice
+	if (IsHostWritable(outBuffer))
+	{
+		if (!MapMemory(outBuffer))
+		{
+			DestroyBuffer(outBuffer);
+			ReportError("Failed to map dynamic buffer. 0x00003C20");
+			return false;
+		}
+		outBuffer.isPersistentlyMapped = true;
+	}
+
+	return true;
+}
+
+bool VulkanMemoryAllocator::UploadToBuffer(
+	VulkanCommandBuffer* commandBuffer,
+	AllocatedBuffer& buffer,
+	const void* data,
+	size_t size,
+	size_t offset)
+{
+	if (!buffer.IsValid())
+	{
+		ReportError("Cannot upload to invalid buffer. 0x00003C30");
+		return false;
+	}
+
+	if (size == 0)
+		return true;
+
+	if (!data)
+	{
+		ReportError("Cannot upload from null data. 0x00003C32");
+		return false;
+	}
+
+	if (offset + size > buffer.size)
+	{
+		ReportError("Upload would exceed buffer size. 0x00003C35");
+		return false;
+	}
+
+	if (IsHostWritable(buffer))
+	{
+		if (!UploadDataToBuffer(buffer, data, size, offset))
+			return false;
+
+		m_directUploads.fetch_add(1, std::memory_order_relaxed);
+		m_directUploadBytes.fetch_add(size, std::memory_order_relaxed);
+		return true;
+	}
+
+	if (!commandBuffer || !commandBuffer->IsInitialized())
+	{
+		ReportError("Buffer is not host-visible and no command buffer was given. 0x00003C40");
+		return false;
+	}
+
+	if (!(buffer.usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT))
+	{
+		ReportError("Buffer is not host-visible and lacks TRANSFER_DST usage. 0x00003C45");
+		return false;
+	}
+
+	AllocatedBuffer stagingBuffer;
+	if (!CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryAllocationInfo::Staging(), stagingBuffer))
+	{
+		ReportError("Failed to create upload staging buffer. 0x00003C50");
+		return false;
+	}
+
+	if (!UploadDataToBuffer(stagingBuffer, data, size))
+	{
+		DestroyBuffer(stagingBuffer);
+		return false;
+	}
+
+	VkCommandBuffer cmd = commandBuffer->BeginSingleTimeCommands();
+	CopyBuffer(cmd, stagingBuffer, buffer, size, 0, offset);
+	commandBuffer->EndSingleTimeCommands(cmd);
+
+	DestroyBuffer(stagingBuffer);
+
+	m_stagedUploads.fetch_add(1, std::memory_order_relaxed);
+	m_stagedUploadBytes.fetch_add(size, std::memory_order_relaxed);
+	return true;
+}
@@ -5,15 +5,108 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <mutex>
 #include "../VulkanCommandBuffer/VulkanCommandBuffer.h"
 #include "../VulkanInstance/VulkanInstance.h"
 #include "../VulkanDevice/VulkanDevice.h"
+#include "../VulkanDeletionQueue/VulkanDeletionQueue.h"
 #include "../../DebugOutput/DubugOutput.h"
 
 // Forward declarations
 struct VkCommandBuffer_T;
 typedef struct VkCommandBuffer_T* VkCommandBuffer;
 
+// Tags
+enum class MemoryUsageTag : uint32_t
+{
+    Vertex,
+    Index,
+    Texture,
+    Staging,
+    Uniform,
+    RenderTarget,
+    Other,
+    Count
+};
+
+const char* MemoryUsageTagToString(MemoryUsageTag tag);
+
+// Pools
+// Each class gets its own VmaPool so churn in one cannot fragment another.
+enum class MemoryPoolClass : uint32_t
+{
+    Default, // VMA default heaps
+    RenderTargets,
+    StreamingTextures,
+    StaticGeometry,
+    Staging,
+    Count
+};
+
+const char* MemoryPoolClassToString(MemoryPoolClass pool);
+
+struct MemoryPoolConfig
+{
+    VkDeviceSize blockSize = 0;  // 0 = VMA default
+    size_t minBlockCount = 0;
+    size_t maxBlockCount = 0;    // 0 = unlimited, otherwise budget = blockSize * maxBlockCount
+    float priority = 0.5f;
+    bool allowOverflow = true;   // Fall back to the default heaps when the pool is full
+
+    VkDeviceSize GetBudget() const { return blockSize * maxBlockCount; }
+
+    static MemoryPoolConfig RenderTargets()
+    {
+        MemoryPoolConfig config;
+        config.blockSize = 128ull * 1024 * 1024;
+        config.priority = 1.0f;
+        return config;
+    }
+
+    static MemoryPoolConfig StreamingTextures()
+    {
+        MemoryPoolConfig config;
+        config.blockSize = 64ull * 1024 * 1024;
+        config.maxBlockCount = 16;
+        // Nothing evicts yet, so textures past the budget spill into the default heaps
+        config.allowOverflow = true;
+        return config;
+    }
+
+    static MemoryPoolConfig StaticGeometry()
+    {
+        MemoryPoolConfig config;
+        config.blockSize = 64ull * 1024 * 1024;
+        config.priority = 0.75f;
+        return config;
+    }
+
+    static MemoryPoolConfig Staging()
+    {
+        MemoryPoolConfig config;
+        config.blockSize = 32ull * 1024 * 1024;
+        config.maxBlockCount = 8;
+        config.priority = 0.0f;
+        return config;
+    }
+
+    static MemoryPoolConfig For(MemoryPoolClass pool)
+    {
+        switch (pool)
+        {
+        case MemoryPoolClass::RenderTargets:     return RenderTargets();
+        case MemoryPoolClass::StreamingTextures: return StreamingTextures();
+        case MemoryPoolClass::StaticGeometry:    return StaticGeometry();
+        case MemoryPoolClass::Staging:           return Staging();
+        default:                                 return MemoryPoolConfig{};
+        }
+    }
+};
+
 // Config
 struct MemoryAllocationInfo
 {
@@ -22,6 +115,8 @@ struct MemoryAllocationInfo
     VkMemoryPropertyFlags requiredFlags = 0;
     VkMemoryPropertyFlags preferredFlags = 0;
     float priority = 0.5f;
+    MemoryUsageTag tag = MemoryUsageTag::Other; // Other = infer from buffer usage
+    MemoryPoolClass pool = MemoryPoolClass::Default;
 
     static MemoryAllocationInfo DeviceLocal()
     {
@@ -31,6 +126,13 @@ struct MemoryAllocationInfo
         return info;
     }
 
+    static MemoryAllocationInfo StaticGeometry()
+    {
+        MemoryAllocationInfo info = DeviceLocal();
+        info.pool = MemoryPoolClass::StaticGeometry;
+        return info;
+    }
+
     static MemoryAllocationInfo HostVisible()
     {
         MemoryAllocationInfo info;
@@ -39,6 +141,25 @@ struct MemoryAllocationInfo
         return info;
     }
 
+    // Host-writable memory, VRAM when the device exposes it (BAR/ReBAR), system RAM otherwise
+    static MemoryAllocationInfo HostVisiblePreferDevice()
+    {
+        MemoryAllocationInfo info;
+        info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+        info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+        return info;
+    }
+
+    // VRAM that is written directly when host-visible, or through a transfer when not
+    static MemoryAllocationInfo DirectWrite()
+    {
+        MemoryAllocationInfo info;
+        info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+        info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT;
+        return info;
+    }
+
     static MemoryAllocationInfo Readback()
     {
         MemoryAllocationInfo info;
@@ -54,6 +175,8 @@ struct MemoryAllocationInfo
         info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
         info.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
         info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+        info.tag = MemoryUsageTag::Staging;
+        info.pool = MemoryPoolClass::Staging;
         return info;
     }
 };
@@ -69,6 +192,9 @@ struct AllocatedBuffer
     bool isPersistentlyMapped = false;
     void* mappedData = nullptr;
     VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    MemoryUsageTag tag = MemoryUsageTag::Other;
+    MemoryPoolClass pool = MemoryPoolClass::Default;
+    VkDeviceAddress deviceAddress = 0; // Set when usage has SHADER_DEVICE_ADDRESS; refreshed on defrag moves
 
     bool IsValid() const { return buffer != VK_NULL_HANDLE && allocation != VK_NULL_HANDLE; }
 };
@@ -83,12 +209,40 @@ struct AllocatedImage
     uint32_t mipLevels = 1;
     uint32_t arrayLayers = 1;
     VkImageLayout currentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageUsageFlags usage = 0;
+    MemoryUsageTag tag = MemoryUsageTag::Texture;
+    MemoryPoolClass pool = MemoryPoolClass::Default;
 
     bool IsValid() const {
         return image != VK_NULL_HANDLE && allocation != VK_NULL_HANDLE;
     }
 };
 // Stats
+struct MemoryTagStatistics
+{
+    size_t bytes = 0;
+    uint32_t allocationCount = 0;
+};
+
+struct UploadStatistics
+{
+    uint64_t directUploads = 0;
+    uint64_t stagedUploads = 0;
+    uint64_t directBytes = 0;
+    uint64_t stagedBytes = 0;
+};
+
+struct MemoryPoolStatistics
+{
+    VkDeviceSize blockBytes = 0;
+    VkDeviceSize allocationBytes = 0;
+    uint32_t blockCount = 0;
+    uint32_t allocationCount = 0;
+    VkDeviceSize budgetBytes = 0; // 0 = unlimited
+    uint32_t memoryTypeIndex = 0;
+    bool active = false;
+};
+
 struct MemoryStatistics
 {
     size_t totalAllocatedBytes = 0;
@@ -97,12 +251,55 @@ struct MemoryStatistics
     uint32_t unusedRangeCount = 0;
 
     std::vector<VmaBudget> heapBudgets;
+    std::vector<VkMemoryHeapFlags> heapFlags;
 
     size_t deviceLocalBytes = 0;
     size_t hostVisibleBytes = 0;
     size_t stagingBytes = 0;
+    VkDeviceSize hostVisibleDeviceLocalHeapBytes = 0; // 0 = no BAR, > 256 MB = ReBAR
+    UploadStatistics uploads;
+
+    std::array<MemoryTagStatistics, static_cast<size_t>(MemoryUsageTag::Count)> tags = {};
+    std::array<MemoryPoolStatistics, static_cast<size_t>(MemoryPoolClass::Count)> pools = {};
+
+    uint32_t frameIndex = 0;
+    bool detailed = false; // true when unusedRangeCount came from vmaCalculateStatistics
+
+    const MemoryTagStatistics& GetTag(MemoryUsageTag tag) const { return tags[static_cast<size_t>(tag)]; }
+    const MemoryPoolStatistics& GetPool(MemoryPoolClass pool) const { return pools[static_cast<size_t>(pool)]; }
 };
 
+// Defragmentation
+struct DefragmentationConfig
+{
+    uint32_t maxMovesPerPass = 16;
+    VkDeviceSize maxBytesPerPass = 32ull * 1024 * 1024;
+    uint32_t framesInFlight = 3; // Old handles are kept alive this many frames after a move
+    MemoryPoolClass pool = MemoryPoolClass::Default; // Used when allPools is false
+    bool allPools = true; // One VMA context per pool holding movable resources, in turn
+};
+
+struct DefragmentationStats
+{
+    VkDeviceSize bytesMoved = 0;
+    VkDeviceSize bytesFreed = 0;
+    uint32_t allocationsMoved = 0;
+    uint32_t deviceMemoryBlocksFreed = 0;
+    uint32_t passCount = 0;
+};
+
+// Handed to listeners after a registered resource got new handles.
+// Exactly one of buffer/image is set and already points at the new location.
+struct DefragmentationMove
+{
+    AllocatedBuffer* buffer = nullptr;
+    AllocatedImage* image = nullptr;
+    VkBuffer oldBuffer = VK_NULL_HANDLE;
+    VkImage oldImage = VK_NULL_HANDLE;
+};
+
+using DefragmentationCallback = std::function<void(const DefragmentationMove&)>;
+
 class VulkanMemoryAllocator
 {
 public:
@@ -126,6 +323,7 @@ public:
     bool CreateBuffer(size_t size, VkBufferUsageFlags usage,
         const MemoryAllocationInfo& memInfo, AllocatedBuffer& outBuffer);
     void DestroyBuffer(AllocatedBuffer& buffer);
+    void DeferDestroyBuffer(AllocatedBuffer& buffer); // Destroyed once the GPU finished the current frame
 
     // Mapping
     bool MapMemory(AllocatedBuffer& buffer);
@@ -147,11 +345,76 @@ public:
         AllocatedBuffer& outBuffer);
     bool CreateUniformBuffer(size_t size, AllocatedBuffer& outBuffer, bool persistentlyMapped = true);
 
+    // Dynamic buffers
+    // Placed in VRAM; written with memcpy when the memory is host-visible (BAR/ReBAR),
+    // otherwise UploadToBuffer stages the copy. Usage gets TRANSFER_DST for that fallback.
+    // The staged path waits on the queue, so buffers rewritten every frame belong in
+    // CreateUniformBuffer, which is always host-visible.
+    bool CreateDynamicBuffer(size_t size, VkBufferUsageFlags usage, AllocatedBuffer& outBuffer);
+    bool IsHostWritable(const AllocatedBuffer& buffer) const;
+    bool HasHostVisibleDeviceLocal() const { return m_hostVisibleDeviceLocalBytes > 0; }
+
+    // Device addresses
+    // Enabled when the device exposes bufferDeviceAddress. Vertex and index buffers then
+    // also get SHADER_DEVICE_ADDRESS usage so shaders can pull them through buffer references.
+    bool IsBufferDeviceAddressEnabled() const { return m_bufferDeviceAddress; }
+    VkDeviceAddress GetBufferAddress(VkBuffer buffer) const;
+
     // Transfers
     bool UploadDataToBuffer(AllocatedBuffer& buffer, const void* data, size_t size, size_t offset = 0);
+    bool UploadToBuffer(VulkanCommandBuffer* commandBuffer, AllocatedBuffer& buffer,
+        const void* data, size_t size, size_t offset = 0);
     bool CopyBuffer(VkCommandBuffer commandBuffer, const AllocatedBuffer& src,
         AllocatedBuffer& dst, size_t size, size_t srcOffset = 0, size_t dstOffset = 0);
 
+    // Stats
+    // BeginFrame is cheap (vmaGetHeapBudgets only) and meant to run once per frame.
+    // GetStatistics(true) additionally walks every block via vmaCalculateStatistics.
+    void BeginFrame(uint32_t frameIndex);
+    MemoryStatistics GetStatistics(bool detailed = false) const;
+    std::string GetStatisticsJson(bool detailed = false) const;
+    bool ExportStatisticsJson(const std::string& filepath, bool detailed = true) const;
+
+    void TrackAllocation(MemoryUsageTag tag, VkDeviceSize size);
+    void UntrackAllocation(MemoryUsageTag tag, VkDeviceSize size);
+
+    // Pools
+    // Initialize creates every class with MemoryPoolConfig::For(). ConfigurePool
+    // replaces a pool and fails while it still holds allocations.
+    bool ConfigurePool(MemoryPoolClass pool, const MemoryPoolConfig& config);
+    VmaPool GetPool(MemoryPoolClass pool) const;
+    const MemoryPoolConfig& GetPoolConfig(MemoryPoolClass pool) const { return m_poolConfigs[static_cast<size_t>(pool)]; }
+    MemoryPoolStatistics GetPoolStatistics(MemoryPoolClass pool) const;
+
+    // Deferred destruction
+    // Work released during frame N runs in BeginFrame(N + framesInFlight), after that frame's fence.
+    // With a timeline attached, releases wait for the value passed to the next SubmitFrame and
+    // BeginFrame collects against the semaphore's completed value instead of counting frames.
+    void SetFramesInFlight(uint32_t count);
+    uint32_t GetFramesInFlight() const { return m_framesInFlight; }
+    void SetTimeline(std::shared_ptr<VulkanSynchronization> sync);
+    void SubmitFrame(uint64_t signalValue);
+    void DeferDestruction(std::function<void()> deleter);
+    void CollectGarbage(uint64_t completedValue);
+    void FlushDeletionQueue(); // Waits for the device
+    size_t GetPendingDeletionCount() const;
+
+    // Defragmentation
+    // Only registered resources are moved. The pointers must stay valid until the
+    // resource is destroyed (DestroyBuffer / VulkanImage::DestroyImage unregister it).
+    bool RegisterMovable(AllocatedBuffer* buffer);
+    bool RegisterMovable(AllocatedImage* image);
+    void ForgetMovable(VmaAllocation allocation);
+
+    uint32_t AddDefragmentationListener(DefragmentationCallback callback);
+    void RemoveDefragmentationListener(uint32_t id);
+
+    bool BeginDefragmentation(const DefragmentationConfig& config = DefragmentationConfig());
+    bool DefragmentStep(VulkanCommandBuffer* commandBuffer); // Call once per frame after BeginFrame
+    void EndDefragmentation();
+    bool IsDefragmenting() const { return m_defragContext != VK_NULL_HANDLE; }
+    const DefragmentationStats& GetDefragmentationStats() const { return m_defragStats; }
+
     // Getters
     VmaAllocator GetAllocator() const { return m_allocator; }
     std::shared_ptr<VulkanDevice> GetDevice() const { return m_device; }
@@ -166,9 +429,87 @@ private:
     // State
     VkDeviceSize m_preferredLargeHeapBlockSize = 0;
     uint32_t m_currentFrameIndex = 0;
+    uint32_t m_framesInFlight = 3;
+    VkDeviceSize m_hostVisibleDeviceLocalBytes = 0;
+    bool m_bufferDeviceAddress = false;
+
+    // Pools
+    std::array<VmaPool, static_cast<size_t>(MemoryPoolClass::Count)> m_pools = {};
+    std::array<MemoryPoolConfig, static_cast<size_t>(MemoryPoolClass::Count)> m_poolConfigs = {};
+    std::array<uint32_t, static_cast<size_t>(MemoryPoolClass::Count)> m_poolMemoryTypes = {};
+
+    bool CreatePool(MemoryPoolClass pool, const MemoryPoolConfig& config);
+    void DestroyPools();
+    bool FindPoolMemoryType(MemoryPoolClass pool, uint32_t& outTypeIndex) const;
+    VkBufferUsageFlags GeometryUsage(VkBufferUsageFlags usage) const;
+
+    // Deferred destruction
+    VulkanDeletionQueue m_deletionQueue;
+    std::shared_ptr<VulkanSynchronization> m_timeline;
+    std::vector<std::function<void()>> m_unsubmittedDeletions; // Released since the last SubmitFrame
+    mutable std::mutex m_unsubmittedMutex;
 
     // Stats
     mutable std::vector<VmaBudget> m_lastBudgetSnapshot;
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(MemoryUsageTag::Count)> m_tagBytes = {};
+    std::array<std::atomic<uint32_t>, static_cast<size_t>(MemoryUsageTag::Count)> m_tagCounts = {};
+    std::atomic<uint64_t> m_directUploads = 0;
+    std::atomic<uint64_t> m_stagedUploads = 0;
+    std::atomic<uint64_t> m_directUploadBytes = 0;
+    std::atomic<uint64_t> m_stagedUploadBytes = 0;
+
+    MemoryUsageTag InferUsageTag(VkBufferUsageFlags usage) const;
+    void SnapshotBudgets() const;
+    void DetectHostVisibleDeviceLocal();
+
+    // Defragmentation
+    enum class DefragPhase
+    {
+        Idle,
+        Copying,
+        Retiring
+    };
+
+    struct MovableResource
+    {
+        AllocatedBuffer* buffer = nullptr;
+        AllocatedImage* image = nullptr;
+    };
+
+    struct PendingMove
+    {
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        MovableResource resource;
+        VkBuffer oldBuffer = VK_NULL_HANDLE;
+        VkImage oldImage = VK_NULL_HANDLE;
+        VkBuffer newBuffer = VK_NULL_HANDLE;
+        VkImage newImage = VK_NULL_HANDLE;
+    };
+
+    std::unordered_map<VmaAllocation, MovableResource> m_movables;
+    std::vector<std::pair<uint32_t, DefragmentationCallback>> m_defragListeners;
+    uint32_t m_nextDefragListenerId = 1;
+
+    VmaDefragmentationContext m_defragContext = VK_NULL_HANDLE;
+    VmaDefragmentationPassMoveInfo m_defragPass = {};
+    DefragPhase m_defragPhase = DefragPhase::Idle;
+    DefragmentationConfig m_defragConfig;
+    DefragmentationStats m_defragStats;
+    std::vector<PendingMove> m_pendingMoves;
+    VulkanCommandBuffer* m_defragCommands = nullptr;
+    VkCommandBuffer m_defragCmd = VK_NULL_HANDLE;
+    VkFence m_defragFence = VK_NULL_HANDLE;
+    uint32_t m_defragRetireFrame = 0;
+    std::vector<MemoryPoolClass> m_defragQueue; // Pools still to defragment after the current one
+
+    bool BeginPoolDefragmentation(MemoryPoolClass pool);
+    void FinishPoolDefragmentation(); // Moves on to the next queued pool, if any
+    bool BeginDefragmentationPass(VulkanCommandBuffer* commandBuffer);
+    bool PrepareMove(VmaDefragmentationMove& move, VkCommandBuffer cmd, PendingMove& outPending);
+    void RecordImageCopy(VkCommandBuffer cmd, const AllocatedImage& image, VkImage newImage) const;
+    void PatchPendingMoves();
+    bool RetirePendingMoves();
+    void DrainDefragmentationPass();
 
     // Logging
     static const Debug::DebugOutput DebugOut;
@@ -0,0 +1,268 @@
+#include "VulkanPipelineCache.h"
+#include "../../Math/Hash.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+const Debug::DebugOutput VulkanPipelineCache::DebugOut;
+
+VulkanPipelineCache::VulkanPipelineCache()
+{}
+
+VulkanPipelineCache::~VulkanPipelineCache()
+{
+    Cleanup();
+}
+
+bool VulkanPipelineCache::ValidateDependencies() const
+{
+    if (!m_instance || !m_instance->IsInitialized())
+    {
+        ReportError("Instance not initialized. 0x00025000");
+        return false;
+    }
+
+    if (!m_device || !m_device->IsInitialized())
+    {
+        ReportError("Device not initialized. 0x00025010");
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanPipelineCache::Initialize(
+    std::shared_ptr<VulkanInstance> instance,
+    std::shared_ptr<VulkanDevice> device,
+    const std::string& path)
+{
+    try
+    {
+        m_instance = instance;
+        m_device = device;
+        m_path = path;
+        m_stats = PipelineCacheStats();
+
+        if (!ValidateDependencies())
+            return false;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<char> blob = LoadBlob();
+        m_stats.warm = !blob.empty();
+
+        VkPipelineCacheCreateInfo createInfo = {};
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        createInfo.initialDataSize = blob.size();
+        createInfo.pInitialData = blob.empty() ? nullptr : blob.data();
+
+        VkResult result = vkCreatePipelineCache(m_device->GetDevice(), &createInfo, nullptr, &m_cache);
+        if (result != VK_SUCCESS && !blob.empty())
+        {
+            // The driver may still refuse a blob that passed our checks; start cold instead
+            ReportWarning("Driver rejected cache data, starting empty. 0x00025020");
+            m_stats.warm = false;
+            m_stats.rejectReason = "rejected by driver";
+            createInfo.initialDataSize = 0;
+            createInfo.pInitialData = nullptr;
+            result = vkCreatePipelineCache(m_device->GetDevice(), &createInfo, nullptr, &m_cache);
+        }
+
+        if (result != VK_SUCCESS)
+        {
+            ReportError("Failed to create pipeline cache. 0x00025030");
+            return false;
+        }
+
+        m_stats.loadedBytes = m_stats.warm ? blob.size() : 0;
+        m_stats.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        ReportError("Exception during initialization: " + std::string(e.what()));
+        return false;
+    }
+    catch (...)
+    {
+        ReportError("Unknown exception during initialization. 0x00025040");
+        return false;
+    }
+}
+
+void VulkanPipelineCache::Cleanup()
+{
+    if (m_device && m_device->IsInitialized() && m_cache != VK_NULL_HANDLE)
+    {
+        Save();
+        vkDestroyPipelineCache(m_device->GetDevice(), m_cache, nullptr);
+    }
+
+    m_cache = VK_NULL_HANDLE;
+    m_device.reset();
+    m_instance.reset();
+}
+
+std::vector<char> VulkanPipelineCache::LoadBlob()
+{
+    std::ifstream file(m_path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+        return {}; // First launch
+
+    const std::streamoff fileSize = file.tellg();
+    if (fileSize < static_cast<std::streamoff>(sizeof(FileHeader)))
+    {
+        m_stats.rejectReason = "file too small";
+        return {};
+    }
+
+    FileHeader header;
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (header.magic != FileMagic || header.version != FileVersion)
+    {
+        m_stats.rejectReason = "unknown file format";
+        return {};
+    }
+
+    if (header.dataSize != static_cast<uint64_t>(fileSize) - sizeof(FileHeader))
+    {
+        m_stats.rejectReason = "size mismatch";
+        return {};
+    }
+
+    std::vector<char> blob(static_cast<size_t>(header.dataSize));
+    file.read(blob.data(), static_cast<std::streamsize>(blob.size()));
+    if (!file || Hash::Fnv1a(blob.data(), blob.size()) != header.dataHash)
+    {
+        m_stats.rejectReason = "hash mismatch";
+        return {};
+    }
+
+    if (!ValidateBlob(blob))
+        return {};
+
+    return blob;
+}
+
+bool VulkanPipelineCache::ValidateBlob(const std::vector<char>& blob)
+{
+    VkPipelineCacheHeaderVersionOne header = {};
+    if (blob.size() < sizeof(header))
+    {
+        m_stats.rejectReason = "driver header truncated";
+        return false;
+    }
+    std::memcpy(&header, blob.data(), sizeof(header));
+
+    const VkPhysicalDeviceProperties& properties = m_device->GetDeviceProperties();
+
+    if (header.headerSize < sizeof(header) || header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+    {
+        m_stats.rejectReason = "unsupported driver header";
+        return false;
+    }
+
+    if (header.vendorID != properties.vendorID || header.deviceID != properties.deviceID)
+    {
+        m_stats.rejectReason = "different device";
+        return false;
+    }
+
+    if (std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        m_stats.rejectReason = "different driver version";
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanPipelineCache::Save()
+{
+    if (m_cache == VK_NULL_HANDLE || m_path.empty())
+        return false;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(m_device->GetDevice(), m_cache, &dataSize, nullptr) != VK_SUCCESS)
+    {
+        ReportError("Failed to query pipeline cache size. 0x00025100");
+        return false;
+    }
+
+    std::vector<char> blob(dataSize);
+    // VK_INCOMPLETE only if the cache grew between calls, which a concurrent compile can do
+    VkResult result = vkGetPipelineCacheData(m_device->GetDevice(), m_cache, &dataSize, blob.data());
+    if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+    {
+        ReportError("Failed to read pipeline cache data. 0x00025110");
+        return false;
+    }
+    blob.resize(dataSize);
+
+    FileHeader header;
+    header.magic = FileMagic;
+    header.version = FileVersion;
+    header.dataSize = blob.size();
+    header.dataHash = Hash::Fnv1a(blob.data(), blob.size());
+
+    const std::filesystem::path target(m_path);
+    const std::filesystem::path temporary(m_path + ".tmp");
+
+    try
+    {
+        if (target.has_parent_path())
+            std::filesystem::create_directories(target.parent_path());
+
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                ReportError("Failed to open " + temporary.string() + " 0x00025120");
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+            file.flush();
+            if (!file)
+            {
+                ReportError("Failed to write " + temporary.string() + " 0x00025130");
+                file.close();
+                std::filesystem::remove(temporary);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporary, target); // Replaces the old file in one step
+    }
+    catch (const std::filesystem::filesystem_error& e)
+    {
+        ReportError("Failed to replace pipeline cache file: " + std::string(e.what()) + " 0x00025140");
+        std::error_code ignored;
+        std::filesystem::remove(temporary, ignored);
+        return false;
+    }
+
+    m_stats.savedBytes = blob.size();
+    m_stats.saveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+std::string VulkanPipelineCache::GetCacheInfo() const
+{
+    if (!IsInitialized())
+        return "Pipeline cache not initialized";
+
+    std::string output = "VulkanPipelineCache Info:\n";
+    output += "  Path: " + m_path + "\n";
+    output += "  State: " + std::string(m_stats.warm ? "warm" : "cold") + "\n";
+    output += "  Loaded: " + std::to_string(m_stats.loadedBytes) + " bytes in " + std::to_string(m_stats.loadMs) + " ms\n";
+    if (!m_stats.rejectReason.empty())
+        output += "  Ignored file on disk: " + m_stats.rejectReason + "\n";
+    return output;
+}
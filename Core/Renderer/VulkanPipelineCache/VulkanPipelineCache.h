@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include "../VulkanInstance/VulkanInstance.h"
+#include "../VulkanDevice/VulkanDevice.h"
+#include "../../DebugOutput/DubugOutput.h"
+
+// Types
+struct PipelineCacheStats
+{
+    bool warm = false;          // Started from a blob on disk that matched this device
+    size_t loadedBytes = 0;
+    size_t savedBytes = 0;
+    double loadMs = 0.0;
+    double saveMs = 0.0;
+    std::string rejectReason;   // Why a blob on disk was ignored; empty when none was
+};
+
+// One VkPipelineCache for every pipeline the application creates, ImGui's included.
+// The blob is loaded on Initialize and written back on Save/Cleanup. On disk it is
+// wrapped in a small header carrying its size and hash, so a truncated or corrupted
+// file is rejected before the driver sees it; the driver's own header is then checked
+// against this device (vendor, device, cache UUID) because a blob from another GPU or
+// driver version is useless at best.
+class VulkanPipelineCache
+{
+public:
+    VulkanPipelineCache();
+    ~VulkanPipelineCache();
+
+    // RAII
+    VulkanPipelineCache(const VulkanPipelineCache&) = delete;
+    VulkanPipelineCache& operator=(const VulkanPipelineCache&) = delete;
+
+    // Lifecycle
+    bool Initialize(std::shared_ptr<VulkanInstance> instance,
+        std::shared_ptr<VulkanDevice> device,
+        const std::string& path);
+    void Cleanup(); // Saves, then destroys the cache
+    bool IsInitialized() const { return m_cache != VK_NULL_HANDLE; }
+
+    // Persistence
+    // Writes to a temporary file and renames it over the old one, so a crash mid-write
+    // never leaves a half-written cache behind.
+    bool Save();
+
+    // Getters
+    VkPipelineCache GetCache() const { return m_cache; }
+    const std::string& GetPath() const { return m_path; }
+    const PipelineCacheStats& GetStats() const { return m_stats; }
+
+    // Debug
+    std::string GetCacheInfo() const;
+
+private:
+    // Prefix written before the driver's blob
+    struct FileHeader
+    {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t dataSize = 0;
+        uint64_t dataHash = 0;
+    };
+
+    static constexpr uint32_t FileMagic = 0x43504B56; // "VKPC"
+    static constexpr uint32_t FileVersion = 1;
+
+    std::shared_ptr<VulkanInstance> m_instance;
+    std::shared_ptr<VulkanDevice> m_device;
+    VkPipelineCache m_cache = VK_NULL_HANDLE;
+    std::string m_path;
+    PipelineCacheStats m_stats;
+
+    static const Debug::DebugOutput DebugOut;
+
+    bool ValidateDependencies() const;
+    std::vector<char> LoadBlob();
+    bool ValidateBlob(const std::vector<char>& blob);
+
+    void ReportError(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanPipelineCache Error: " + message);
+    }
+
+    void ReportWarning(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanPipelineCache Warning: " + message);
+    }
+};
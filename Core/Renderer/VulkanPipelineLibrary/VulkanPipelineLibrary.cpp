@@ -0,0 +1,556 @@
+#include "VulkanPipelineLibrary.h"
+#include "../../Math/Hash.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
+const Debug::DebugOutput VulkanPipelineLibrary::DebugOut;
+
+namespace
+{
+    // Appends fields to a key. Strings are length-prefixed so adjacent fields can never
+    // run together into the same bytes.
+    class KeyWriter
+    {
+    public:
+        explicit KeyWriter(std::string& out) : m_out(out) {}
+
+        template <typename T>
+        void Value(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const size_t offset = m_out.size();
+            m_out.resize(offset + sizeof(T));
+            std::memcpy(m_out.data() + offset, &value, sizeof(T));
+        }
+
+        void String(const std::string& value)
+        {
+            Value(static_cast<uint32_t>(value.size()));
+            m_out.append(value);
+        }
+
+        // Non-dispatchable handles are pointers on 64-bit targets and uint64_t elsewhere
+        template <typename T>
+        void Handle(T handle) { Value((uint64_t)handle); }
+
+    private:
+        std::string& m_out;
+    };
+}
+
+namespace
+{
+    // Each writer covers the fields one slice of the pipeline depends on, so a part key
+    // only changes when that part's own state does.
+    void WriteShaders(KeyWriter& writer, const GraphicsPipelineConfig& config, bool fragment, bool nonFragment)
+    {
+        uint32_t count = 0;
+        for (const auto& shader : config.shaders)
+        {
+            const bool isFragment = shader.stage == VK_SHADER_STAGE_FRAGMENT_BIT;
+            if (isFragment ? fragment : nonFragment)
+                count++;
+        }
+
+        writer.Value(count);
+        for (const auto& shader : config.shaders)
+        {
+            const bool isFragment = shader.stage == VK_SHADER_STAGE_FRAGMENT_BIT;
+            if (!(isFragment ? fragment : nonFragment))
+                continue;
+
+            writer.Value(shader.stage);
+            writer.String(shader.entryPoint);
+            writer.String(shader.filepath);
+
+            // Ordered map, so equal maps always write the same bytes
+            writer.Value(static_cast<uint32_t>(shader.specialization.size()));
+            for (const auto& [constantId, value] : shader.specialization)
+            {
+                writer.Value(constantId);
+                writer.Value(value);
+            }
+        }
+    }
+
+    void WriteLayout(KeyWriter& writer, const GraphicsPipelineConfig& config)
+    {
+        writer.Value(static_cast<uint32_t>(config.pushConstantRanges.size()));
+        for (const auto& range : config.pushConstantRanges)
+        {
+            writer.Value(range.stageFlags);
+            writer.Value(range.offset);
+            writer.Value(range.size);
+        }
+
+        writer.Value(static_cast<uint32_t>(config.descriptorSetLayouts.size()));
+        for (VkDescriptorSetLayout layout : config.descriptorSetLayouts)
+            writer.Handle(layout);
+    }
+
+    void WriteVertexInput(KeyWriter& writer, const GraphicsPipelineConfig& config)
+    {
+        writer.Value(static_cast<uint32_t>(config.vertexInput.bindings.size()));
+        for (const auto& binding : config.vertexInput.bindings)
+        {
+            writer.Value(binding.binding);
+            writer.Value(binding.stride);
+            writer.Value(binding.inputRate);
+        }
+
+        writer.Value(static_cast<uint32_t>(config.vertexInput.attributes.size()));
+        for (const auto& attribute : config.vertexInput.attributes)
+        {
+            writer.Value(attribute.location);
+            writer.Value(attribute.binding);
+            writer.Value(attribute.format);
+            writer.Value(attribute.offset);
+        }
+
+        writer.Value(config.topology);
+    }
+
+    void WriteRasterization(KeyWriter& writer, const GraphicsPipelineConfig& config)
+    {
+        writer.Value(config.polygonMode);
+        writer.Value(config.cullMode);
+        writer.Value(config.frontFace);
+        writer.Value(config.lineWidth);
+    }
+
+    void WriteDepth(KeyWriter& writer, const GraphicsPipelineConfig& config)
+    {
+        writer.Value(config.depthTestEnable);
+        writer.Value(config.depthWriteEnable);
+        writer.Value(config.depthCompareOp);
+    }
+}
+
+PipelineKey PipelineKey::Build(VkRenderPass renderPass, const GraphicsPipelineConfig& config)
+{
+    PipelineKey key;
+    KeyWriter writer(key.bytes);
+
+    // Structs are written field by field; their padding bytes are not guaranteed to be zero
+    writer.Handle(renderPass);
+    WriteShaders(writer, config, true, true);
+    WriteLayout(writer, config);
+    WriteVertexInput(writer, config);
+    WriteRasterization(writer, config);
+    WriteDepth(writer, config);
+    writer.Value(config.blendEnable);
+
+    key.hash = Hash::Fnv1a(key.bytes);
+    return key;
+}
+
+PipelineKey PipelineKey::BuildPart(VkRenderPass renderPass, const GraphicsPipelineConfig& config, PipelinePart part)
+{
+    PipelineKey key;
+    KeyWriter writer(key.bytes);
+
+    // The part tag keeps slices that happen to write the same bytes apart
+    writer.Value(part);
+    writer.Handle(renderPass);
+
+    switch (part)
+    {
+    case PipelinePart::VertexInput:
+        WriteVertexInput(writer, config);
+        break;
+    case PipelinePart::PreRasterization:
+        WriteShaders(writer, config, false, true);
+        WriteLayout(writer, config);
+        WriteRasterization(writer, config);
+        break;
+    case PipelinePart::FragmentShader:
+        WriteShaders(writer, config, true, false);
+        WriteLayout(writer, config);
+        WriteDepth(writer, config);
+        break;
+    case PipelinePart::FragmentOutput:
+        writer.Value(config.blendEnable);
+        break;
+    default:
+        return Build(renderPass, config);
+    }
+
+    key.hash = Hash::Fnv1a(key.bytes);
+    return key;
+}
+
+VulkanPipelineLibrary::VulkanPipelineLibrary()
+{}
+
+VulkanPipelineLibrary::~VulkanPipelineLibrary()
+{
+    Cleanup();
+}
+
+bool VulkanPipelineLibrary::ValidateDependencies() const
+{
+    if (!m_instance || !m_instance->IsInitialized())
+    {
+        ReportError("Instance not initialized. 0x00026000");
+        return false;
+    }
+
+    if (!m_device || !m_device->IsInitialized())
+    {
+        ReportError("Device not initialized. 0x00026010");
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanPipelineLibrary::Initialize(
+    std::shared_ptr<VulkanInstance> instance,
+    std::shared_ptr<VulkanDevice> device,
+    std::shared_ptr<VulkanPipelineCache> pipelineCache,
+    std::shared_ptr<VulkanShaderModuleCache> shaderCache,
+    JobSystem* jobs)
+{
+    m_instance = instance;
+    m_device = device;
+    m_pipelineCache = pipelineCache;
+    m_shaderCache = shaderCache;
+    m_jobs = jobs;
+
+    if (!ValidateDependencies())
+    {
+        Cleanup();
+        return false;
+    }
+
+    return true;
+}
+
+void VulkanPipelineLibrary::Cleanup()
+{
+    // Workers hold this library; none may still be building when it lets go of the device
+    if (m_jobs)
+        m_jobs->Wait(m_compiles);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear(); // Pipelines still held elsewhere live on until released
+    m_retired.clear();
+    m_parts.clear();
+    m_stats = PipelineLibraryStats();
+    m_jobs = nullptr;
+    m_pipelineCache.reset();
+    m_shaderCache.reset();
+    m_device.reset();
+    m_instance.reset();
+}
+
+bool VulkanPipelineLibrary::ValidateRequest(const std::shared_ptr<VulkanRenderPass>& renderPass) const
+{
+    if (!IsInitialized())
+    {
+        ReportError("Library not initialized. 0x00026100");
+        return false;
+    }
+
+    if (!renderPass || !renderPass->IsInitialized())
+    {
+        ReportError("Render pass not initialized. 0x00026110");
+        return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<VulkanGraphicsPipeline> VulkanPipelineLibrary::Build(
+    const PipelineKey& key,
+    std::shared_ptr<VulkanRenderPass> renderPass,
+    const GraphicsPipelineConfig& config)
+{
+    // Runs without the lock so different variants compile in parallel
+    std::vector<std::shared_ptr<VulkanGraphicsPipeline>> parts;
+    std::shared_ptr<VulkanGraphicsPipeline> pipeline = UsesPipelineLibrary() ? FastLink(renderPass, config, parts) : nullptr;
+    const bool linked = pipeline != nullptr;
+
+    bool built = linked;
+    if (!linked)
+    {
+        // No pipeline library, or a part failed; the monolithic path still works
+        pipeline = std::make_shared<VulkanGraphicsPipeline>();
+        built = pipeline->Initialize(m_instance, m_device, renderPass, config, m_pipelineCache, m_shaderCache);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = m_entries[key];
+        if (built)
+        {
+            entry.pipeline = pipeline;
+            entry.state = EntryState::Ready;
+            m_stats.created++;
+            if (linked)
+                m_stats.fastLinked++;
+        }
+        else
+        {
+            entry.state = EntryState::Failed;
+            m_stats.failed++;
+            ReportError("Failed to build pipeline variant " + std::to_string(key.hash) + " 0x00026120");
+        }
+    }
+    m_built.notify_all();
+
+    // Scheduled only once the entry holds the fast link, which the swap checks for
+    if (linked)
+        ScheduleOptimize(key, renderPass, config, std::move(parts), pipeline);
+
+    return built ? pipeline : nullptr;
+}
+
+bool VulkanPipelineLibrary::UsesPipelineLibrary() const
+{
+    // The optimized link needs a worker; without one the monolithic build is just as slow
+    return m_jobs && m_device->IsGraphicsPipelineLibraryEnabled();
+}
+
+bool VulkanPipelineLibrary::HasParts(VkRenderPass renderPass, const GraphicsPipelineConfig& config) const
+{
+    const PipelinePart kinds[] = { PipelinePart::VertexInput, PipelinePart::PreRasterization,
+        PipelinePart::FragmentShader, PipelinePart::FragmentOutput };
+
+    std::vector<PipelineKey> keys;
+    for (PipelinePart part : kinds)
+        keys.push_back(PipelineKey::BuildPart(renderPass, config, part));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::all_of(keys.begin(), keys.end(), [this](const PipelineKey& key) { return m_parts.count(key) != 0; });
+}
+
+std::shared_ptr<VulkanGraphicsPipeline> VulkanPipelineLibrary::AcquirePart(
+    const std::shared_ptr<VulkanRenderPass>& renderPass,
+    const GraphicsPipelineConfig& config,
+    PipelinePart part)
+{
+    const PipelineKey key = PipelineKey::BuildPart(renderPass->GetRenderPass(), config, part);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_parts.find(key);
+        if (it != m_parts.end())
+            return it->second;
+    }
+
+    auto built = std::make_shared<VulkanGraphicsPipeline>();
+    if (!built->InitializePart(m_instance, m_device, renderPass, config, part, m_pipelineCache, m_shaderCache))
+    {
+        ReportError("Failed to build pipeline part " + std::to_string(static_cast<uint32_t>(part)) + " 0x00026200");
+        return nullptr;
+    }
+
+    // Two workers may build the same part; the first one stored is the one shared
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_parts.emplace(key, built).first->second;
+}
+
+std::shared_ptr<VulkanGraphicsPipeline> VulkanPipelineLibrary::FastLink(
+    const std::shared_ptr<VulkanRenderPass>& renderPass,
+    const GraphicsPipelineConfig& config,
+    std::vector<std::shared_ptr<VulkanGraphicsPipeline>>& outParts)
+{
+    const PipelinePart kinds[] = { PipelinePart::VertexInput, PipelinePart::PreRasterization,
+        PipelinePart::FragmentShader, PipelinePart::FragmentOutput };
+
+    outParts.clear();
+    for (PipelinePart part : kinds)
+    {
+        auto built = AcquirePart(renderPass, config, part);
+        if (!built)
+            return nullptr;
+        outParts.push_back(std::move(built));
+    }
+
+    auto pipeline = std::make_shared<VulkanGraphicsPipeline>();
+    if (!pipeline->InitializeLinked(m_instance, m_device, renderPass, config, outParts, false, m_pipelineCache))
+    {
+        ReportError("Failed to fast-link pipeline parts. 0x00026210");
+        return nullptr;
+    }
+
+    return pipeline;
+}
+
+void VulkanPipelineLibrary::ScheduleOptimize(
+    const PipelineKey& key,
+    std::shared_ptr<VulkanRenderPass> renderPass,
+    const GraphicsPipelineConfig& config,
+    std::vector<std::shared_ptr<VulkanGraphicsPipeline>> parts,
+    std::shared_ptr<VulkanGraphicsPipeline> fastLinked)
+{
+    m_jobs->Schedule([this, key, renderPass, config, parts = std::move(parts), fastLinked = std::move(fastLinked)]()
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto optimized = std::make_shared<VulkanGraphicsPipeline>();
+        if (!optimized->InitializeLinked(m_instance, m_device, renderPass, config, parts, true, m_pipelineCache))
+            return; // The fast link keeps serving the variant
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.asyncCompileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // Evicted or rebuilt meanwhile; the optimized link was never handed out
+        auto it = m_entries.find(key);
+        if (it == m_entries.end() || it->second.pipeline != fastLinked)
+            return;
+
+        // Frames already recorded with the fast link keep it until EvictUnused retires it
+        m_retired.push_back({ it->second.pipeline, it->second.lastUsedFrame });
+        it->second.pipeline = std::move(optimized);
+        m_stats.optimized++;
+    }, &m_compiles);
+}
+
+std::shared_ptr<VulkanGraphicsPipeline> VulkanPipelineLibrary::Find(const PipelineKey& key, uint64_t frameNumber)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.requests++;
+
+    auto it = m_entries.find(key);
+    if (it == m_entries.end() || it->second.state != EntryState::Ready)
+        return nullptr;
+
+    m_stats.hits++;
+    it->second.lastUsedFrame = std::max(it->second.lastUsedFrame, frameNumber);
+    return it->second.pipeline;
+}
+
+std::shared_ptr<VulkanGraphicsPipeline> VulkanPipelineLibrary::GetOrCreate(
+    std::shared_ptr<VulkanRenderPass> renderPass,
+    const GraphicsPipelineConfig& config,
+    uint64_t frameNumber)
+{
+    if (!ValidateRequest(renderPass))
+        return nullptr;
+
+    const PipelineKey key = PipelineKey::Build(renderPass->GetRenderPass(), config);
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stats.requests++;
+
+        auto it = m_entries.find(key);
+        if (it != m_entries.end())
+        {
+            // Someone else is building it; the entry stays put until it resolves
+            Entry& entry = it->second;
+            entry.waiters++;
+            m_built.wait(lock, [&entry]() { return entry.state != EntryState::Pending; });
+            entry.waiters--;
+
+            m_stats.hits++;
+            entry.lastUsedFrame = std::max(entry.lastUsedFrame, frameNumber);
+            return entry.pipeline;
+        }
+
+        // The pending entry is the claim: identical requests from here on wait for this build
+        m_entries.emplace(key, Entry{ nullptr, EntryState::Pending, frameNumber, 0 });
+    }
+
+    return Build(key, renderPass, config);
+}
+
+std::shared_ptr<VulkanGraphicsPipeline> VulkanPipelineLibrary::RequestAsync(
+    std::shared_ptr<VulkanRenderPass> renderPass,
+    const GraphicsPipelineConfig& config,
+    uint64_t frameNumber)
+{
+    if (!m_jobs)
+        return GetOrCreate(renderPass, config, frameNumber);
+
+    if (!ValidateRequest(renderPass))
+        return nullptr;
+
+    PipelineKey key = PipelineKey::Build(renderPass->GetRenderPass(), config);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.requests++;
+
+        auto it = m_entries.find(key);
+        if (it != m_entries.end())
+        {
+            Entry& entry = it->second;
+            entry.lastUsedFrame = std::max(entry.lastUsedFrame, frameNumber);
+            if (entry.state == EntryState::Ready)
+                m_stats.hits++;
+            return entry.pipeline; // Null while pending or failed
+        }
+
+        m_entries.emplace(key, Entry{ nullptr, EntryState::Pending, frameNumber, 0 });
+    }
+
+    // With every part already built the fast link is cheap enough to do at draw time
+    if (UsesPipelineLibrary() && m_device->HasGraphicsPipelineLibraryFastLinking() &&
+        HasParts(renderPass->GetRenderPass(), config))
+        return Build(key, renderPass, config);
+
+    m_jobs->Schedule([this, key = std::move(key), renderPass, config]()
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if (!Build(key, renderPass, config))
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.createdAsync++;
+        m_stats.asyncCompileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }, &m_compiles);
+
+    return nullptr;
+}
+
+uint32_t VulkanPipelineLibrary::EvictUnused(uint64_t frameNumber, uint64_t minAge)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint32_t evicted = 0;
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        // Failed entries go too, so the variant is retried if it is asked for again
+        const Entry& entry = it->second;
+        const bool stale = frameNumber >= entry.lastUsedFrame + minAge;
+        if (stale && entry.state != EntryState::Pending && entry.waiters == 0 && entry.pipeline.use_count() <= 1)
+        {
+            it = m_entries.erase(it);
+            evicted++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Retired fast links go by the same rule as entries
+    std::erase_if(m_retired, [&](const Retired& retired) {
+        return frameNumber >= retired.lastUsedFrame + minAge && retired.pipeline.use_count() <= 1;
+    });
+
+    // Parts no live pipeline or pending link holds are rebuilt if a new variant needs them
+    std::erase_if(m_parts, [](const auto& part) { return part.second.use_count() <= 1; });
+
+    m_stats.evicted += evicted;
+    return evicted;
+}
+
+PipelineLibraryStats VulkanPipelineLibrary::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    PipelineLibraryStats stats = m_stats;
+    for (const auto& [key, entry] : m_entries)
+    {
+        if (entry.state == EntryState::Ready)
+            stats.live++;
+        else if (entry.state == EntryState::Pending)
+            stats.pending++;
+    }
+    stats.parts = static_cast<uint32_t>(m_parts.size());
+    return stats;
+}
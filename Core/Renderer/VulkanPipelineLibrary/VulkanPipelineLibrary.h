@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../VulkanInstance/VulkanInstance.h"
+#include "../VulkanDevice/VulkanDevice.h"
+#include "../VulkanRenderPass/VulkanRenderPass.h"
+#include "../VulkanGraphicsPipeline/VulkanGraphicsPipeline.h"
+#include "../VulkanPipelineCache/VulkanPipelineCache.h"
+#include "../../Jobs/JobSystem.h"
+#include "../../DebugOutput/DubugOutput.h"
+
+// Types
+// Every field of a GraphicsPipelineConfig plus the render pass, flattened to bytes.
+// Two requests build the same pipeline exactly when their keys are equal; the hash
+// only picks the bucket.
+struct PipelineKey
+{
+    std::string bytes;
+    uint64_t hash = 0;
+
+    static PipelineKey Build(VkRenderPass renderPass, const GraphicsPipelineConfig& config);
+    // Only the fields the given library part depends on, so variants share parts
+    static PipelineKey BuildPart(VkRenderPass renderPass, const GraphicsPipelineConfig& config, PipelinePart part);
+
+    bool operator==(const PipelineKey& other) const { return hash == other.hash && bytes == other.bytes; }
+};
+
+struct PipelineKeyHasher
+{
+    size_t operator()(const PipelineKey& key) const { return static_cast<size_t>(key.hash); }
+};
+
+struct PipelineLibraryStats
+{
+    uint64_t requests = 0;
+    uint64_t hits = 0;
+    uint64_t created = 0;
+    uint64_t createdAsync = 0;
+    uint64_t failed = 0;
+    uint64_t evicted = 0;
+    uint32_t live = 0;
+    uint32_t pending = 0;     // Queued or compiling on a worker
+    double asyncCompileMs = 0.0; // Total worker time spent compiling
+    uint64_t fastLinked = 0;  // Variants linked from library parts
+    uint64_t optimized = 0;   // Fast-linked variants swapped for their optimized link
+    uint32_t parts = 0;       // Library parts held for linking
+};
+
+// Builds each distinct pipeline variant once and hands out the same object to every
+// request for it. Variants not requested for a while and not held outside the library
+// can be evicted; requests pass the frame number so age is measured in frames.
+// With a job system, variants can also be compiled on workers while the caller keeps
+// drawing with a fallback; vkCreateGraphicsPipelines is thread-safe, and the shared
+// pipeline cache synchronizes itself.
+// When the device has VK_EXT_graphics_pipeline_library and a job system is given,
+// variants are linked from cached parts instead: the fast link is handed out at once
+// and a worker swaps in an optimized link later. Variants whose parts all exist are
+// linked on the requesting thread. Other devices build monolithic pipelines.
+class VulkanPipelineLibrary
+{
+public:
+    VulkanPipelineLibrary();
+    ~VulkanPipelineLibrary();
+
+    // RAII
+    VulkanPipelineLibrary(const VulkanPipelineLibrary&) = delete;
+    VulkanPipelineLibrary& operator=(const VulkanPipelineLibrary&) = delete;
+
+    // Lifecycle
+    bool Initialize(std::shared_ptr<VulkanInstance> instance,
+        std::shared_ptr<VulkanDevice> device,
+        std::shared_ptr<VulkanPipelineCache> pipelineCache = nullptr,
+        std::shared_ptr<VulkanShaderModuleCache> shaderCache = nullptr,
+        JobSystem* jobs = nullptr); // Without one, async requests build on the calling thread
+    void Cleanup(); // Waits for queued compiles; the GPU must be done with every pipeline
+    bool IsInitialized() const { return m_device != nullptr; }
+
+    // Pipelines
+    // Returns the cached variant or builds it on this thread, waiting if a worker is
+    // already on it. Null if creation fails.
+    std::shared_ptr<VulkanGraphicsPipeline> GetOrCreate(std::shared_ptr<VulkanRenderPass> renderPass,
+        const GraphicsPipelineConfig& config, uint64_t frameNumber = 0);
+
+    // Returns the variant if it is ready; otherwise queues it on a worker (once) and
+    // returns null so the caller draws with a fallback. Failed variants stay null until
+    // evicted, rather than being retried every frame.
+    std::shared_ptr<VulkanGraphicsPipeline> RequestAsync(std::shared_ptr<VulkanRenderPass> renderPass,
+        const GraphicsPipelineConfig& config, uint64_t frameNumber = 0);
+    std::shared_ptr<VulkanGraphicsPipeline> Find(const PipelineKey& key, uint64_t frameNumber = 0);
+
+    // Drops variants unused for more than minAge frames that nobody else holds. minAge
+    // must cover the frames in flight so the GPU is done with them.
+    uint32_t EvictUnused(uint64_t frameNumber, uint64_t minAge);
+
+    // Getters
+    PipelineLibraryStats GetStats() const;
+
+private:
+    enum class EntryState
+    {
+        Pending, // Being built, on a worker or by another GetOrCreate
+        Ready,
+        Failed
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<VulkanGraphicsPipeline> pipeline;
+        EntryState state = EntryState::Pending;
+        uint64_t lastUsedFrame = 0;
+        uint32_t waiters = 0; // GetOrCreate calls blocked on it; never evicted while non-zero
+    };
+
+    std::shared_ptr<VulkanInstance> m_instance;
+    std::shared_ptr<VulkanDevice> m_device;
+    std::shared_ptr<VulkanPipelineCache> m_pipelineCache;
+    std::shared_ptr<VulkanShaderModuleCache> m_shaderCache;
+    JobSystem* m_jobs = nullptr;
+    JobCounter m_compiles; // Async builds still running
+
+    // A fast link replaced by its optimized link; the GPU may still be using it
+    struct Retired
+    {
+        std::shared_ptr<VulkanGraphicsPipeline> pipeline;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    std::unordered_map<PipelineKey, Entry, PipelineKeyHasher> m_entries;
+    std::unordered_map<PipelineKey, std::shared_ptr<VulkanGraphicsPipeline>, PipelineKeyHasher> m_parts;
+    std::vector<Retired> m_retired;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_built; // Signaled whenever a pending entry resolves
+    PipelineLibraryStats m_stats;
+
+    static const Debug::DebugOutput DebugOut;
+
+    bool ValidateDependencies() const;
+    bool ValidateRequest(const std::shared_ptr<VulkanRenderPass>& renderPass) const;
+    std::shared_ptr<VulkanGraphicsPipeline> Build(const PipelineKey& key,
+        std::shared_ptr<VulkanRenderPass> renderPass, const GraphicsPipelineConfig& config);
+
+    // Graphics pipeline library
+    bool UsesPipelineLibrary() const;
+    bool HasParts(VkRenderPass renderPass, const GraphicsPipelineConfig& config) const;
+    std::shared_ptr<VulkanGraphicsPipeline> AcquirePart(const std::shared_ptr<VulkanRenderPass>& renderPass,
+        const GraphicsPipelineConfig& config, PipelinePart part);
+    std::shared_ptr<VulkanGraphicsPipeline> FastLink(const std::shared_ptr<VulkanRenderPass>& renderPass,
+        const GraphicsPipelineConfig& config, std::vector<std::shared_ptr<VulkanGraphicsPipeline>>& outParts);
+    void ScheduleOptimize(const PipelineKey& key, std::shared_ptr<VulkanRenderPass> renderPass,
+        const GraphicsPipelineConfig& config, std::vector<std::shared_ptr<VulkanGraphicsPipeline>> parts,
+        std::shared_ptr<VulkanGraphicsPipeline> fastLinked);
+
+    void ReportError(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanPipelineLibrary Error: " + message);
+    }
+};
@@ -0,0 +1,766 @@
+#include "VulkanRenderGraph.h"
+#include <algorithm>
+
+const Debug::DebugOutput VulkanRenderGraph::DebugOut;
+
+static constexpr VkAccessFlags WriteAccessMask =
+    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_SHADER_WRITE_BIT |
+    VK_ACCESS_TRANSFER_WRITE_BIT |
+    VK_ACCESS_HOST_WRITE_BIT |
+    VK_ACCESS_MEMORY_WRITE_BIT;
+
+static constexpr VkImageUsageFlags AttachmentUsageMask =
+    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+    VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+static std::string ToHex(uint32_t value)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    std::string out = "0x";
+    for (int shift = 28; shift >= 0; shift -= 4)
+        out += digits[(value >> shift) & 0xF];
+    return out;
+}
+
+RenderGraphAccess RenderGraphAccess::FromUsage(RenderGraphUsage usage, bool write)
+{
+    RenderGraphAccess result;
+
+    switch (usage)
+    {
+    case RenderGraphUsage::ColorAttachment:
+        result.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        result.access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        result.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        result.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        break;
+
+    case RenderGraphUsage::DepthAttachment:
+        result.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        result.access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        result.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        result.imageUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        break;
+
+    case RenderGraphUsage::DepthRead:
+        result.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        result.access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+        result.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        result.imageUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        break;
+
+    case RenderGraphUsage::Sampled:
+        result.stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        result.access = VK_ACCESS_SHADER_READ_BIT;
+        result.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        result.imageUsage = VK_IMAGE_USAGE_SAMPLED_BIT;
+        break;
+
+    case RenderGraphUsage::ComputeRead:
+        result.stages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        result.access = VK_ACCESS_SHADER_READ_BIT;
+        result.layout = VK_IMAGE_LAYOUT_GENERAL;
+        result.imageUsage = VK_IMAGE_USAGE_STORAGE_BIT;
+        break;
+
+    case RenderGraphUsage::ComputeWrite:
+        result.stages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        result.access = VK_ACCESS_SHADER_WRITE_BIT;
+        result.layout = VK_IMAGE_LAYOUT_GENERAL;
+        result.imageUsage = VK_IMAGE_USAGE_STORAGE_BIT;
+        break;
+
+    case RenderGraphUsage::TransferSrc:
+        result.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        result.access = VK_ACCESS_TRANSFER_READ_BIT;
+        result.layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        result.imageUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        break;
+
+    case RenderGraphUsage::TransferDst:
+        result.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        result.access = VK_ACCESS_TRANSFER_WRITE_BIT;
+        result.layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        result.imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        break;
+    }
+
+    // A read keeps only the read half of usages like ColorAttachment
+    if (!write)
+        result.access &= ~WriteAccessMask;
+
+    result.write = write && (result.access & WriteAccessMask) != 0;
+    return result;
+}
+
+void RenderGraphBarrierBatch::Add(const RenderGraphBarrier& barrier)
+{
+    barriers.push_back(barrier);
+    srcStages |= barrier.srcStages;
+    dstStages |= barrier.dstStages;
+}
+
+RenderGraphPass& RenderGraphPass::Read(uint32_t resource, RenderGraphUsage usage)
+{
+    AddUse(resource, RenderGraphAccess::FromUsage(usage, false));
+    return *this;
+}
+
+RenderGraphPass& RenderGraphPass::Write(uint32_t resource, RenderGraphUsage usage)
+{
+    AddUse(resource, RenderGraphAccess::FromUsage(usage, true));
+    return *this;
+}
+
+void RenderGraphPass::AddUse(uint32_t resource, const RenderGraphAccess& access)
+{
+    for (auto& use : m_uses)
+    {
+        if (use.resource != resource)
+            continue;
+
+        // One image can only be in one layout for the whole pass
+        if (use.access.layout != access.layout)
+            m_valid = false;
+
+        use.access.stages |= access.stages;
+        use.access.access |= access.access;
+        use.access.imageUsage |= access.imageUsage;
+        use.access.write = use.access.write || access.write;
+        return;
+    }
+
+    m_uses.push_back({ resource, access });
+}
+
+VulkanRenderGraph::VulkanRenderGraph()
+{}
+
+VulkanRenderGraph::~VulkanRenderGraph()
+{
+    Cleanup();
+}
+
+bool VulkanRenderGraph::ValidateDependencies() const
+{
+    if (!m_instance || !m_instance->IsInitialized())
+    {
+        ReportError("Instance not initialized. 0x00023000");
+        return false;
+    }
+
+    if (!m_device || !m_device->IsInitialized())
+    {
+        ReportError("Device not initialized. 0x00023010");
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanRenderGraph::Initialize(
+    std::shared_ptr<VulkanInstance> instance,
+    std::shared_ptr<VulkanDevice> device,
+    std::shared_ptr<VulkanMemoryAllocator> allocator)
+{
+    try
+    {
+        m_instance = instance;
+        m_device = device;
+
+        if (!ValidateDependencies())
+            return false;
+
+        if (!m_transients.Initialize(instance, device, allocator))
+        {
+            ReportError("Failed to initialize transient allocator. 0x00023020");
+            return false;
+        }
+
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        ReportError("Exception during initialization: " + std::string(e.what()));
+        return false;
+    }
+    catch (...)
+    {
+        ReportError("Unknown exception during initialization. 0x00023030");
+        return false;
+    }
+}
+
+void VulkanRenderGraph::Cleanup()
+{
+    Reset();
+    m_transients.Cleanup();
+    m_device.reset();
+    m_instance.reset();
+}
+
+void VulkanRenderGraph::Reset()
+{
+    if (m_transients.IsInitialized())
+        m_transients.Reset();
+
+    m_resources.clear();
+    m_passes.clear();
+    m_passLive.clear();
+    m_compiledPasses.clear();
+    m_finalBarriers = {};
+    m_stats = {};
+    m_compiled = false;
+    m_allocated = false;
+}
+
+uint32_t VulkanRenderGraph::ImportImage(const RenderGraphImportDesc& desc)
+{
+    Resource resource;
+    resource.name = desc.name;
+    resource.format = desc.format;
+    resource.mipLevels = desc.mipLevels;
+    resource.arrayLayers = desc.arrayLayers;
+    resource.imported = true;
+    resource.output = desc.output;
+    resource.initialLayout = desc.initialLayout;
+    resource.initialStages = desc.initialStages;
+    resource.finalLayout = desc.finalLayout;
+    resource.finalStages = desc.finalStages;
+
+    m_resources.push_back(resource);
+    m_compiled = false;
+    return static_cast<uint32_t>(m_resources.size() - 1);
+}
+
+uint32_t VulkanRenderGraph::CreateImage(const RenderGraphImageDesc& desc)
+{
+    if (desc.width == 0 || desc.height == 0 || desc.format == VK_FORMAT_UNDEFINED)
+    {
+        ReportError("Invalid transient image description for '" + desc.name + "'. 0x00023100");
+        return InvalidResource;
+    }
+
+    Resource resource;
+    resource.name = desc.name;
+    resource.format = desc.format;
+    resource.width = desc.width;
+    resource.height = desc.height;
+    resource.samples = desc.samples;
+
+    m_resources.push_back(resource);
+    m_compiled = false;
+    return static_cast<uint32_t>(m_resources.size() - 1);
+}
+
+RenderGraphPass& VulkanRenderGraph::AddPass(const std::string& name)
+{
+    m_compiled = false;
+    return m_passes.emplace_back(name);
+}
+
+void VulkanRenderGraph::MarkOutput(uint32_t resource)
+{
+    if (resource >= m_resources.size())
+    {
+        ReportError("Output resource out of range. 0x00023110");
+        return;
+    }
+
+    m_resources[resource].output = true;
+    m_compiled = false;
+}
+
+bool VulkanRenderGraph::ValidatePasses() const
+{
+    for (const auto& pass : m_passes)
+    {
+        if (!pass.IsValid())
+        {
+            ReportError("Pass '" + pass.GetName() + "' uses one image in two layouts. 0x00023200");
+            return false;
+        }
+
+        for (const auto& use : pass.GetUses())
+        {
+            if (use.resource >= m_resources.size())
+            {
+                ReportError("Pass '" + pass.GetName() + "' uses an unknown resource. 0x00023210");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void VulkanRenderGraph::CullPasses()
+{
+    m_passLive.assign(m_passes.size(), false);
+
+    std::vector<bool> needed(m_resources.size(), false);
+    for (size_t i = 0; i < m_resources.size(); i++)
+        needed[i] = m_resources[i].output;
+
+    // Walk back from the outputs. Declaration order is submission order, so every
+    // producer of a resource comes before its consumers.
+    for (size_t p = m_passes.size(); p-- > 0;)
+    {
+        const RenderGraphPass& pass = m_passes[p];
+
+        bool live = pass.HasSideEffects();
+        for (const auto& use : pass.GetUses())
+        {
+            if (use.access.write && needed[use.resource])
+                live = true;
+        }
+
+        if (!live)
+            continue;
+
+        m_passLive[p] = true;
+
+        // A use that only writes replaces the contents, so earlier writers are not needed
+        // for it. Attachments also read (load, blending, depth test) and keep them alive.
+        for (const auto& use : pass.GetUses())
+        {
+            const bool reads = (use.access.access & ~WriteAccessMask) != 0;
+            if (reads)
+                needed[use.resource] = true;
+            else if (use.access.write)
+                needed[use.resource] = false;
+        }
+    }
+}
+
+void VulkanRenderGraph::ComputeLifetimes()
+{
+    for (auto& resource : m_resources)
+    {
+        resource.firstPass = UINT32_MAX;
+        resource.lastPass = 0;
+        resource.usage = 0;
+    }
+
+    uint32_t order = 0;
+    for (size_t p = 0; p < m_passes.size(); p++)
+    {
+        if (!m_passLive[p])
+            continue;
+
+        for (const auto& use : m_passes[p].GetUses())
+        {
+            Resource& resource = m_resources[use.resource];
+            resource.firstPass = std::min(resource.firstPass, order);
+            resource.lastPass = std::max(resource.lastPass, order);
+            resource.usage |= use.access.imageUsage;
+        }
+
+        order++;
+    }
+}
+
+void VulkanRenderGraph::ComputeCarriedState(VkPipelineStageFlags& stages, VkAccessFlags& access) const
+{
+    // The state each transient is left in at the end of the graph: the stages that
+    // touched it since its last write or layout change, and that write's access unless
+    // a read already made it available
+    std::vector<VkPipelineStageFlags> lastStages(m_resources.size(), 0);
+    std::vector<VkAccessFlags> lastAccess(m_resources.size(), 0);
+    std::vector<VkImageLayout> lastLayout(m_resources.size(), VK_IMAGE_LAYOUT_UNDEFINED);
+
+    for (size_t p = 0; p < m_passes.size(); p++)
+    {
+        if (!m_passLive[p])
+            continue;
+
+        for (const auto& use : m_passes[p].GetUses())
+        {
+            if (m_resources[use.resource].imported)
+                continue;
+
+            if (use.access.write || use.access.layout != lastLayout[use.resource])
+                lastStages[use.resource] = use.access.stages;
+            else
+                lastStages[use.resource] |= use.access.stages;
+
+            lastAccess[use.resource] = use.access.write ? (use.access.access & WriteAccessMask) : 0;
+            lastLayout[use.resource] = use.access.layout;
+        }
+    }
+
+    stages = 0;
+    access = 0;
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        stages |= lastStages[i];
+        access |= lastAccess[i];
+    }
+}
+
+void VulkanRenderGraph::ComputeBarriers()
+{
+    m_compiledPasses.clear();
+    m_finalBarriers = {};
+
+    std::vector<ResourceState> states(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        if (!m_resources[i].imported)
+            continue;
+
+        states[i].layout = m_resources[i].initialLayout;
+        states[i].writeStages = m_resources[i].initialStages;
+    }
+
+    // Transient memory is shared by every frame in flight, so a transient's first use
+    // also waits for the last use of every transient in the previous frame
+    VkPipelineStageFlags carriedStages = 0;
+    VkAccessFlags carriedAccess = 0;
+    ComputeCarriedState(carriedStages, carriedAccess);
+
+    // Transients whose lifetime ended may share memory with ones that start later
+    VkPipelineStageFlags retiredStages = 0;
+    VkAccessFlags retiredAccess = 0;
+
+    uint32_t order = 0;
+    for (size_t p = 0; p < m_passes.size(); p++)
+    {
+        if (!m_passLive[p])
+            continue;
+
+        CompiledRenderGraphPass compiled;
+        compiled.pass = static_cast<uint32_t>(p);
+
+        for (const auto& use : m_passes[p].GetUses())
+        {
+            const Resource& resource = m_resources[use.resource];
+            const RenderGraphAccess& access = use.access;
+            ResourceState& state = states[use.resource];
+
+            if (!state.touched && !resource.imported)
+            {
+                state.writeStages |= retiredStages | carriedStages;
+                state.pendingAccess |= retiredAccess | carriedAccess;
+            }
+            state.touched = true;
+
+            const bool layoutChange = state.layout != access.layout;
+
+            RenderGraphBarrier barrier;
+            barrier.resource = use.resource;
+            barrier.dstStages = access.stages;
+            barrier.dstAccess = access.access;
+            barrier.oldLayout = state.layout;
+            barrier.newLayout = access.layout;
+
+            if (!access.write && !layoutChange)
+            {
+                // Read after read, or the last write is already visible here
+                const bool visible = (access.stages & ~state.visibleStages) == 0 &&
+                    (access.access & ~state.visibleAccess) == 0;
+
+                if (!visible && (state.writeStages != 0 || state.pendingAccess != 0))
+                {
+                    barrier.srcStages = state.writeStages;
+                    barrier.srcAccess = state.pendingAccess;
+                    compiled.barriers.Add(barrier);
+
+                    state.pendingAccess = 0;
+                    state.visibleStages |= access.stages;
+                    state.visibleAccess |= access.access;
+                }
+
+                state.readStages |= access.stages;
+                continue;
+            }
+
+            // Writes wait for earlier reads (WAR) and writes (WAW); layout changes wait for both
+            barrier.srcStages = state.writeStages | state.readStages;
+            barrier.srcAccess = state.pendingAccess;
+
+            if (layoutChange || barrier.srcStages != 0 || barrier.srcAccess != 0)
+                compiled.barriers.Add(barrier);
+
+            state.layout = access.layout;
+            state.writeStages = access.stages;
+            state.pendingAccess = access.write ? (access.access & WriteAccessMask) : 0;
+            state.readStages = access.write ? 0 : access.stages;
+            state.visibleStages = access.write ? 0 : access.stages;
+            state.visibleAccess = access.write ? 0 : access.access;
+        }
+
+        for (size_t i = 0; i < m_resources.size(); i++)
+        {
+            const Resource& resource = m_resources[i];
+            if (resource.imported || resource.lastPass != order || resource.firstPass == UINT32_MAX)
+                continue;
+
+            retiredStages |= states[i].writeStages | states[i].readStages;
+            retiredAccess |= states[i].pendingAccess;
+        }
+
+        m_stats.barrierCount += static_cast<uint32_t>(compiled.barriers.barriers.size());
+        m_compiledPasses.push_back(std::move(compiled));
+        order++;
+    }
+
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        const Resource& resource = m_resources[i];
+        const ResourceState& state = states[i];
+
+        if (!resource.imported || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
+            resource.finalLayout == state.layout)
+            continue;
+
+        RenderGraphBarrier barrier;
+        barrier.resource = static_cast<uint32_t>(i);
+        barrier.srcStages = state.writeStages | state.readStages;
+        barrier.srcAccess = state.pendingAccess;
+        barrier.dstStages = resource.finalStages;
+        barrier.dstAccess = 0;
+        barrier.oldLayout = state.layout;
+        barrier.newLayout = resource.finalLayout;
+        m_finalBarriers.Add(barrier);
+    }
+
+    m_stats.barrierCount += static_cast<uint32_t>(m_finalBarriers.barriers.size());
+}
+
+bool VulkanRenderGraph::Compile()
+{
+    m_compiled = false;
+    m_allocated = false;
+    m_stats = {};
+
+    if (!ValidatePasses())
+        return false;
+
+    if (m_passes.empty())
+        ReportWarning("Compiling a graph without passes. 0x00023300");
+
+    CullPasses();
+    ComputeLifetimes();
+    ComputeBarriers();
+
+    m_stats.declaredPasses = static_cast<uint32_t>(m_passes.size());
+    m_stats.culledPasses = m_stats.declaredPasses - static_cast<uint32_t>(m_compiledPasses.size());
+
+    for (const auto& compiled : m_compiledPasses)
+    {
+        if (!compiled.barriers.IsEmpty())
+            m_stats.batchCount++;
+
+        for (const auto& barrier : compiled.barriers.barriers)
+            m_stats.layoutTransitions += barrier.IsLayoutTransition() ? 1 : 0;
+    }
+
+    if (!m_finalBarriers.IsEmpty())
+        m_stats.batchCount++;
+
+    for (const auto& barrier : m_finalBarriers.barriers)
+        m_stats.layoutTransitions += barrier.IsLayoutTransition() ? 1 : 0;
+
+    m_compiled = true;
+    return true;
+}
+
+bool VulkanRenderGraph::Allocate()
+{
+    if (!IsInitialized())
+    {
+        ReportError("Not initialized. 0x00023400");
+        return false;
+    }
+
+    if (!m_compiled)
+    {
+        ReportError("Allocate called before Compile. 0x00023410");
+        return false;
+    }
+
+    m_transients.Reset();
+    m_allocated = false;
+
+    bool any = false;
+    for (auto& resource : m_resources)
+    {
+        resource.transientHandle = UINT32_MAX;
+        if (resource.imported)
+            continue;
+
+        if (resource.firstPass == UINT32_MAX)
+        {
+            ReportWarning("Transient image '" + resource.name + "' is not used by any live pass. 0x00023420");
+            continue;
+        }
+
+        TransientImageDesc desc;
+        desc.width = resource.width;
+        desc.height = resource.height;
+        desc.format = resource.format;
+        desc.samples = resource.samples;
+        desc.usage = resource.usage;
+        desc.firstPass = resource.firstPass;
+        desc.lastPass = resource.lastPass;
+        desc.name = resource.name;
+
+        // Attachment-only images never leave tile memory on devices that support it
+        if ((desc.usage & ~AttachmentUsageMask) == 0)
+            desc.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+        resource.transientHandle = m_transients.AddImage(desc);
+        any = true;
+    }
+
+    if (any && !m_transients.Build())
+    {
+        ReportError("Failed to create transient images. 0x00023430");
+        return false;
+    }
+
+    m_allocated = true;
+    return true;
+}
+
+bool VulkanRenderGraph::SetImportedImage(uint32_t resource, VkImage image)
+{
+    if (resource >= m_resources.size() || !m_resources[resource].imported)
+    {
+        ReportError("Resource is not an imported image. 0x00023500");
+        return false;
+    }
+
+    m_resources[resource].image = image;
+    return true;
+}
+
+VkImage VulkanRenderGraph::GetImage(uint32_t resource) const
+{
+    if (resource >= m_resources.size())
+        return VK_NULL_HANDLE;
+
+    const Resource& entry = m_resources[resource];
+    if (entry.imported)
+        return entry.image;
+
+    if (entry.transientHandle == UINT32_MAX)
+        return VK_NULL_HANDLE;
+
+    return m_transients.GetImage(entry.transientHandle).image.image;
+}
+
+VkImageView VulkanRenderGraph::GetTransientView(uint32_t resource) const
+{
+    if (resource >= m_resources.size() || m_resources[resource].transientHandle == UINT32_MAX)
+        return VK_NULL_HANDLE;
+
+    return m_transients.GetView(m_resources[resource].transientHandle);
+}
+
+void VulkanRenderGraph::RecordBatch(VkCommandBuffer commandBuffer, const RenderGraphBarrierBatch& batch) const
+{
+    if (batch.IsEmpty())
+        return;
+
+    // Each barrier keeps its own stages; the whole batch is still one call
+    BarrierBatch barriers(m_device && m_device->IsSynchronization2Enabled());
+
+    for (const auto& entry : batch.barriers)
+    {
+        const Resource& resource = m_resources[entry.resource];
+
+        VkImageSubresourceRange range = {};
+        range.aspectMask = BarrierBatch::AspectFromFormat(resource.format);
+        range.baseMipLevel = 0;
+        range.levelCount = resource.mipLevels;
+        range.baseArrayLayer = 0;
+        range.layerCount = resource.arrayLayers;
+
+        barriers.Image(GetImage(entry.resource), range, entry.oldLayout, entry.newLayout,
+            BarrierScope::Make(entry.srcStages, entry.srcAccess),
+            BarrierScope::Make(entry.dstStages, entry.dstAccess));
+    }
+
+    barriers.Flush(commandBuffer);
+}
+
+bool VulkanRenderGraph::Execute(VkCommandBuffer commandBuffer) const
+{
+    if (!m_compiled)
+    {
+        ReportError("Execute called before Compile. 0x00023600");
+        return false;
+    }
+
+    if (commandBuffer == VK_NULL_HANDLE)
+    {
+        ReportError("Invalid command buffer. 0x00023610");
+        return false;
+    }
+
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        const Resource& resource = m_resources[i];
+        const bool used = resource.firstPass != UINT32_MAX ||
+            (resource.imported && resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED);
+
+        if (used && GetImage(static_cast<uint32_t>(i)) == VK_NULL_HANDLE)
+        {
+            ReportError("No image bound for '" + resource.name + "'. 0x00023620");
+            return false;
+        }
+    }
+
+    for (const auto& compiled : m_compiledPasses)
+    {
+        RecordBatch(commandBuffer, compiled.barriers);
+
+        const auto& execute = m_passes[compiled.pass].GetExecute();
+        if (execute)
+            execute(commandBuffer);
+    }
+
+    RecordBatch(commandBuffer, m_finalBarriers);
+    return true;
+}
+
+std::string VulkanRenderGraph::GetCompiledInfo() const
+{
+    if (!m_compiled)
+        return "Render graph not compiled";
+
+    auto describe = [this](const RenderGraphBarrierBatch& batch, std::string& info) {
+        for (const auto& barrier : batch.barriers)
+        {
+            info += "    " + m_resources[barrier.resource].name;
+            info += ": layout " + std::to_string(barrier.oldLayout) + " -> " + std::to_string(barrier.newLayout);
+            info += ", stages " + ToHex(barrier.srcStages) + " -> " + ToHex(barrier.dstStages);
+            info += ", access " + ToHex(barrier.srcAccess) + " -> " + ToHex(barrier.dstAccess) + "\n";
+        }
+    };
+
+    std::string info = "VulkanRenderGraph Info:\n";
+    info += "  Passes: " + std::to_string(m_stats.declaredPasses) + " declared, " +
+        std::to_string(m_stats.culledPasses) + " culled\n";
+    info += "  Barriers: " + std::to_string(m_stats.barrierCount) + " in " +
+        std::to_string(m_stats.batchCount) + " batches\n";
+
+    for (const auto& compiled : m_compiledPasses)
+    {
+        info += "  Pass '" + m_passes[compiled.pass].GetName() + "'\n";
+        describe(compiled.barriers, info);
+    }
+
+    if (!m_finalBarriers.IsEmpty())
+    {
+        info += "  Final\n";
+        describe(m_finalBarriers, info);
+    }
+
+    return info;
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <string>
+#include <functional>
+#include "../VulkanInstance/VulkanInstance.h"
+#include "../VulkanDevice/VulkanDevice.h"
+#include "../VulkanMemoryAllocator/VulkanMemoryAllocator.h"
+#include "../VulkanTransientAllocator/VulkanTransientAllocator.h"
+#include "../VulkanImage/BarrierBatch.h"
+#include "../../DebugOutput/DubugOutput.h"
+
+// Types
+// How a pass touches an image. Each usage maps to one layout plus the stages and
+// accesses that sync needs, so passes never spell out barriers themselves.
+enum class RenderGraphUsage
+{
+    ColorAttachment,
+    DepthAttachment, // Depth test and write
+    DepthRead,       // Depth test only, read-only layout
+    Sampled,         // Fragment shader sampling
+    ComputeRead,
+    ComputeWrite,
+    TransferSrc,
+    TransferDst
+};
+
+struct RenderGraphAccess
+{
+    VkPipelineStageFlags stages = 0;
+    VkAccessFlags access = 0;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageUsageFlags imageUsage = 0; // Needed to create a transient image used this way
+    bool write = false;
+
+    static RenderGraphAccess FromUsage(RenderGraphUsage usage, bool write);
+};
+
+// One image barrier with exact stages, recorded as a VkImageMemoryBarrier2
+struct RenderGraphBarrier
+{
+    uint32_t resource = 0;
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    VkAccessFlags srcAccess = 0;
+    VkAccessFlags dstAccess = 0;
+    VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    bool IsLayoutTransition() const { return oldLayout != newLayout; }
+};
+
+// Every barrier a pass needs, recorded as a single vkCmdPipelineBarrier2
+struct RenderGraphBarrierBatch
+{
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    std::vector<RenderGraphBarrier> barriers;
+
+    bool IsEmpty() const { return barriers.empty(); }
+    void Add(const RenderGraphBarrier& barrier);
+};
+
+struct CompiledRenderGraphPass
+{
+    uint32_t pass = 0; // Index into the declared passes
+    RenderGraphBarrierBatch barriers; // Issued before the pass executes
+};
+
+struct RenderGraphStats
+{
+    uint32_t declaredPasses = 0;
+    uint32_t culledPasses = 0;
+    uint32_t barrierCount = 0;
+    uint32_t batchCount = 0; // Barrier calls per execution
+    uint32_t layoutTransitions = 0;
+};
+
+// Config
+// An image owned outside the graph. Initial state describes the image when the frame
+// starts: initialStages is the stage a semaphore wait covers for it (or 0 when nothing
+// precedes), and the graph transitions it to finalLayout after the last pass.
+struct RenderGraphImportDesc
+{
+    std::string name;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t mipLevels = 1;
+    uint32_t arrayLayers = 1;
+    VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags initialStages = 0;
+    VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED; // UNDEFINED leaves it as the last pass did
+    VkPipelineStageFlags finalStages = 0; // Nothing in this submission follows; a semaphore orders the rest
+    bool output = false; // Passes writing an output are never culled
+
+    // Acquired swapchain image, waited on at color output and handed to present
+    static RenderGraphImportDesc Backbuffer(VkFormat format)
+    {
+        RenderGraphImportDesc desc;
+        desc.name = "backbuffer";
+        desc.format = format;
+        desc.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        desc.initialStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        desc.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        desc.output = true;
+        return desc;
+    }
+
+    // Image whose contents do not survive the frame, e.g. a per-frame depth buffer
+    static RenderGraphImportDesc Scratch(VkFormat format, const std::string& name)
+    {
+        RenderGraphImportDesc desc;
+        desc.name = name;
+        desc.format = format;
+        return desc;
+    }
+};
+
+// Config
+// An image created and owned by the graph. Its lifetime is the span of live passes
+// that use it, and images with disjoint lifetimes share memory.
+struct RenderGraphImageDesc
+{
+    std::string name;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+    static RenderGraphImageDesc Make(const std::string& name, uint32_t width, uint32_t height, VkFormat format)
+    {
+        RenderGraphImageDesc desc;
+        desc.name = name;
+        desc.width = width;
+        desc.height = height;
+        desc.format = format;
+        return desc;
+    }
+};
+
+class RenderGraphPass
+{
+public:
+    using ExecuteFn = std::function<void(VkCommandBuffer)>;
+
+    struct Use
+    {
+        uint32_t resource = 0;
+        RenderGraphAccess access;
+    };
+
+    explicit RenderGraphPass(const std::string& name) : m_name(name) {}
+
+    // Declaration
+    RenderGraphPass& Read(uint32_t resource, RenderGraphUsage usage);
+    RenderGraphPass& Write(uint32_t resource, RenderGraphUsage usage);
+    RenderGraphPass& SetSideEffects() { m_sideEffects = true; return *this; } // Never culled
+    RenderGraphPass& SetExecute(ExecuteFn execute) { m_execute = std::move(execute); return *this; }
+
+    // Getters
+    const std::string& GetName() const { return m_name; }
+    const std::vector<Use>& GetUses() const { return m_uses; }
+    bool HasSideEffects() const { return m_sideEffects; }
+    bool IsValid() const { return m_valid; }
+    const ExecuteFn& GetExecute() const { return m_execute; }
+
+private:
+    std::string m_name;
+    std::vector<Use> m_uses; // One entry per resource; repeated uses are merged
+    ExecuteFn m_execute;
+    bool m_sideEffects = false;
+    bool m_valid = true; // False once a resource is used with two layouts
+
+    void AddUse(uint32_t resource, const RenderGraphAccess& access);
+};
+
+// Declares passes and the images they read and write, then compiles them into an
+// ordered list of live passes with the barriers each one needs. Compile() never
+// touches the device, so a graph can be built and its barriers inspected headless;
+// only Allocate() and Execute() need Initialize(). Transient images are shared by
+// every frame in flight; the barriers order each frame after the previous one's uses.
+class VulkanRenderGraph
+{
+public:
+    static constexpr uint32_t InvalidResource = UINT32_MAX;
+
+    VulkanRenderGraph();
+    ~VulkanRenderGraph();
+
+    // RAII
+    VulkanRenderGraph(const VulkanRenderGraph&) = delete;
+    VulkanRenderGraph& operator=(const VulkanRenderGraph&) = delete;
+
+    // Lifecycle
+    bool Initialize(std::shared_ptr<VulkanInstance> instance,
+        std::shared_ptr<VulkanDevice> device,
+        std::shared_ptr<VulkanMemoryAllocator> allocator);
+    void Cleanup();
+    bool IsInitialized() const { return m_transients.IsInitialized(); }
+    void Reset(); // Drops passes, resources and transient images; the GPU must be done with them
+
+    // Declaration
+    uint32_t ImportImage(const RenderGraphImportDesc& desc);
+    uint32_t CreateImage(const RenderGraphImageDesc& desc);
+    RenderGraphPass& AddPass(const std::string& name); // Declare passes in submission order
+    void MarkOutput(uint32_t resource);
+
+    // Build
+    bool Compile();   // Culls passes and computes barriers; headless
+    bool Allocate();  // Creates transient images with the compiled lifetimes
+
+    // Recording
+    bool SetImportedImage(uint32_t resource, VkImage image); // May change every frame without recompiling
+    bool Execute(VkCommandBuffer commandBuffer) const;
+
+    // Getters
+    bool IsCompiled() const { return m_compiled; }
+    const std::vector<CompiledRenderGraphPass>& GetCompiledPasses() const { return m_compiledPasses; }
+    const RenderGraphBarrierBatch& GetFinalBarriers() const { return m_finalBarriers; }
+    const RenderGraphPass& GetPass(uint32_t pass) const { return m_passes[pass]; }
+    uint32_t GetPassCount() const { return static_cast<uint32_t>(m_passes.size()); }
+    bool IsPassCulled(uint32_t pass) const { return pass < m_passLive.size() && !m_passLive[pass]; }
+    const std::string& GetResourceName(uint32_t resource) const { return m_resources[resource].name; }
+    uint32_t GetResourceCount() const { return static_cast<uint32_t>(m_resources.size()); }
+    // Span of compiled passes using the resource; InvalidResource first pass when no live pass does
+    uint32_t GetFirstPass(uint32_t resource) const { return m_resources[resource].firstPass; }
+    uint32_t GetLastPass(uint32_t resource) const { return m_resources[resource].lastPass; }
+    VkImage GetImage(uint32_t resource) const;
+    VkImageView GetTransientView(uint32_t resource) const;
+    const RenderGraphStats& GetStats() const { return m_stats; }
+    const TransientAllocatorStats& GetTransientStats() const { return m_transients.GetStats(); }
+
+    // Debug
+    std::string GetCompiledInfo() const;
+
+private:
+    struct Resource
+    {
+        std::string name;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipLevels = 1;
+        uint32_t arrayLayers = 1;
+        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+        VkImageUsageFlags usage = 0; // Union of every use, for transient creation
+
+        bool imported = false;
+        bool output = false;
+        VkImage image = VK_NULL_HANDLE; // Imported only
+        VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags initialStages = 0;
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags finalStages = 0;
+
+        uint32_t firstPass = UINT32_MAX; // Compiled order
+        uint32_t lastPass = 0;
+        uint32_t transientHandle = UINT32_MAX;
+    };
+
+    // Sync state of one image while walking the compiled passes
+    struct ResourceState
+    {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags writeStages = 0;   // Last write or layout transition
+        VkAccessFlags pendingAccess = 0;        // Written but not yet made available
+        VkPipelineStageFlags readStages = 0;    // Reads since the last write
+        VkPipelineStageFlags visibleStages = 0; // Where the last write is visible
+        VkAccessFlags visibleAccess = 0;
+        bool touched = false;
+    };
+
+    std::shared_ptr<VulkanInstance> m_instance;
+    std::shared_ptr<VulkanDevice> m_device;
+    VulkanTransientAllocator m_transients;
+
+    std::vector<Resource> m_resources;
+    std::deque<RenderGraphPass> m_passes; // Deque keeps AddPass references stable
+
+    std::vector<bool> m_passLive;
+    std::vector<CompiledRenderGraphPass> m_compiledPasses;
+    RenderGraphBarrierBatch m_finalBarriers;
+    RenderGraphStats m_stats;
+    bool m_compiled = false;
+    bool m_allocated = false;
+
+    static const Debug::DebugOutput DebugOut;
+
+    bool ValidateDependencies() const;
+    bool ValidatePasses() const;
+    void CullPasses();
+    void ComputeLifetimes();
+    void ComputeCarriedState(VkPipelineStageFlags& stages, VkAccessFlags& access) const;
+    void ComputeBarriers();
+    void RecordBatch(VkCommandBuffer commandBuffer, const RenderGraphBarrierBatch& batch) const;
+
+    void ReportError(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanRenderGraph Error: " + message);
+    }
+
+    void ReportWarning(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanRenderGraph Warning: " + message);
+    }
+};
@@ -255,7 +255,8 @@ void VulkanRenderPass::Begin(
     VkCommandBuffer commandBuffer,
     VkFramebuffer framebuffer,
     VkExtent2D renderArea,
-    const std::vector<VkClearValue>& clearValues)
+    const std::vector<VkClearValue>& clearValues,
+    VkSubpassContents contents)
 {
     VkRenderPassBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -266,7 +267,7 @@ void VulkanRenderPass::Begin(
     beginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     beginInfo.pClearValues = clearValues.empty() ? nullptr : clearValues.data();
 
-    vkCmdBeginRenderPass(commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(commandBuffer, &beginInfo, contents);
 }
 
 //Just tells Vulkan that this is the end of the render commands using this renderpass and ends it. ^
@@ -98,7 +98,8 @@ public:
     void Begin(VkCommandBuffer commandBuffer,
         VkFramebuffer framebuffer,
         VkExtent2D renderArea,
-        const std::vector<VkClearValue>& clearValues = {});
+        const std::vector<VkClearValue>& clearValues = {},
+        VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
     void End(VkCommandBuffer commandBuffer);
 
     // Getters
@@ -0,0 +1,168 @@
+#include "ShaderArchive.h"
+#include "../../Math/Hash.h"
+#include <cstring>
+#include <fstream>
+
+const Debug::DebugOutput ShaderArchive::DebugOut;
+
+namespace
+{
+    template <typename T>
+    bool ReadValue(const std::vector<char>& data, size_t& cursor, T& out)
+    {
+        if (cursor + sizeof(T) > data.size())
+            return false;
+        std::memcpy(&out, data.data() + cursor, sizeof(T));
+        cursor += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    void WriteValue(std::vector<char>& data, const T& value)
+    {
+        const size_t offset = data.size();
+        data.resize(offset + sizeof(T));
+        std::memcpy(data.data() + offset, &value, sizeof(T));
+    }
+
+    size_t AlignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+bool ShaderArchive::Load(const std::string& path)
+{
+    Clear();
+
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+        return false; // Not packed; callers fall back to loose files
+
+    m_data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(m_data.data(), static_cast<std::streamsize>(m_data.size()));
+    if (!file)
+    {
+        ReportError("Failed to read " + path + " 0x00027000");
+        Clear();
+        return false;
+    }
+
+    size_t cursor = 0;
+    FileHeader header;
+    if (!ReadValue(m_data, cursor, header) || header.magic != FileMagic || header.version != FileVersion)
+    {
+        ReportError("Not a shader archive: " + path + " 0x00027010");
+        Clear();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.entryCount; i++)
+    {
+        uint32_t nameLength = 0;
+        if (!ReadValue(m_data, cursor, nameLength) || cursor + nameLength > m_data.size())
+        {
+            ReportError("Entry table truncated in " + path + " 0x00027020");
+            Clear();
+            return false;
+        }
+
+        std::string name(m_data.data() + cursor, nameLength);
+        cursor += nameLength;
+
+        ShaderArchiveEntry entry;
+        if (!ReadValue(m_data, cursor, entry.offset) || !ReadValue(m_data, cursor, entry.size) ||
+            !ReadValue(m_data, cursor, entry.hash))
+        {
+            ReportError("Entry table truncated in " + path + " 0x00027020");
+            Clear();
+            return false;
+        }
+
+        // Written so a corrupt offset or size cannot wrap around and pass
+        if (entry.offset % sizeof(uint32_t) != 0 || entry.size > m_data.size() ||
+            entry.offset > m_data.size() - entry.size)
+        {
+            ReportError("Entry " + name + " out of bounds in " + path + " 0x00027030");
+            Clear();
+            return false;
+        }
+
+        // A corrupt archive is rejected whole, so loose files are used instead of bad code
+        if (Hash::Fnv1a(m_data.data() + entry.offset, static_cast<size_t>(entry.size)) != entry.hash)
+        {
+            ReportError("Entry " + name + " fails its hash check in " + path + " 0x00027040");
+            Clear();
+            return false;
+        }
+
+        m_entries.emplace(std::move(name), entry);
+    }
+
+    m_path = path;
+    return true;
+}
+
+void ShaderArchive::Clear()
+{
+    m_path.clear();
+    m_data.clear();
+    m_entries.clear();
+}
+
+const ShaderArchiveEntry* ShaderArchive::Find(const std::string& name) const
+{
+    auto it = m_entries.find(name);
+    return it != m_entries.end() ? &it->second : nullptr;
+}
+
+bool ShaderArchive::Write(const std::string& path, const std::vector<ShaderArchiveFile>& files)
+{
+    // Offsets depend on the table size, so measure the table first
+    size_t tableSize = sizeof(FileHeader);
+    for (const auto& file : files)
+        tableSize += sizeof(uint32_t) + file.name.size() + 3 * sizeof(uint64_t);
+
+    std::vector<char> data;
+    data.reserve(tableSize);
+
+    FileHeader header;
+    header.magic = FileMagic;
+    header.version = FileVersion;
+    header.entryCount = static_cast<uint32_t>(files.size());
+    WriteValue(data, header);
+
+    size_t offset = AlignUp(tableSize, sizeof(uint32_t));
+    for (const auto& file : files)
+    {
+        WriteValue(data, static_cast<uint32_t>(file.name.size()));
+        data.insert(data.end(), file.name.begin(), file.name.end());
+        WriteValue(data, static_cast<uint64_t>(offset));
+        WriteValue(data, static_cast<uint64_t>(file.code.size()));
+        WriteValue(data, Hash::Fnv1a(file.code.data(), file.code.size()));
+        offset = AlignUp(offset + file.code.size(), sizeof(uint32_t));
+    }
+
+    for (const auto& file : files)
+    {
+        data.resize(AlignUp(data.size(), sizeof(uint32_t)), 0);
+        data.insert(data.end(), file.code.begin(), file.code.end());
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        ReportError("Failed to open " + path + " 0x00027100");
+        return false;
+    }
+
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!out)
+    {
+        ReportError("Failed to write " + path + " 0x00027110");
+        return false;
+    }
+
+    return true;
+}
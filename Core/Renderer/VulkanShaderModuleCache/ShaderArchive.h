@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../../DebugOutput/DubugOutput.h"
+
+// Types
+struct ShaderArchiveEntry
+{
+    uint64_t offset = 0; // From the start of the file
+    uint64_t size = 0;
+    uint64_t hash = 0;   // Of the SPIR-V bytes, checked on load
+};
+
+// Config
+struct ShaderArchiveFile
+{
+    std::string name; // Path the engine asks for, e.g. "Shaders/model.vert.spv"
+    std::vector<char> code;
+};
+
+// Every SPIR-V binary packed into one file, read with a single open at startup.
+// Layout: header, entry table (name, offset, size, hash), then the binaries, each
+// 4-byte aligned so they can be handed to vkCreateShaderModule in place.
+// Has no Vulkan dependency so the build-time packer can use it.
+class ShaderArchive
+{
+public:
+    // Lifecycle
+    bool Load(const std::string& path);
+    void Clear();
+    bool IsLoaded() const { return !m_data.empty(); }
+
+    // Lookup
+    bool Contains(const std::string& name) const { return m_entries.count(name) != 0; }
+    const ShaderArchiveEntry* Find(const std::string& name) const;
+    const char* GetData(const ShaderArchiveEntry& entry) const { return m_data.data() + entry.offset; }
+
+    // Getters
+    const std::string& GetPath() const { return m_path; }
+    size_t GetEntryCount() const { return m_entries.size(); }
+    size_t GetSize() const { return m_data.size(); }
+
+    // Packing
+    static bool Write(const std::string& path, const std::vector<ShaderArchiveFile>& files);
+
+private:
+    struct FileHeader
+    {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t entryCount = 0;
+        uint32_t reserved = 0;
+    };
+
+    static constexpr uint32_t FileMagic = 0x4B415053; // "SPAK"
+    static constexpr uint32_t FileVersion = 1;
+
+    std::string m_path;
+    std::vector<char> m_data; // Whole file; entries point into it
+    std::unordered_map<std::string, ShaderArchiveEntry> m_entries;
+
+    static const Debug::DebugOutput DebugOut;
+
+    static void ReportError(const std::string& message)
+    {
+        DebugOut.outputDebug("ShaderArchive Error: " + message);
+    }
+};
@@ -0,0 +1,240 @@
+#include "VulkanShaderModuleCache.h"
+#include "../../Math/Hash.h"
+#include <fstream>
+
+const Debug::DebugOutput VulkanShaderModuleCache::DebugOut;
+
+VulkanShaderModule::VulkanShaderModule(std::shared_ptr<VulkanDevice> device, VkShaderModule module,
+    const std::string& path, uint64_t hash, ShaderReflection reflection, bool reflected)
+    : m_device(std::move(device)), m_module(module), m_path(path), m_hash(hash),
+    m_reflection(std::move(reflection)), m_reflected(reflected)
+{}
+
+VulkanShaderModule::~VulkanShaderModule()
+{
+    if (m_module != VK_NULL_HANDLE && m_device && m_device->IsInitialized())
+        vkDestroyShaderModule(m_device->GetDevice(), m_module, nullptr);
+}
+
+VulkanShaderModuleCache::VulkanShaderModuleCache()
+{}
+
+VulkanShaderModuleCache::~VulkanShaderModuleCache()
+{
+    Cleanup();
+}
+
+bool VulkanShaderModuleCache::ValidateDependencies() const
+{
+    if (!m_instance || !m_instance->IsInitialized())
+    {
+        ReportError("Instance not initialized. 0x00027200");
+        return false;
+    }
+
+    if (!m_device || !m_device->IsInitialized())
+    {
+        ReportError("Device not initialized. 0x00027210");
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanShaderModuleCache::Initialize(
+    std::shared_ptr<VulkanInstance> instance,
+    std::shared_ptr<VulkanDevice> device)
+{
+    m_instance = instance;
+    m_device = device;
+
+    if (!ValidateDependencies())
+    {
+        Cleanup();
+        return false;
+    }
+
+    return true;
+}
+
+void VulkanShaderModuleCache::Cleanup()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_modules.clear();
+    m_archive.Clear();
+    m_stats = ShaderModuleCacheStats();
+    m_device.reset();
+    m_instance.reset();
+}
+
+bool VulkanShaderModuleCache::MountArchive(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_archive.Load(path))
+    {
+        ReportWarning("No shader archive at " + path + ", loading loose files. 0x00027220");
+        return false;
+    }
+    return true;
+}
+
+void VulkanShaderModuleCache::UnmountArchive()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_archive.Clear();
+}
+
+bool VulkanShaderModuleCache::HasArchive() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_archive.IsLoaded();
+}
+
+bool VulkanShaderModuleCache::ReadFile(const std::string& path, std::vector<char>& outCode) const
+{
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    outCode.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(outCode.data(), static_cast<std::streamsize>(outCode.size()));
+    return static_cast<bool>(file);
+}
+
+std::string VulkanShaderModuleCache::MakeKey(const std::string& path, uint64_t hash)
+{
+    return path + '#' + std::to_string(hash);
+}
+
+std::shared_ptr<VulkanShaderModule> VulkanShaderModuleCache::FindLive(const std::string& key)
+{
+    auto it = m_modules.find(key);
+    if (it == m_modules.end())
+        return nullptr;
+
+    auto module = it->second.lock();
+    if (module)
+        m_stats.hits++;
+    return module;
+}
+
+std::shared_ptr<VulkanShaderModule> VulkanShaderModuleCache::Acquire(const std::string& path)
+{
+    if (!IsInitialized())
+    {
+        ReportError("Cache not initialized. 0x00027300");
+        return nullptr;
+    }
+
+    // The lock only covers lookups; file reads, module creation and reflection run
+    // outside it so threads building different pipelines do not queue behind each other
+    std::vector<char> code;
+    uint64_t hash = 0;
+    bool fromArchive = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.requests++;
+
+        if (const ShaderArchiveEntry* entry = m_archive.Find(path))
+        {
+            hash = entry->hash; // Checked against the code when the archive was mounted
+            if (auto module = FindLive(MakeKey(path, hash)))
+                return module;
+
+            // Copied out so an unmount cannot pull the code away mid-create
+            const char* data = m_archive.GetData(*entry);
+            code.assign(data, data + entry->size);
+            m_stats.archiveLoads++;
+            fromArchive = true;
+        }
+    }
+
+    if (!fromArchive)
+    {
+        if (!ReadFile(path, code) || code.empty())
+        {
+            ReportError("Failed to read shader file: " + path + " 0x00027310");
+            return nullptr;
+        }
+
+        hash = Hash::Fnv1a(code.data(), code.size());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.fileLoads++;
+        if (auto module = FindLive(MakeKey(path, hash)))
+            return module;
+    }
+
+    if (code.size() % sizeof(uint32_t) != 0)
+    {
+        ReportError("Shader code size is not a multiple of 4: " + path + " 0x00027320");
+        return nullptr;
+    }
+
+    VkShaderModuleCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(m_device->GetDevice(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+    {
+        ReportError("Failed to create shader module: " + path + " 0x00027330");
+        return nullptr;
+    }
+
+    // Reflected while the code is at hand; every pipeline sharing the module shares the result
+    ShaderReflection reflection;
+    const bool reflected = SpirvReflector::Reflect(code.data(), code.size(), reflection);
+    if (!reflected)
+        ReportWarning("Could not reflect " + path + ", its layout must be written by hand. 0x00027340");
+
+    auto module = std::make_shared<VulkanShaderModule>(m_device, shaderModule, path, hash,
+        std::move(reflection), reflected);
+
+    const std::string key = MakeKey(path, hash);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.created++;
+
+    // Another thread may have built the same module meanwhile; adopt its copy and let ours go
+    if (auto existing = FindLive(key))
+        return existing;
+
+    m_modules[key] = module;
+
+    // Drop entries whose modules are gone so the map tracks only live ones
+    std::erase_if(m_modules, [](const auto& pair) { return pair.second.expired(); });
+
+    return module;
+}
+
+ShaderModuleCacheStats VulkanShaderModuleCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ShaderModuleCacheStats stats = m_stats;
+    for (const auto& [key, module] : m_modules)
+    {
+        if (!module.expired())
+            stats.live++;
+    }
+    return stats;
+}
+
+std::string VulkanShaderModuleCache::GetCacheInfo() const
+{
+    const ShaderModuleCacheStats stats = GetStats();
+
+    std::string output = "VulkanShaderModuleCache Info:\n";
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        output += "  Archive: " + (m_archive.IsLoaded()
+            ? m_archive.GetPath() + " (" + std::to_string(m_archive.GetEntryCount()) + " shaders)"
+            : std::string("none")) + "\n";
+    }
+    output += "  Requests: " + std::to_string(stats.requests) + ", reused: " + std::to_string(stats.hits) +
+        ", modules created: " + std::to_string(stats.created) + "\n";
+    output += "  Loaded from archive: " + std::to_string(stats.archiveLoads) +
+        ", from files: " + std::to_string(stats.fileLoads) + "\n";
+    return output;
+}
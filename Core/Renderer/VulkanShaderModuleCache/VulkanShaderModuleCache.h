@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../VulkanInstance/VulkanInstance.h"
+#include "../VulkanDevice/VulkanDevice.h"
+#include "ShaderArchive.h"
+#include "../VulkanShaderReflection/SpirvReflector.h"
+#include "../../DebugOutput/DubugOutput.h"
+
+// Types
+// One VkShaderModule, destroyed when the last pipeline holding it lets go
+class VulkanShaderModule
+{
+public:
+    VulkanShaderModule(std::shared_ptr<VulkanDevice> device, VkShaderModule module,
+        const std::string& path, uint64_t hash, ShaderReflection reflection = {}, bool reflected = false);
+    ~VulkanShaderModule();
+
+    // RAII
+    VulkanShaderModule(const VulkanShaderModule&) = delete;
+    VulkanShaderModule& operator=(const VulkanShaderModule&) = delete;
+
+    // Getters
+    VkShaderModule GetModule() const { return m_module; }
+    const std::string& GetPath() const { return m_path; }
+    uint64_t GetHash() const { return m_hash; }
+    const ShaderReflection& GetReflection() const { return m_reflection; } // Reflected once per module
+    bool IsReflected() const { return m_reflected; }
+
+private:
+    std::shared_ptr<VulkanDevice> m_device;
+    VkShaderModule m_module = VK_NULL_HANDLE;
+    std::string m_path;
+    uint64_t m_hash = 0;
+    ShaderReflection m_reflection;
+    bool m_reflected = false;
+};
+
+struct ShaderModuleCacheStats
+{
+    uint64_t requests = 0;
+    uint64_t hits = 0;          // Live module reused
+    uint64_t created = 0;       // vkCreateShaderModule calls
+    uint64_t archiveLoads = 0;  // Code taken from the mounted archive
+    uint64_t fileLoads = 0;     // Code read from a loose file
+    uint32_t live = 0;
+};
+
+// Shares shader modules between pipelines. Modules are keyed by path and content hash,
+// so a file changed on disk gets a new module while pipelines built from the old one
+// keep theirs. The cache only holds weak references; a module lives as long as some
+// pipeline does. With an archive mounted, code comes from memory instead of one file
+// open per shader. Safe to use from several threads.
+class VulkanShaderModuleCache
+{
+public:
+    VulkanShaderModuleCache();
+    ~VulkanShaderModuleCache();
+
+    // RAII
+    VulkanShaderModuleCache(const VulkanShaderModuleCache&) = delete;
+    VulkanShaderModuleCache& operator=(const VulkanShaderModuleCache&) = delete;
+
+    // Lifecycle
+    bool Initialize(std::shared_ptr<VulkanInstance> instance,
+        std::shared_ptr<VulkanDevice> device);
+    void Cleanup(); // Modules already handed out stay valid
+    bool IsInitialized() const { return m_device != nullptr; }
+
+    // Sources
+    bool MountArchive(const std::string& path); // Paths found in it are never read from disk
+    void UnmountArchive();
+
+    // Modules
+    std::shared_ptr<VulkanShaderModule> Acquire(const std::string& path);
+
+    // Getters
+    ShaderModuleCacheStats GetStats() const;
+    bool HasArchive() const;
+
+    // Debug
+    std::string GetCacheInfo() const;
+
+private:
+    std::shared_ptr<VulkanInstance> m_instance;
+    std::shared_ptr<VulkanDevice> m_device;
+
+    ShaderArchive m_archive;
+    std::unordered_map<std::string, std::weak_ptr<VulkanShaderModule>> m_modules; // path + '#' + hash
+    mutable std::mutex m_mutex;
+    ShaderModuleCacheStats m_stats;
+
+    static const Debug::DebugOutput DebugOut;
+
+    bool ValidateDependencies() const;
+    bool ReadFile(const std::string& path, std::vector<char>& outCode) const;
+    static std::string MakeKey(const std::string& path, uint64_t hash);
+    std::shared_ptr<VulkanShaderModule> FindLive(const std::string& key); // Caller holds m_mutex
+
+    void ReportError(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanShaderModuleCache Error: " + message);
+    }
+
+    void ReportWarning(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanShaderModuleCache Warning: " + message);
+    }
+};
@@ -0,0 +1,508 @@
+#include "SpirvReflector.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+const Debug::DebugOutput SpirvReflector::DebugOut;
+
+namespace
+{
+    // The handful of SPIR-V enums the reflector needs
+    constexpr uint32_t SpirvMagic = 0x07230203;
+    constexpr size_t HeaderWords = 5;
+
+    enum Op : uint32_t
+    {
+        OpName = 5,
+        OpEntryPoint = 15,
+        OpTypeInt = 21,
+        OpTypeFloat = 22,
+        OpTypeVector = 23,
+        OpTypeMatrix = 24,
+        OpTypeImage = 25,
+        OpTypeSampler = 26,
+        OpTypeSampledImage = 27,
+        OpTypeArray = 28,
+        OpTypeRuntimeArray = 29,
+        OpTypeStruct = 30,
+        OpTypePointer = 32,
+        OpConstant = 43,
+        OpFunction = 54,
+        OpVariable = 59,
+        OpDecorate = 71,
+        OpMemberDecorate = 72,
+        OpTypeAccelerationStructureKHR = 5341,
+    };
+
+    enum Decoration : uint32_t
+    {
+        DecorationSpecId = 1,
+        DecorationBlock = 2,
+        DecorationBufferBlock = 3,
+        DecorationArrayStride = 6,
+        DecorationMatrixStride = 7,
+        DecorationBuiltIn = 11,
+        DecorationLocation = 30,
+        DecorationBinding = 33,
+        DecorationDescriptorSet = 34,
+        DecorationOffset = 35,
+    };
+
+    enum StorageClass : uint32_t
+    {
+        StorageUniformConstant = 0,
+        StorageInput = 1,
+        StorageUniform = 2,
+        StoragePushConstant = 9,
+        StorageStorageBuffer = 12,
+        StoragePhysicalStorageBuffer = 5349,
+    };
+
+    enum Dim : uint32_t
+    {
+        DimBuffer = 5,
+        DimSubpassData = 6,
+    };
+
+    struct TypeInfo
+    {
+        uint32_t op = 0;
+        std::vector<uint32_t> operands; // Everything after the result id
+    };
+
+    struct Decorations
+    {
+        uint32_t set = 0;
+        uint32_t binding = 0;
+        uint32_t location = 0;
+        uint32_t arrayStride = 0;
+        bool hasBinding = false;
+        bool hasLocation = false;
+        bool builtIn = false;
+        bool block = false;
+        bool bufferBlock = false;
+    };
+
+    struct MemberDecorations
+    {
+        uint32_t offset = 0;
+        uint32_t matrixStride = 0;
+        bool builtIn = false;
+    };
+
+    struct Variable
+    {
+        uint32_t id = 0;
+        uint32_t pointerType = 0;
+        uint32_t storageClass = 0;
+    };
+
+    std::string ReadString(const uint32_t* words, size_t wordCount)
+    {
+        const char* chars = reinterpret_cast<const char*>(words);
+        return std::string(chars, strnlen(chars, wordCount * sizeof(uint32_t)));
+    }
+
+    class Module
+    {
+    public:
+        std::unordered_map<uint32_t, TypeInfo> types;
+        std::unordered_map<uint32_t, uint32_t> constants; // Id -> low 32 bits
+        std::unordered_map<uint32_t, Decorations> decorations;
+        std::unordered_map<uint32_t, std::unordered_map<uint32_t, MemberDecorations>> members;
+        std::unordered_map<uint32_t, std::string> names;
+        std::unordered_set<uint32_t> referenced; // Ids used as operands inside functions
+        std::vector<Variable> variables;
+
+        const TypeInfo* Type(uint32_t id) const
+        {
+            auto it = types.find(id);
+            return it != types.end() ? &it->second : nullptr;
+        }
+
+        const Decorations& Decor(uint32_t id) const
+        {
+            static const Decorations none;
+            auto it = decorations.find(id);
+            return it != decorations.end() ? it->second : none;
+        }
+
+        const MemberDecorations& MemberDecor(uint32_t structId, uint32_t member) const
+        {
+            static const MemberDecorations none;
+            auto structIt = members.find(structId);
+            if (structIt == members.end())
+                return none;
+            auto it = structIt->second.find(member);
+            return it != structIt->second.end() ? it->second : none;
+        }
+
+        std::string Name(uint32_t id) const
+        {
+            auto it = names.find(id);
+            return it != names.end() ? it->second : std::string();
+        }
+
+        // Strips arrays, counting elements; runtime arrays report 0
+        uint32_t Unwrap(uint32_t& typeId) const
+        {
+            uint32_t count = 1;
+            for (const TypeInfo* type = Type(typeId); type; type = Type(typeId))
+            {
+                if (type->op == OpTypeArray)
+                {
+                    auto length = constants.find(type->operands[1]);
+                    count *= length != constants.end() ? length->second : 1;
+                    typeId = type->operands[0];
+                }
+                else if (type->op == OpTypeRuntimeArray)
+                {
+                    count = 0;
+                    typeId = type->operands[0];
+                }
+                else
+                {
+                    break;
+                }
+            }
+            return count;
+        }
+
+        // Bytes the type occupies under its explicit layout decorations
+        uint32_t Size(uint32_t typeId, uint32_t matrixStride = 0) const
+        {
+            const TypeInfo* type = Type(typeId);
+            if (!type)
+                return 0;
+
+            switch (type->op)
+            {
+            case OpTypeInt:
+            case OpTypeFloat:
+                return type->operands[0] / 8;
+            case OpTypeVector:
+                return type->operands[1] * Size(type->operands[0]);
+            case OpTypeMatrix:
+                return type->operands[1] * (matrixStride ? matrixStride : Size(type->operands[0]));
+            case OpTypeArray:
+            {
+                auto length = constants.find(type->operands[1]);
+                const uint32_t count = length != constants.end() ? length->second : 1;
+                const uint32_t stride = Decor(typeId).arrayStride;
+                return count * (stride ? stride : Size(type->operands[0], matrixStride));
+            }
+            case OpTypeStruct:
+            {
+                uint32_t end = 0;
+                for (uint32_t i = 0; i < type->operands.size(); i++)
+                {
+                    const MemberDecorations& member = MemberDecor(typeId, i);
+                    end = std::max(end, member.offset + Size(type->operands[i], member.matrixStride));
+                }
+                return end;
+            }
+            case OpTypePointer:
+                return type->operands[0] == StoragePhysicalStorageBuffer ? 8 : 0;
+            default:
+                return 0;
+            }
+        }
+
+        VkDescriptorType DescriptorType(uint32_t storageClass, uint32_t typeId) const
+        {
+            const TypeInfo* type = Type(typeId);
+            if (!type)
+                return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+
+            if (storageClass == StorageStorageBuffer)
+                return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+            if (storageClass == StorageUniform)
+            {
+                if (Decor(typeId).bufferBlock)
+                    return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            }
+
+            switch (type->op)
+            {
+            case OpTypeSampler:
+                return VK_DESCRIPTOR_TYPE_SAMPLER;
+            case OpTypeSampledImage:
+                return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            case OpTypeAccelerationStructureKHR:
+                return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+            case OpTypeImage:
+            {
+                const uint32_t dim = type->operands[1];
+                const uint32_t sampled = type->operands[5];
+                if (dim == DimSubpassData)
+                    return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                if (dim == DimBuffer)
+                    return sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                return sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            }
+            default:
+                return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+            }
+        }
+
+        // 32-bit scalars and vectors only; anything else reports undefined
+        VkFormat InputFormat(uint32_t typeId) const
+        {
+            const TypeInfo* type = Type(typeId);
+            if (!type)
+                return VK_FORMAT_UNDEFINED;
+
+            uint32_t components = 1;
+            if (type->op == OpTypeVector)
+            {
+                components = type->operands[1];
+                type = Type(type->operands[0]);
+                if (!type)
+                    return VK_FORMAT_UNDEFINED;
+            }
+
+            if (type->operands[0] != 32 || components < 1 || components > 4)
+                return VK_FORMAT_UNDEFINED;
+
+            static const VkFormat floats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT,
+                VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+            static const VkFormat ints[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT,
+                VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+            static const VkFormat uints[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT,
+                VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+            if (type->op == OpTypeFloat)
+                return floats[components - 1];
+            if (type->op == OpTypeInt)
+                return type->operands[1] ? ints[components - 1] : uints[components - 1];
+            return VK_FORMAT_UNDEFINED;
+        }
+    };
+
+    VkShaderStageFlagBits StageFromExecutionModel(uint32_t model)
+    {
+        switch (model)
+        {
+        case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+        case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+        default: return VK_SHADER_STAGE_ALL;
+        }
+    }
+}
+
+bool SpirvReflector::Reflect(const char* code, size_t codeSize, ShaderReflection& out)
+{
+    out = ShaderReflection();
+
+    if (!code || codeSize % sizeof(uint32_t) != 0 || codeSize < HeaderWords * sizeof(uint32_t))
+    {
+        ReportError("Code is not a SPIR-V binary. 0x00028000");
+        return false;
+    }
+
+    // Copied so the words are aligned whatever buffer the code came from
+    std::vector<uint32_t> words(codeSize / sizeof(uint32_t));
+    std::memcpy(words.data(), code, codeSize);
+
+    if (words[0] != SpirvMagic)
+    {
+        ReportError("Bad SPIR-V magic number. 0x00028010");
+        return false;
+    }
+
+    Module module;
+    bool entryFound = false;
+    bool inFunction = false;
+
+    for (size_t cursor = HeaderWords; cursor < words.size();)
+    {
+        const uint32_t opcode = words[cursor] & 0xFFFF;
+        const uint32_t length = words[cursor] >> 16;
+        if (length == 0 || cursor + length > words.size())
+        {
+            ReportError("Truncated instruction in SPIR-V. 0x00028020");
+            return false;
+        }
+
+        const uint32_t* operands = words.data() + cursor + 1;
+        const uint32_t operandCount = length - 1;
+        cursor += length;
+
+        if (inFunction)
+        {
+            // Any id a function body mentions counts as used; good enough to drop dead resources
+            for (uint32_t i = 0; i < operandCount; i++)
+                module.referenced.insert(operands[i]);
+            continue;
+        }
+
+        switch (opcode)
+        {
+        case OpEntryPoint:
+            // Only the first entry point is reflected; the engine's shaders carry one each
+            if (!entryFound && operandCount >= 3)
+            {
+                out.stage = StageFromExecutionModel(operands[0]);
+                out.entryPoint = ReadString(operands + 2, operandCount - 2);
+                entryFound = true;
+            }
+            break;
+        case OpName:
+            if (operandCount >= 2)
+                module.names[operands[0]] = ReadString(operands + 1, operandCount - 1);
+            break;
+        case OpDecorate:
+            if (operandCount >= 2)
+            {
+                Decorations& decor = module.decorations[operands[0]];
+                const uint32_t value = operandCount >= 3 ? operands[2] : 0;
+                switch (operands[1])
+                {
+                case DecorationSpecId: out.specializationIds.push_back(value); break;
+                case DecorationBlock: decor.block = true; break;
+                case DecorationBufferBlock: decor.bufferBlock = true; break;
+                case DecorationArrayStride: decor.arrayStride = value; break;
+                case DecorationBuiltIn: decor.builtIn = true; break;
+                case DecorationLocation: decor.location = value; decor.hasLocation = true; break;
+                case DecorationBinding: decor.binding = value; decor.hasBinding = true; break;
+                case DecorationDescriptorSet: decor.set = value; break;
+                default: break;
+                }
+            }
+            break;
+        case OpMemberDecorate:
+            if (operandCount >= 3)
+            {
+                MemberDecorations& decor = module.members[operands[0]][operands[1]];
+                const uint32_t value = operandCount >= 4 ? operands[3] : 0;
+                if (operands[2] == DecorationOffset)
+                    decor.offset = value;
+                else if (operands[2] == DecorationMatrixStride)
+                    decor.matrixStride = value;
+                else if (operands[2] == DecorationBuiltIn)
+                    decor.builtIn = true;
+            }
+            break;
+        case OpTypeInt:
+        case OpTypeFloat:
+        case OpTypeVector:
+        case OpTypeMatrix:
+        case OpTypeImage:
+        case OpTypeSampler:
+        case OpTypeSampledImage:
+        case OpTypeArray:
+        case OpTypeRuntimeArray:
+        case OpTypeStruct:
+        case OpTypePointer:
+        case OpTypeAccelerationStructureKHR:
+            if (operandCount >= 1)
+                module.types[operands[0]] = { opcode, std::vector<uint32_t>(operands + 1, operands + operandCount) };
+            break;
+        case OpConstant:
+            if (operandCount >= 3)
+                module.constants[operands[1]] = operands[2];
+            break;
+        case OpVariable:
+            if (operandCount >= 3)
+                module.variables.push_back({ operands[1], operands[0], operands[2] });
+            break;
+        case OpFunction:
+            inFunction = true; // Globals all precede the first function
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (!entryFound)
+    {
+        ReportError("SPIR-V has no entry point. 0x00028030");
+        return false;
+    }
+
+    for (const Variable& variable : module.variables)
+    {
+        const TypeInfo* pointer = module.Type(variable.pointerType);
+        if (!pointer || pointer->op != OpTypePointer || pointer->operands.size() < 2)
+            continue;
+
+        uint32_t typeId = pointer->operands[1];
+        const bool used = module.referenced.count(variable.id) != 0;
+
+        switch (variable.storageClass)
+        {
+        case StorageUniformConstant:
+        case StorageUniform:
+        case StorageStorageBuffer:
+        {
+            const Decorations& decor = module.Decor(variable.id);
+            if (!decor.hasBinding || !used)
+                break;
+
+            ReflectedBinding binding;
+            binding.set = decor.set;
+            binding.binding = decor.binding;
+            binding.count = module.Unwrap(typeId);
+            binding.type = module.DescriptorType(variable.storageClass, typeId);
+            binding.name = module.Name(variable.id);
+            if (binding.name.empty())
+                binding.name = module.Name(typeId);
+
+            if (binding.type == VK_DESCRIPTOR_TYPE_MAX_ENUM)
+            {
+                ReportError("Unsupported resource type for binding " + std::to_string(binding.binding) + ". 0x00028040");
+                return false;
+            }
+
+            out.bindings.push_back(std::move(binding));
+            break;
+        }
+        case StoragePushConstant:
+            if (used)
+                out.pushConstantSize = std::max(out.pushConstantSize, module.Size(typeId));
+            break;
+        case StorageInput:
+        {
+            if (out.stage != VK_SHADER_STAGE_VERTEX_BIT)
+                break;
+
+            const Decorations& decor = module.Decor(variable.id);
+            if (decor.builtIn || !decor.hasLocation)
+                break;
+
+            ReflectedInput input;
+            input.location = decor.location;
+            input.format = module.InputFormat(typeId);
+            input.name = module.Name(variable.id);
+
+            if (input.format == VK_FORMAT_UNDEFINED)
+            {
+                ReportError("Unsupported vertex input type at location " + std::to_string(input.location) + ". 0x00028050");
+                return false;
+            }
+
+            out.inputs.push_back(std::move(input));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    std::sort(out.bindings.begin(), out.bindings.end(), [](const ReflectedBinding& a, const ReflectedBinding& b) {
+        return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+    });
+    std::sort(out.specializationIds.begin(), out.specializationIds.end());
+    std::sort(out.inputs.begin(), out.inputs.end(), [](const ReflectedInput& a, const ReflectedInput& b) {
+        return a.location < b.location;
+    });
+
+    return true;
+}
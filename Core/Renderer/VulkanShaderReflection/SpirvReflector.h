@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../DebugOutput/DubugOutput.h"
+
+// Types
+struct ReflectedBinding
+{
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+    uint32_t count = 1;    // 0 for runtime-sized arrays
+    std::string name;
+};
+
+struct ReflectedInput
+{
+    uint32_t location = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    std::string name;
+};
+
+struct ShaderReflection
+{
+    VkShaderStageFlagBits stage = VK_SHADER_STAGE_ALL;
+    std::string entryPoint;
+    std::vector<ReflectedBinding> bindings; // Sorted by set, then binding
+    std::vector<ReflectedInput> inputs;     // Vertex stage only, sorted by location
+    uint32_t pushConstantSize = 0;          // Bytes the push block reaches; 0 without one
+    std::vector<uint32_t> specializationIds; // constant_id values the module declares, sorted
+};
+
+// Reads what a pipeline layout needs straight from SPIR-V: descriptor bindings, the
+// push constant block and vertex inputs. Covers the subset of the spec glslang emits
+// for this engine's shaders. Resources the entry point never touches are left out,
+// so a layout built from the result holds no unused bindings.
+// Has no Vulkan device dependency; only the enums come from vulkan.h.
+class SpirvReflector
+{
+public:
+    static bool Reflect(const char* code, size_t codeSize, ShaderReflection& out);
+
+private:
+    static const Debug::DebugOutput DebugOut;
+
+    static void ReportError(const std::string& message)
+    {
+        DebugOut.outputDebug("SpirvReflector Error: " + message);
+    }
+};
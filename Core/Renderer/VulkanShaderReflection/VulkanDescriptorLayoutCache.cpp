@@ -0,0 +1,299 @@
+#include "VulkanDescriptorLayoutCache.h"
+#include <algorithm>
+
+const Debug::DebugOutput VulkanDescriptorLayoutCache::DebugOut;
+
+VulkanDescriptorLayoutCache::VulkanDescriptorLayoutCache()
+{}
+
+VulkanDescriptorLayoutCache::~VulkanDescriptorLayoutCache()
+{
+    Cleanup();
+}
+
+bool VulkanDescriptorLayoutCache::ValidateDependencies() const
+{
+    if (!m_instance || !m_instance->IsInitialized())
+    {
+        ReportError("Instance not initialized. 0x00028100");
+        return false;
+    }
+
+    if (!m_device || !m_device->IsInitialized())
+    {
+        ReportError("Device not initialized. 0x00028110");
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanDescriptorLayoutCache::Initialize(
+    std::shared_ptr<VulkanInstance> instance,
+    std::shared_ptr<VulkanDevice> device)
+{
+    m_instance = instance;
+    m_device = device;
+
+    if (!ValidateDependencies())
+    {
+        Cleanup();
+        return false;
+    }
+
+    return true;
+}
+
+void VulkanDescriptorLayoutCache::Cleanup()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_device && m_device->IsInitialized())
+    {
+        for (auto& [key, layout] : m_layouts)
+            vkDestroyDescriptorSetLayout(m_device->GetDevice(), layout, nullptr);
+    }
+
+    m_layouts.clear();
+    m_stats = DescriptorLayoutCacheStats();
+    m_device.reset();
+    m_instance.reset();
+}
+
+std::string VulkanDescriptorLayoutCache::MakeKey(const std::vector<DescriptorBinding>& bindings)
+{
+    // Fields are written one by one so struct padding never reaches the key
+    std::string key;
+    for (const auto& binding : bindings)
+    {
+        const uint32_t fields[] = { binding.binding, static_cast<uint32_t>(binding.type), binding.stages, binding.count };
+        key.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+    }
+    return key;
+}
+
+VkDescriptorSetLayout VulkanDescriptorLayoutCache::Acquire(const std::vector<DescriptorBinding>& bindings)
+{
+    if (!IsInitialized())
+    {
+        ReportError("Cache not initialized. 0x00028200");
+        return VK_NULL_HANDLE;
+    }
+
+    // Binding order does not change the layout, so sort before keying
+    std::vector<DescriptorBinding> sorted = bindings;
+    std::sort(sorted.begin(), sorted.end(), [](const DescriptorBinding& a, const DescriptorBinding& b) {
+        return a.binding < b.binding;
+    });
+
+    const std::string key = MakeKey(sorted);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.requests++;
+
+    auto it = m_layouts.find(key);
+    if (it != m_layouts.end())
+    {
+        m_stats.hits++;
+        return it->second;
+    }
+
+    std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+    layoutBindings.reserve(sorted.size());
+    for (const auto& binding : sorted)
+    {
+        VkDescriptorSetLayoutBinding layoutBinding = {};
+        layoutBinding.binding = binding.binding;
+        layoutBinding.descriptorType = binding.type;
+        layoutBinding.descriptorCount = binding.count;
+        layoutBinding.stageFlags = binding.stages;
+        layoutBinding.pImmutableSamplers = nullptr;
+        layoutBindings.push_back(layoutBinding);
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
+    layoutInfo.pBindings = layoutBindings.empty() ? nullptr : layoutBindings.data();
+
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    if (vkCreateDescriptorSetLayout(m_device->GetDevice(), &layoutInfo, nullptr, &layout) != VK_SUCCESS)
+    {
+        ReportError("Failed to create descriptor set layout. 0x00028210");
+        return VK_NULL_HANDLE;
+    }
+
+    m_layouts.emplace(key, layout);
+    m_stats.layouts = static_cast<uint32_t>(m_layouts.size());
+    return layout;
+}
+
+bool VulkanDescriptorLayoutCache::Reflect(
+    const std::vector<std::shared_ptr<VulkanShaderModule>>& modules,
+    const std::vector<DescriptorTypeOverride>& overrides,
+    ReflectedPipelineLayout& outLayout)
+{
+    outLayout = ReflectedPipelineLayout();
+
+    VkShaderStageFlags pushStages = 0;
+    uint32_t pushSize = 0;
+
+    for (const auto& module : modules)
+    {
+        if (!module || !module->IsReflected())
+        {
+            ReportError("Shader " + (module ? module->GetPath() : std::string("(null)")) + " has no reflection. 0x00028300");
+            return false;
+        }
+
+        const ShaderReflection& reflection = module->GetReflection();
+
+        for (const ReflectedBinding& reflected : reflection.bindings)
+        {
+            if (reflected.count == 0)
+            {
+                ReportError("Runtime-sized array " + reflected.name + " in " + module->GetPath() +
+                    " needs a hand-written layout. 0x00028310");
+                return false;
+            }
+
+            if (outLayout.sets.size() <= reflected.set)
+                outLayout.sets.resize(reflected.set + 1);
+
+            // A binding seen in several stages becomes one binding visible to all of them
+            auto& set = outLayout.sets[reflected.set];
+            auto existing = std::find_if(set.begin(), set.end(),
+                [&](const DescriptorBinding& binding) { return binding.binding == reflected.binding; });
+
+            if (existing == set.end())
+            {
+                set.push_back({ reflected.binding, reflected.type, static_cast<VkShaderStageFlags>(reflection.stage), reflected.count });
+                continue;
+            }
+
+            if (existing->type != reflected.type)
+            {
+                ReportError("Set " + std::to_string(reflected.set) + " binding " + std::to_string(reflected.binding) +
+                    " has different types across stages. 0x00028320");
+                return false;
+            }
+
+            existing->stages |= reflection.stage;
+            existing->count = std::max(existing->count, reflected.count);
+        }
+
+        if (reflection.pushConstantSize > 0)
+        {
+            pushStages |= reflection.stage;
+            pushSize = std::max(pushSize, reflection.pushConstantSize);
+        }
+
+        if (reflection.stage == VK_SHADER_STAGE_VERTEX_BIT)
+            outLayout.vertexInputs = reflection.inputs;
+    }
+
+    for (const DescriptorTypeOverride& typeOverride : overrides)
+    {
+        DescriptorBinding* target = nullptr;
+        if (typeOverride.set < outLayout.sets.size())
+        {
+            for (auto& binding : outLayout.sets[typeOverride.set])
+            {
+                if (binding.binding == typeOverride.binding)
+                    target = &binding;
+            }
+        }
+
+        if (!target)
+        {
+            ReportWarning("Override for set " + std::to_string(typeOverride.set) + " binding " +
+                std::to_string(typeOverride.binding) + " matches no used binding. 0x00028330");
+            continue;
+        }
+
+        const bool uniform = target->type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER &&
+            typeOverride.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        const bool storage = target->type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER &&
+            typeOverride.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        if (!uniform && !storage)
+        {
+            ReportError("Override for set " + std::to_string(typeOverride.set) + " binding " +
+                std::to_string(typeOverride.binding) + " does not match the shader's type. 0x00028340");
+            return false;
+        }
+
+        target->type = typeOverride.type;
+    }
+
+    // Sets the shaders skip still need a layout, so they get an empty one
+    for (const auto& set : outLayout.sets)
+    {
+        VkDescriptorSetLayout layout = Acquire(set);
+        if (layout == VK_NULL_HANDLE)
+            return false;
+        outLayout.setLayouts.push_back(layout);
+    }
+
+    // One range for every stage that declares the block, so a single push updates them all
+    if (pushSize > 0)
+    {
+        VkPushConstantRange range = {};
+        range.stageFlags = pushStages;
+        range.offset = 0;
+        range.size = (pushSize + 3) & ~3u;
+        outLayout.pushConstantRanges.push_back(range);
+    }
+
+    return true;
+}
+
+bool VulkanDescriptorLayoutCache::MatchVertexInput(const ReflectedPipelineLayout& layout, VertexInputDescription& inOutInput)
+{
+    std::vector<VkVertexInputAttributeDescription> attributes;
+
+    for (const ReflectedInput& input : layout.vertexInputs)
+    {
+        auto attribute = std::find_if(inOutInput.attributes.begin(), inOutInput.attributes.end(),
+            [&](const VkVertexInputAttributeDescription& a) { return a.location == input.location; });
+
+        if (attribute == inOutInput.attributes.end())
+        {
+            ReportError("Vertex shader reads location " + std::to_string(input.location) +
+                " (" + input.name + ") but no attribute feeds it. 0x00028400");
+            return false;
+        }
+
+        if (attribute->format != input.format)
+        {
+            ReportError("Attribute at location " + std::to_string(input.location) +
+                " does not match the shader's format. 0x00028410");
+            return false;
+        }
+
+        attributes.push_back(*attribute);
+    }
+
+    // Vertex buffers no remaining attribute reads from are dropped as well
+    std::erase_if(inOutInput.bindings, [&](const VkVertexInputBindingDescription& binding) {
+        return std::none_of(attributes.begin(), attributes.end(),
+            [&](const VkVertexInputAttributeDescription& a) { return a.binding == binding.binding; });
+    });
+
+    inOutInput.attributes = std::move(attributes);
+    return true;
+}
+
+DescriptorLayoutCacheStats VulkanDescriptorLayoutCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::string VulkanDescriptorLayoutCache::GetCacheInfo() const
+{
+    const DescriptorLayoutCacheStats stats = GetStats();
+
+    std::string output = "VulkanDescriptorLayoutCache Info:\n";
+    output += "  Set layouts: " + std::to_string(stats.layouts) + "\n";
+    output += "  Requests: " + std::to_string(stats.requests) + ", shared: " + std::to_string(stats.hits) + "\n";
+    return output;
+}
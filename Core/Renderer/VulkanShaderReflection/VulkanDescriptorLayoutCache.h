@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../VulkanInstance/VulkanInstance.h"
+#include "../VulkanDevice/VulkanDevice.h"
+#include "../VulkanDescriptor/VulkanDescriptor.h"
+#include "../VulkanGraphicsPipeline/VulkanGraphicsPipeline.h"
+#include "../VulkanShaderModuleCache/VulkanShaderModuleCache.h"
+#include "../../DebugOutput/DubugOutput.h"
+
+// Config
+// SPIR-V cannot tell a dynamic buffer from a plain one; callers name the bindings they offset
+struct DescriptorTypeOverride
+{
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+};
+
+// Types
+// Everything a pipeline layout needs, merged across the stages of one pipeline
+struct ReflectedPipelineLayout
+{
+    std::vector<std::vector<DescriptorBinding>> sets; // Indexed by set number
+    std::vector<VkDescriptorSetLayout> setLayouts;    // Shared; owned by the cache
+    std::vector<VkPushConstantRange> pushConstantRanges;
+    std::vector<ReflectedInput> vertexInputs;
+};
+
+struct DescriptorLayoutCacheStats
+{
+    uint64_t requests = 0;
+    uint64_t hits = 0;   // Layout already existed
+    uint32_t layouts = 0;
+};
+
+// Builds pipeline layouts from reflected shaders and shares the descriptor set layouts
+// they need. Layouts with identical bindings are created once, so pipelines and the
+// descriptor sets bound to them end up with the same handle. Layouts live until Cleanup.
+class VulkanDescriptorLayoutCache
+{
+public:
+    VulkanDescriptorLayoutCache();
+    ~VulkanDescriptorLayoutCache();
+
+    // RAII
+    VulkanDescriptorLayoutCache(const VulkanDescriptorLayoutCache&) = delete;
+    VulkanDescriptorLayoutCache& operator=(const VulkanDescriptorLayoutCache&) = delete;
+
+    // Lifecycle
+    bool Initialize(std::shared_ptr<VulkanInstance> instance,
+        std::shared_ptr<VulkanDevice> device);
+    void Cleanup(); // Pipelines and descriptors using the layouts must be gone
+    bool IsInitialized() const { return m_device != nullptr; }
+
+    // Layouts
+    VkDescriptorSetLayout Acquire(const std::vector<DescriptorBinding>& bindings);
+    bool Reflect(const std::vector<std::shared_ptr<VulkanShaderModule>>& modules,
+        const std::vector<DescriptorTypeOverride>& overrides,
+        ReflectedPipelineLayout& outLayout);
+
+    // Vertex input
+    // Keeps the attributes the vertex shader reads and checks their formats against it
+    static bool MatchVertexInput(const ReflectedPipelineLayout& layout, VertexInputDescription& inOutInput);
+
+    // Getters
+    DescriptorLayoutCacheStats GetStats() const;
+
+    // Debug
+    std::string GetCacheInfo() const;
+
+private:
+    std::shared_ptr<VulkanInstance> m_instance;
+    std::shared_ptr<VulkanDevice> m_device;
+
+    std::unordered_map<std::string, VkDescriptorSetLayout> m_layouts; // Keyed by serialized bindings
+    mutable std::mutex m_mutex;
+    DescriptorLayoutCacheStats m_stats;
+
+    static const Debug::DebugOutput DebugOut;
+
+    bool ValidateDependencies() const;
+    static std::string MakeKey(const std::vector<DescriptorBinding>& bindings);
+
+    static void ReportError(const std::string& message)
+    {
+        DebugOut.outputDebug("VulkanDescriptorLayoutCache Error: " + message);
+    }
+
+    static void ReportWarning(const std::string& message)
+    {
+        DebugOut.outputDebug("VulkanDescriptorLayoutCache Warning: " + message);
+    }
+};
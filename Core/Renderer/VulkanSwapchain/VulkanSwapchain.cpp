@@ -55,6 +55,7 @@ void VulkanSwapchain::Cleanup()
     m_colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
     m_presentMode = VK_PRESENT_MODE_FIFO_KHR;
     m_imageCount = 0;
+    m_outOfDate = false;
 
     m_instance.reset();
     m_device.reset();
@@ -286,12 +287,14 @@ bool VulkanSwapchain::CreateSwapchain(VkSwapchainKHR oldSwapchain)
             createInfo.pQueueFamilyIndices = nullptr;
         }
 
-        VkResult result = vkCreateSwapchainKHR(m_device->GetDevice(), &createInfo, nullptr, &m_swapchain);
+        VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+        VkResult result = vkCreateSwapchainKHR(m_device->GetDevice(), &createInfo, nullptr, &swapchain);
         if (result != VK_SUCCESS)
         {
             ReportError("Failed to create Swapchain. 0x00AF5200");
             return false;
         }
+        m_swapchain = swapchain;
 
         uint32_t acutalImageCount = 0;
 
@@ -397,8 +400,8 @@ bool VulkanSwapchain::AcquireNextImage(
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR)
     {
-        // Swapchain is out of date (window resized), caller must recreate. <-Important for later
-        ReportWarning("Swapchain out of date. 0x00005505");
+        // Swapchain is out of date (window resized), caller must recreate
+        m_outOfDate = true;
         return false;
     }
     else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
@@ -407,6 +410,10 @@ bool VulkanSwapchain::AcquireNextImage(
         return false;
     }
 
+    // Suboptimal still acquired an image; render it and recreate afterwards
+    if (result == VK_SUBOPTIMAL_KHR)
+        m_outOfDate = true;
+
     return true;
 }
 
@@ -437,13 +444,13 @@ bool VulkanSwapchain::PresentImage(
 
     VkResult result = vkQueuePresentKHR(m_device->GetPresentQueue(), &presentInfo);
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
     {
-        ReportWarning("Swapchain out of date. 0x00005620");
-        return false;
+        m_outOfDate = true;
+        return result == VK_SUBOPTIMAL_KHR; // Suboptimal still presented
     }
 
-    else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+    else if (result != VK_SUCCESS)
     {
         ReportError("Failed to present image. 0x00005630");
         return false;
@@ -457,18 +464,37 @@ bool VulkanSwapchain::Recreate(uint32_t width, uint32_t height)
     // Note: width and height are ignored - CreateSwapchain queries surface automatically
     // They're here for API clarity (user knows they're recreating for a new size)
 
+    if (!IsInitialized())
+    {
+        ReportError("Swapchain not initialized. 0x00005710");
+        return false;
+    }
+
+    // A minimized window reports a zero extent; keep the old swapchain until it has area again
+    VkSurfaceCapabilitiesKHR capabilities = m_surface->GetCapabilities();
+    if (capabilities.currentExtent.width == 0 || capabilities.currentExtent.height == 0)
+        return false;
+
     m_device->WaitIdle();
 
     VkSwapchainKHR oldSwapchain = m_swapchain;
 
     DestroyImageViews();
+    m_images.clear();
+
+    const bool created = CreateSwapchain(oldSwapchain);
 
-    if (!CreateSwapchain(oldSwapchain))
+    // The old swapchain is retired either way once passed as oldSwapchain
+    vkDestroySwapchainKHR(m_device->GetDevice(), oldSwapchain, nullptr);
+    if (!created)
     {
+        if (m_swapchain == oldSwapchain)
+            m_swapchain = VK_NULL_HANDLE;
         ReportError("Failed to recreate swapchain. 0x00005700");
         return false;
     }
 
+    m_outOfDate = false;
     return true;
 }
 
@@ -48,8 +48,9 @@ public:
     bool IsInitialized() const { return m_swapchain != VK_NULL_HANDLE; }
 
     // Recreate
-    bool Recreate(uint32_t width, uint32_t height);
+    bool Recreate(uint32_t width, uint32_t height); // False while the surface has no area (minimized)
     bool Recreate();
+    bool IsOutOfDate() const { return m_outOfDate; } // Set by acquire/present, cleared by Recreate
 
     // Acquire/Present
     bool AcquireNextImage(uint32_t& outImageIndex, VkSemaphore signalSemaphore,
@@ -90,6 +91,7 @@ private:
     VkColorSpaceKHR m_colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
     VkPresentModeKHR m_presentMode = VK_PRESENT_MODE_FIFO_KHR;
     uint32_t m_imageCount = 0;
+    bool m_outOfDate = false;
 
     // Images
     std::vector<SwapchainImage> m_images;
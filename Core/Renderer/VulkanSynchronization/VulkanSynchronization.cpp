@@ -6,28 +6,16 @@ VulkanSynchronization::VulkanSynchronization(){}
 
 void VulkanSynchronization::Cleanup()
 {
-	if (!m_frameSyncObjects.empty() && m_device && m_device->IsInitialized())
-	{
-		for (auto& frameSyncObject : m_frameSyncObjects)
-		{
-			if (frameSyncObject.IsValid())
-			{
-				vkDestroyFence(m_device->GetDevice(), frameSyncObject.inFlightFence, nullptr);
-			}
-		}
-	}
-
-    if (!m_imageSyncObjects.empty() && m_device && m_device->IsInitialized())
-    {
-        for (auto& imageSyncObject : m_imageSyncObjects)
-        {
-            if (imageSyncObject.IsValid())
-            {
-                vkDestroySemaphore(m_device->GetDevice(), imageSyncObject.renderFinishedSemaphore, nullptr);
-                vkDestroySemaphore(m_device->GetDevice(), imageSyncObject.imageAvailableSemaphore, nullptr);
-            }
-        }
-    }
+	DestroySyncObjects(m_frameSyncObjects);
+    DestroyImageSyncObjects(m_imageSyncObjects);
+
+    if (m_timeline != VK_NULL_HANDLE && m_device && m_device->IsInitialized())
+        vkDestroySemaphore(m_device->GetDevice(), m_timeline, nullptr);
+
+    m_timeline = VK_NULL_HANDLE;
+    m_lastSignaled = 0;
+    m_completedValue = 0;
+    m_frameValues.clear();
 
 	m_instance.reset();
 	m_device.reset();
@@ -69,22 +57,40 @@ bool VulkanSynchronization::ValidateDependencies() const
     return true;
 }
 
-bool VulkanSynchronization::CreateSyncObjects(uint32_t count)
+// Builds into outObjects and destroys only what it created on failure, so the device,
+// the timeline and the current objects survive a failed resize
+bool VulkanSynchronization::CreateSyncObjects(uint32_t count, std::vector<FrameSyncObjects>& outObjects) const
 {
-    m_frameSyncObjects.resize(count);
+    outObjects.assign(count, FrameSyncObjects{});
 
     VkFenceCreateInfo fenceInfo = {};
     fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
     for (uint32_t i = 0; i < count; i++)
     {
-       VkResult result = vkCreateFence(m_device->GetDevice(), &fenceInfo, nullptr,
-            &m_frameSyncObjects[i].inFlightFence);
+        VkResult result = vkCreateSemaphore(m_device->GetDevice(), &semaphoreInfo, nullptr,
+            &outObjects[i].imageAvailableSemaphore);
+        if (result != VK_SUCCESS)
+        {
+            ReportError("Failed to create imageAvailable semaphore. 0x0000A100");
+            DestroySyncObjects(outObjects);
+            return false;
+        }
+
+        // Timeline mode paces frames with semaphore values instead
+        if (IsTimelineEnabled())
+            continue;
+
+        result = vkCreateFence(m_device->GetDevice(), &fenceInfo, nullptr,
+            &outObjects[i].inFlightFence);
         if (result != VK_SUCCESS)
         {
             ReportError("Failed to create fence. 0x0000A120");
-            Cleanup();
+            DestroySyncObjects(outObjects);
             return false;
         }
     }
@@ -92,10 +98,99 @@ bool VulkanSynchronization::CreateSyncObjects(uint32_t count)
     return true;
 }
 
+void VulkanSynchronization::DestroySyncObjects(std::vector<FrameSyncObjects>& objects) const
+{
+    if (m_device && m_device->IsInitialized())
+    {
+        for (auto& frameSyncObject : objects)
+        {
+            if (frameSyncObject.inFlightFence != VK_NULL_HANDLE)
+                vkDestroyFence(m_device->GetDevice(), frameSyncObject.inFlightFence, nullptr);
+
+            if (frameSyncObject.imageAvailableSemaphore != VK_NULL_HANDLE)
+                vkDestroySemaphore(m_device->GetDevice(), frameSyncObject.imageAvailableSemaphore, nullptr);
+        }
+    }
+
+    objects.clear();
+}
+
+bool VulkanSynchronization::SetFramesInFlight(uint32_t count)
+{
+    if (!IsInitialized())
+    {
+        ReportError("Synchronization not initialized. 0x0000A700");
+        return false;
+    }
+
+    if (count == 0 || count > MaxFramesInFlightLimit)
+    {
+        ReportError("Frames in flight must be between 1 and " + std::to_string(MaxFramesInFlightLimit) + ". 0x0000A710");
+        return false;
+    }
+
+    if (count == GetMaxFramesInFlight())
+        return true;
+
+    std::vector<FrameSyncObjects> frameSyncObjects;
+    if (!CreateSyncObjects(count, frameSyncObjects))
+        return false;
+
+    DestroySyncObjects(m_frameSyncObjects);
+    m_frameSyncObjects = std::move(frameSyncObjects);
+
+    if (IsTimelineEnabled())
+        m_frameValues.assign(count, m_lastSignaled.load(std::memory_order_acquire));
+
+    return true;
+}
+
+bool VulkanSynchronization::SetImageCount(uint32_t count)
+{
+    if (!IsInitialized())
+    {
+        ReportError("Synchronization not initialized. 0x0000A720");
+        return false;
+    }
+
+    if (count == 0)
+    {
+        ReportError("Image count cannot be zero. 0x0000A730");
+        return false;
+    }
+
+    if (count == GetImageCount())
+        return true;
+
+    std::vector<ImageSyncObjects> imageSyncObjects;
+    if (!CreateImageSyncObjects(count, imageSyncObjects))
+        return false;
+
+    DestroyImageSyncObjects(m_imageSyncObjects);
+    m_imageSyncObjects = std::move(imageSyncObjects);
+    return true;
+}
+
+void VulkanSynchronization::DestroyImageSyncObjects(std::vector<ImageSyncObjects>& objects) const
+{
+    if (m_device && m_device->IsInitialized())
+    {
+        for (auto& imageSyncObject : objects)
+        {
+            if (imageSyncObject.IsValid())
+            {
+                vkDestroySemaphore(m_device->GetDevice(), imageSyncObject.renderFinishedSemaphore, nullptr);
+            }
+        }
+    }
+
+    objects.clear();
+}
+
 
-bool VulkanSynchronization::CreateImageSyncObjects(uint32_t count)
+bool VulkanSynchronization::CreateImageSyncObjects(uint32_t count, std::vector<ImageSyncObjects>& outObjects) const
 {
-    m_imageSyncObjects.resize(count);
+    outObjects.assign(count, ImageSyncObjects{});
 
     VkSemaphoreCreateInfo semaphoreInfo = {};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -103,20 +198,11 @@ bool VulkanSynchronization::CreateImageSyncObjects(uint32_t count)
     for (uint32_t i = 0; i < count; i++)
     {
         VkResult result = vkCreateSemaphore(m_device->GetDevice(), &semaphoreInfo, nullptr,
-            &m_imageSyncObjects[i].imageAvailableSemaphore);
-        if (result != VK_SUCCESS)
-        {
-            ReportError("Failed to create imageAvailable semaphore. 0x0000A100");
-            Cleanup();
-            return false;
-        }
-
-        result = vkCreateSemaphore(m_device->GetDevice(), &semaphoreInfo, nullptr,
-            &m_imageSyncObjects[i].renderFinishedSemaphore);
+            &outObjects[i].renderFinishedSemaphore);
         if (result != VK_SUCCESS)
         {
             ReportError("Failed to create renderFinished semaphore. 0x0000A110");
-            Cleanup();
+            DestroyImageSyncObjects(outObjects);
             return false;
         }
     }
@@ -125,11 +211,36 @@ bool VulkanSynchronization::CreateImageSyncObjects(uint32_t count)
 }
 
 
+bool VulkanSynchronization::CreateTimeline()
+{
+    VkSemaphoreTypeCreateInfo typeInfo = {};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    VkResult result = vkCreateSemaphore(m_device->GetDevice(), &semaphoreInfo, nullptr, &m_timeline);
+    if (result != VK_SUCCESS)
+    {
+        ReportError("Failed to create timeline semaphore. 0x0000A130");
+        m_timeline = VK_NULL_HANDLE;
+        return false;
+    }
+
+    m_lastSignaled = 0;
+    m_completedValue = 0;
+    return true;
+}
+
 bool VulkanSynchronization::Initialize(
     std::shared_ptr<VulkanInstance> instance,
     std::shared_ptr<VulkanDevice> device,
     uint32_t maxFramesInFlight,
-    uint32_t imageCount)
+    uint32_t imageCount,
+    bool useTimeline)
 {
     try
     {
@@ -141,19 +252,33 @@ bool VulkanSynchronization::Initialize(
             return false;
         }
 
-        if (maxFramesInFlight == 0)
+        if (maxFramesInFlight == 0 || maxFramesInFlight > MaxFramesInFlightLimit)
         {
-            ReportError("Max frames in flight cannot be zero. 0x0000A210");
+            ReportError("Max frames in flight must be between 1 and " + std::to_string(MaxFramesInFlightLimit) + ". 0x0000A210");
             return false;
         }
 
-        if (!CreateSyncObjects(maxFramesInFlight))
+        if (useTimeline && !m_device->IsTimelineSemaphoreEnabled())
+        {
+            ReportWarning("Timeline semaphores unsupported, using fences. 0x0000A215");
+            useTimeline = false;
+        }
+
+        if (useTimeline && !CreateTimeline())
+            return false;
+
+        if (!CreateSyncObjects(maxFramesInFlight, m_frameSyncObjects))
         {
+            Cleanup();
             return false;
         }
 
-        if (!CreateImageSyncObjects(imageCount))
+        if (IsTimelineEnabled())
+            m_frameValues.assign(maxFramesInFlight, m_lastSignaled.load(std::memory_order_acquire));
+
+        if (!CreateImageSyncObjects(imageCount, m_imageSyncObjects))
         {
+            Cleanup();
             return false; 
         }
 
@@ -179,6 +304,9 @@ bool VulkanSynchronization::WaitForFence(uint32_t frameIndex, uint64_t timeout)
         return false;
     }
 
+    if (IsTimelineEnabled())
+        return WaitForValue(m_frameValues[frameIndex], timeout);
+
     VkResult result = vkWaitForFences(m_device->GetDevice(), 1,
         &m_frameSyncObjects[frameIndex].inFlightFence,
         VK_TRUE, timeout);
@@ -199,6 +327,9 @@ bool VulkanSynchronization::ResetFence(uint32_t frameIndex)
         return false;
     }
 
+    if (IsTimelineEnabled())
+        return true; // Values only grow; nothing to reset
+
     VkResult result = vkResetFences(m_device->GetDevice(), 1,
         &m_frameSyncObjects[frameIndex].inFlightFence);
     if (result != VK_SUCCESS)
@@ -210,6 +341,84 @@ bool VulkanSynchronization::ResetFence(uint32_t frameIndex)
     return true;
 }
 
+TimelineSignal VulkanSynchronization::SignalNext()
+{
+    if (!IsTimelineEnabled())
+        return {};
+
+    TimelineSignal signal;
+    signal.semaphore = m_timeline;
+    signal.value = m_lastSignaled.fetch_add(1, std::memory_order_acq_rel) + 1;
+    return signal;
+}
+
+TimelineSignal VulkanSynchronization::SignalFrame(uint32_t frameIndex)
+{
+    if (frameIndex >= m_frameValues.size())
+    {
+        ReportError("Frame index out of bounds. 0x0000A600");
+        return {};
+    }
+
+    TimelineSignal signal = SignalNext();
+    m_frameValues[frameIndex] = signal.value;
+    return signal;
+}
+
+uint64_t VulkanSynchronization::GetCompletedValue() const
+{
+    if (!IsTimelineEnabled())
+        return 0;
+
+    uint64_t value = 0;
+    if (vkGetSemaphoreCounterValue(m_device->GetDevice(), m_timeline, &value) != VK_SUCCESS)
+    {
+        ReportError("Failed to read timeline value. 0x0000A610");
+        return m_completedValue.load(std::memory_order_acquire);
+    }
+
+    ObserveCompleted(value);
+    return value;
+}
+
+bool VulkanSynchronization::WaitForValue(uint64_t value, uint64_t timeout) const
+{
+    if (!IsTimelineEnabled())
+    {
+        ReportError("Timeline not enabled. 0x0000A620");
+        return false;
+    }
+
+    // Cheap early out; also covers value 0 (nothing submitted yet)
+    if (value <= m_completedValue.load(std::memory_order_acquire))
+        return true;
+
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_timeline;
+    waitInfo.pValues = &value;
+
+    VkResult result = vkWaitSemaphores(m_device->GetDevice(), &waitInfo, timeout);
+    if (result != VK_SUCCESS)
+    {
+        ReportError("Failed to wait for timeline value. 0x0000A630");
+        return false;
+    }
+
+    ObserveCompleted(value);
+    return true;
+}
+
+void VulkanSynchronization::ObserveCompleted(uint64_t value) const
+{
+    // Callers on different threads may race; the cached value must never move backwards
+    uint64_t completed = m_completedValue.load(std::memory_order_acquire);
+    while (completed < value && !m_completedValue.compare_exchange_weak(completed, value, std::memory_order_acq_rel))
+    {
+    }
+}
+
 const FrameSyncObjects& VulkanSynchronization::GetFrameSync(uint32_t frameIndex) const
 {
     static const FrameSyncObjects invalidSync;  
@@ -245,6 +454,10 @@ std::string VulkanSynchronization::GetSyncInfo() const
     std::string info = "VulkanSynchronization Info:\n";
 
     info += "  Max Frames in flight: " + std::to_string(m_frameSyncObjects.size()) + "\n";
+    info += "  Mode: " + std::string(IsTimelineEnabled() ? "timeline" : "fences") + "\n";
+
+    if (IsTimelineEnabled())
+        info += "  Timeline: " + std::to_string(GetCompletedValue()) + " / " + std::to_string(GetLastSignaledValue()) + "\n";
 
 
     return info;
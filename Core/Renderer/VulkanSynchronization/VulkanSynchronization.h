@@ -4,35 +4,48 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <atomic>
 #include "../VulkanInstance/VulkanInstance.h"
 #include "../VulkanDevice/VulkanDevice.h"
 #include "../../DebugOutput/DubugOutput.h"
 
 // Types
+// Acquire is signaled before the image index is known, so its semaphore belongs to the frame slot.
 struct FrameSyncObjects
 {
-    VkFence inFlightFence = VK_NULL_HANDLE;
+    VkFence inFlightFence = VK_NULL_HANDLE; // Null in timeline mode
+    VkSemaphore imageAvailableSemaphore = VK_NULL_HANDLE;
 
     bool IsValid() const
     {
-        return inFlightFence != VK_NULL_HANDLE;
+        return imageAvailableSemaphore != VK_NULL_HANDLE;
     }
 };
 
+// Present waits until the image is shown again, so its semaphore belongs to the swapchain image.
 struct ImageSyncObjects
 {
-    VkSemaphore imageAvailableSemaphore = VK_NULL_HANDLE;
     VkSemaphore renderFinishedSemaphore = VK_NULL_HANDLE;
     bool IsValid() const
     {
-        return imageAvailableSemaphore != VK_NULL_HANDLE &&
-            renderFinishedSemaphore != VK_NULL_HANDLE;
+        return renderFinishedSemaphore != VK_NULL_HANDLE;
     }
 };
 
+// Timeline value a submission signals in addition to its binary semaphores
+struct TimelineSignal
+{
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    uint64_t value = 0;
+
+    bool IsValid() const { return semaphore != VK_NULL_HANDLE; }
+};
+
 class VulkanSynchronization
 {
 public:
+    static constexpr uint32_t MaxFramesInFlightLimit = 4;
+
     VulkanSynchronization();
     ~VulkanSynchronization();
 
@@ -46,19 +59,43 @@ public:
     bool Initialize(std::shared_ptr<VulkanInstance> instance,
         std::shared_ptr<VulkanDevice> device,
         uint32_t maxFramesInFlight = 2,
-        uint32_t imageCount = 2);
+        uint32_t imageCount = 2,
+        bool useTimeline = false); // Falls back to fences without the timelineSemaphore feature
     void Cleanup();
     bool IsInitialized() const { return !m_frameSyncObjects.empty(); }
 
+    // Frames in flight
+    // Rebuilds the per-frame objects; the device must be idle. The timeline keeps its value,
+    // and on failure the current objects are left untouched.
+    bool SetFramesInFlight(uint32_t count);
+
+    // Swapchain images
+    // Rebuilds the per-image semaphores after a swapchain recreate; the device must be idle.
+    // On failure the current semaphores are left untouched.
+    bool SetImageCount(uint32_t count);
+    uint32_t GetImageCount() const { return static_cast<uint32_t>(m_imageSyncObjects.size()); }
+
     // Access
     const FrameSyncObjects& GetFrameSync(uint32_t frameIndex) const;
     uint32_t GetMaxFramesInFlight() const { return static_cast<uint32_t>(m_frameSyncObjects.size()); }
     const ImageSyncObjects& GetImageSync(uint32_t imageIndex) const;
 
     // Fences
+    // In timeline mode these wait for the value the frame slot last signaled; there are no fences.
     bool WaitForFence(uint32_t frameIndex, uint64_t timeout = UINT64_MAX);
     bool ResetFence(uint32_t frameIndex);
 
+    // Timeline
+    // Every tracked submission signals the next value, so reaching N means every
+    // tracked submission up to N has finished on the GPU.
+    bool IsTimelineEnabled() const { return m_timeline != VK_NULL_HANDLE; }
+    VkSemaphore GetTimelineSemaphore() const { return m_timeline; }
+    TimelineSignal SignalNext();                     // Reserve a value; submit in reservation order
+    TimelineSignal SignalFrame(uint32_t frameIndex); // Also what WaitForFence(frameIndex) waits on
+    uint64_t GetLastSignaledValue() const { return m_lastSignaled.load(std::memory_order_acquire); }
+    uint64_t GetCompletedValue() const;
+    bool WaitForValue(uint64_t value, uint64_t timeout = UINT64_MAX) const;
+
     // Debug
     std::string GetSyncInfo() const;
 
@@ -68,11 +105,21 @@ private:
     std::vector<FrameSyncObjects> m_frameSyncObjects;
     std::vector<ImageSyncObjects> m_imageSyncObjects;
 
+    // Timeline
+    VkSemaphore m_timeline = VK_NULL_HANDLE;
+    std::atomic<uint64_t> m_lastSignaled = 0;
+    mutable std::atomic<uint64_t> m_completedValue = 0;
+    std::vector<uint64_t> m_frameValues;
+
     static const Debug::DebugOutput DebugOut;
 
     bool ValidateDependencies() const;
-    bool CreateSyncObjects(uint32_t count);
-    bool CreateImageSyncObjects(uint32_t count);
+    bool CreateSyncObjects(uint32_t count, std::vector<FrameSyncObjects>& outObjects) const;
+    void DestroySyncObjects(std::vector<FrameSyncObjects>& objects) const;
+    bool CreateImageSyncObjects(uint32_t count, std::vector<ImageSyncObjects>& outObjects) const;
+    void DestroyImageSyncObjects(std::vector<ImageSyncObjects>& objects) const;
+    bool CreateTimeline();
+    void ObserveCompleted(uint64_t value) const;
 
     void ReportError(const std::string& message) const
     {
@@ -0,0 +1,385 @@
+#include "VulkanTransientAllocator.h"
+#include "../VulkanImage/BarrierBatch.h"
+#include <algorithm>
+#include <numeric>
+
+const Debug::DebugOutput VulkanTransientAllocator::DebugOut;
+
+VulkanTransientAllocator::VulkanTransientAllocator()
+{}
+
+VulkanTransientAllocator::~VulkanTransientAllocator()
+{
+    Cleanup();
+}
+
+bool VulkanTransientAllocator::ValidateDependencies() const
+{
+    if (!m_instance || !m_instance->IsInitialized())
+    {
+        ReportError("Instance not initialized. 0x00021000");
+        return false;
+    }
+
+    if (!m_device || !m_device->IsInitialized())
+    {
+        ReportError("Device not initialized. 0x00021010");
+        return false;
+    }
+
+    if (!m_allocator || !m_allocator->IsInitialized())
+    {
+        ReportError("Memory allocator not initialized. 0x00021020");
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanTransientAllocator::Initialize(
+    std::shared_ptr<VulkanInstance> instance,
+    std::shared_ptr<VulkanDevice> device,
+    std::shared_ptr<VulkanMemoryAllocator> allocator)
+{
+    try
+    {
+        m_instance = instance;
+        m_device = device;
+        m_allocator = allocator;
+
+        if (!ValidateDependencies())
+        {
+            m_instance.reset();
+            m_device.reset();
+            m_allocator.reset();
+            return false;
+        }
+
+        const VkPhysicalDeviceMemoryProperties* memProps = nullptr;
+        vmaGetMemoryProperties(m_allocator->GetAllocator(), &memProps);
+
+        m_hasLazyMemory = false;
+        for (uint32_t type = 0; type < memProps->memoryTypeCount; ++type)
+        {
+            if (memProps->memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+            {
+                m_hasLazyMemory = true;
+                break;
+            }
+        }
+
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        ReportError("Exception during initialization: " + std::string(e.what()) + ". 0x00021030");
+        return false;
+    }
+    catch (...)
+    {
+        ReportError("Unknown exception during initialization. 0x00021040");
+        return false;
+    }
+}
+
+void VulkanTransientAllocator::Cleanup()
+{
+    Reset();
+
+    m_allocator.reset();
+    m_device.reset();
+    m_instance.reset();
+    m_hasLazyMemory = false;
+}
+
+uint32_t VulkanTransientAllocator::AddImage(const TransientImageDesc& desc)
+{
+    if (m_built)
+        ReportWarning("AddImage after Build; call Reset and Build again. 0x00021100");
+
+    m_descs.push_back(desc);
+    return static_cast<uint32_t>(m_descs.size() - 1);
+}
+
+void VulkanTransientAllocator::Reset()
+{
+    ReleaseResources();
+    m_descs.clear();
+    m_built = false;
+}
+
+void VulkanTransientAllocator::ReleaseResources()
+{
+    if (m_device && m_device->IsInitialized())
+    {
+        VkDevice device = m_device->GetDevice();
+
+        for (auto& image : m_images)
+        {
+            if (image.view != VK_NULL_HANDLE)
+                vkDestroyImageView(device, image.view, nullptr);
+            if (image.image.image != VK_NULL_HANDLE)
+                vkDestroyImage(device, image.image.image, nullptr);
+        }
+    }
+
+    if (m_allocator && m_allocator->IsInitialized())
+    {
+        for (auto& slot : m_slots)
+        {
+            if (slot.allocation == VK_NULL_HANDLE)
+                continue;
+
+            m_allocator->UntrackAllocation(MemoryUsageTag::RenderTarget, slot.requirements.size);
+            vmaFreeMemory(m_allocator->GetAllocator(), slot.allocation);
+        }
+    }
+
+    m_images.clear();
+    m_slots.clear();
+    m_stats = {};
+}
+
+bool VulkanTransientAllocator::Build()
+{
+    if (!IsInitialized() || !ValidateDependencies())
+        return false;
+
+    if (m_built)
+    {
+        ReportWarning("Already built. 0x00021200");
+        return true;
+    }
+
+    std::vector<VkMemoryRequirements> requirements;
+    if (!CreateImages(requirements))
+    {
+        ReleaseResources();
+        return false;
+    }
+
+    AssignSlots(requirements);
+
+    for (auto& slot : m_slots)
+    {
+        if (!AllocateSlot(slot))
+        {
+            ReleaseResources();
+            return false;
+        }
+    }
+
+    if (!BindAndCreateViews())
+    {
+        ReleaseResources();
+        return false;
+    }
+
+    m_stats.imageCount = static_cast<uint32_t>(m_images.size());
+    m_stats.slotCount = static_cast<uint32_t>(m_slots.size());
+    m_built = true;
+
+    DebugOut.outputDebug("VulkanTransientAllocator: " + std::to_string(m_stats.imageCount) + " images in " +
+        std::to_string(m_stats.slotCount) + " slots, " +
+        std::to_string(m_stats.allocatedBytes / (1024 * 1024)) + " MB of " +
+        std::to_string(m_stats.requestedBytes / (1024 * 1024)) + " MB requested (" +
+        std::to_string(m_stats.lazyBytes / (1024 * 1024)) + " MB lazy).");
+
+    return true;
+}
+
+bool VulkanTransientAllocator::CreateImages(std::vector<VkMemoryRequirements>& outRequirements)
+{
+    VkDevice device = m_device->GetDevice();
+
+    m_images.resize(m_descs.size());
+    outRequirements.resize(m_descs.size());
+
+    for (size_t i = 0; i < m_descs.size(); ++i)
+    {
+        TransientImageDesc& desc = m_descs[i];
+
+        if (desc.width == 0 || desc.height == 0 || desc.format == VK_FORMAT_UNDEFINED)
+        {
+            ReportError("Invalid transient image '" + desc.name + "'. 0x00021300");
+            return false;
+        }
+
+        // TRANSIENT_ATTACHMENT is only legal next to attachment usage
+        const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
+            VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        if (desc.IsTransientAttachment() && (desc.usage & ~attachmentUsage))
+        {
+            ReportWarning("'" + desc.name + "' is not attachment-only; dropping TRANSIENT usage. 0x00021305");
+            desc.usage &= ~VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        }
+
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = { desc.width, desc.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = desc.format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = desc.usage;
+        imageInfo.samples = desc.samples;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        TransientImage& image = m_images[i];
+        if (vkCreateImage(device, &imageInfo, nullptr, &image.image.image) != VK_SUCCESS)
+        {
+            ReportError("Failed to create transient image '" + desc.name + "'. 0x00021310");
+            return false;
+        }
+
+        vkGetImageMemoryRequirements(device, image.image.image, &outRequirements[i]);
+        m_stats.requestedBytes += outRequirements[i].size;
+
+        image.image.extent = imageInfo.extent;
+        image.image.format = desc.format;
+        image.image.mipLevels = 1;
+        image.image.arrayLayers = 1;
+        image.image.usage = desc.usage;
+        image.image.tag = MemoryUsageTag::RenderTarget;
+    }
+
+    return true;
+}
+
+void VulkanTransientAllocator::AssignSlots(const std::vector<VkMemoryRequirements>& requirements)
+{
+    // Largest first so small targets fill the gaps left in big slots
+    std::vector<uint32_t> order(m_descs.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return requirements[a].size > requirements[b].size;
+    });
+
+    for (uint32_t index : order)
+    {
+        const TransientImageDesc& desc = m_descs[index];
+        const VkMemoryRequirements& req = requirements[index];
+        MemorySlot* target = nullptr;
+
+        for (auto& slot : m_slots)
+        {
+            if (slot.transient != desc.IsTransientAttachment())
+                continue;
+
+            if ((slot.requirements.memoryTypeBits & req.memoryTypeBits) == 0)
+                continue;
+
+            const bool overlaps = std::any_of(slot.images.begin(), slot.images.end(),
+                [&](uint32_t other) { return m_descs[other].Overlaps(desc); });
+
+            if (!overlaps)
+            {
+                target = &slot;
+                break;
+            }
+        }
+
+        if (!target)
+        {
+            m_slots.emplace_back();
+            target = &m_slots.back();
+            target->requirements = req;
+            target->transient = desc.IsTransientAttachment();
+        }
+        else
+        {
+            target->requirements.size = std::max(target->requirements.size, req.size);
+            target->requirements.alignment = std::max(target->requirements.alignment, req.alignment);
+            target->requirements.memoryTypeBits &= req.memoryTypeBits;
+        }
+
+        target->images.push_back(index);
+        m_images[index].slot = static_cast<uint32_t>(target - m_slots.data());
+    }
+}
+
+bool VulkanTransientAllocator::AllocateSlot(MemorySlot& slot)
+{
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    allocInfo.priority = 1.0f;
+
+    VmaAllocationInfo info = {};
+    VkResult result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    bool lazy = false;
+
+    if (slot.transient && m_hasLazyMemory)
+    {
+        VmaAllocationCreateInfo lazyInfo = {};
+        lazyInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+        lazyInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+        result = vmaAllocateMemory(m_allocator->GetAllocator(), &slot.requirements, &lazyInfo, &slot.allocation, &info);
+        lazy = result == VK_SUCCESS;
+    }
+
+    if (!lazy)
+        result = vmaAllocateMemory(m_allocator->GetAllocator(), &slot.requirements, &allocInfo, &slot.allocation, &info);
+
+    if (result != VK_SUCCESS)
+    {
+        slot.allocation = VK_NULL_HANDLE;
+        ReportError("Failed to allocate transient memory slot. 0x00021400");
+        return false;
+    }
+
+    vmaSetAllocationName(m_allocator->GetAllocator(), slot.allocation, lazy ? "transient (lazy)" : "transient");
+
+    m_allocator->TrackAllocation(MemoryUsageTag::RenderTarget, slot.requirements.size);
+    m_stats.allocatedBytes += slot.requirements.size;
+    if (lazy)
+        m_stats.lazyBytes += slot.requirements.size;
+
+    for (uint32_t index : slot.images)
+    {
+        m_images[index].image.allocation = slot.allocation;
+        m_images[index].image.allocationInfo = info;
+    }
+
+    return true;
+}
+
+bool VulkanTransientAllocator::BindAndCreateViews()
+{
+    VkDevice device = m_device->GetDevice();
+
+    for (size_t i = 0; i < m_images.size(); ++i)
+    {
+        TransientImage& image = m_images[i];
+        const MemorySlot& slot = m_slots[image.slot];
+
+        if (vmaBindImageMemory(m_allocator->GetAllocator(), slot.allocation, image.image.image) != VK_SUCCESS)
+        {
+            ReportError("Failed to bind transient image '" + m_descs[i].name + "'. 0x00021500");
+            return false;
+        }
+
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image.image.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = image.image.format;
+        viewInfo.subresourceRange.aspectMask = BarrierBatch::AspectFromFormat(image.image.format);
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &viewInfo, nullptr, &image.view) != VK_SUCCESS)
+        {
+            ReportError("Failed to create view for '" + m_descs[i].name + "'. 0x00021510");
+            return false;
+        }
+    }
+
+    return true;
+}
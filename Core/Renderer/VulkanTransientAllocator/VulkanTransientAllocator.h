@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include "../VulkanInstance/VulkanInstance.h"
+#include "../VulkanDevice/VulkanDevice.h"
+#include "../VulkanMemoryAllocator/VulkanMemoryAllocator.h"
+#include "../../DebugOutput/DubugOutput.h"
+
+// Config
+// Lifetimes are inclusive pass indices within one frame. Requests whose lifetimes
+// do not overlap may share memory, so their first use must not expect old contents
+// (initialLayout UNDEFINED, loadOp CLEAR/DONT_CARE). Images used by different frames
+// in flight run concurrently and keep the default whole-frame lifetime.
+struct TransientImageDesc
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkImageUsageFlags usage = 0;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    uint32_t firstPass = 0;
+    uint32_t lastPass = UINT32_MAX;
+    std::string name;
+
+    // Attachment only: never sampled, copied or stored, so it may live in lazily allocated memory
+    static TransientImageDesc Depth(uint32_t width, uint32_t height, VkFormat format)
+    {
+        TransientImageDesc desc;
+        desc.width = width;
+        desc.height = height;
+        desc.format = format;
+        desc.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        desc.name = "depth";
+        return desc;
+    }
+
+    static TransientImageDesc Color(uint32_t width, uint32_t height, VkFormat format)
+    {
+        TransientImageDesc desc;
+        desc.width = width;
+        desc.height = height;
+        desc.format = format;
+        desc.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        desc.name = "color";
+        return desc;
+    }
+
+    bool IsTransientAttachment() const { return (usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0; }
+    bool Overlaps(const TransientImageDesc& other) const
+    {
+        return firstPass <= other.lastPass && other.firstPass <= lastPass;
+    }
+};
+
+// Types
+struct TransientImage
+{
+    AllocatedImage image; // Memory belongs to the slot; never pass to VulkanImage::DestroyImage
+    VkImageView view = VK_NULL_HANDLE;
+    uint32_t slot = 0;
+
+    bool IsValid() const { return image.image != VK_NULL_HANDLE && view != VK_NULL_HANDLE; }
+};
+
+struct TransientAllocatorStats
+{
+    VkDeviceSize requestedBytes = 0; // Sum of every image's requirements
+    VkDeviceSize allocatedBytes = 0; // After aliasing
+    VkDeviceSize lazyBytes = 0;      // Backed by LAZILY_ALLOCATED memory (often never committed)
+    uint32_t imageCount = 0;
+    uint32_t slotCount = 0;
+};
+
+class VulkanTransientAllocator
+{
+public:
+    VulkanTransientAllocator();
+    ~VulkanTransientAllocator();
+
+    // RAII
+    VulkanTransientAllocator(const VulkanTransientAllocator&) = delete;
+    VulkanTransientAllocator& operator=(const VulkanTransientAllocator&) = delete;
+
+    // Lifecycle
+    bool Initialize(std::shared_ptr<VulkanInstance> instance,
+        std::shared_ptr<VulkanDevice> device,
+        std::shared_ptr<VulkanMemoryAllocator> allocator);
+    void Cleanup();
+    bool IsInitialized() const { return m_allocator != nullptr; }
+
+    // Declaration
+    uint32_t AddImage(const TransientImageDesc& desc); // Returns a handle for GetImage
+    bool Build();  // Creates images and aliased memory for everything added since Reset
+    void Reset();  // Destroys images, memory and requests; the caller makes sure the GPU is done with them
+
+    // Getters
+    const TransientImage& GetImage(uint32_t handle) const { return m_images[handle]; }
+    VkImageView GetView(uint32_t handle) const { return m_images[handle].view; }
+    uint32_t GetImageCount() const { return static_cast<uint32_t>(m_images.size()); }
+    const TransientAllocatorStats& GetStats() const { return m_stats; }
+    bool HasLazyMemory() const { return m_hasLazyMemory; }
+
+private:
+    struct MemorySlot
+    {
+        VkMemoryRequirements requirements = {};
+        bool transient = false;
+        std::vector<uint32_t> images;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+    };
+
+    std::shared_ptr<VulkanInstance> m_instance;
+    std::shared_ptr<VulkanDevice> m_device;
+    std::shared_ptr<VulkanMemoryAllocator> m_allocator;
+
+    std::vector<TransientImageDesc> m_descs;
+    std::vector<TransientImage> m_images;
+    std::vector<MemorySlot> m_slots;
+    TransientAllocatorStats m_stats;
+    bool m_hasLazyMemory = false;
+    bool m_built = false;
+
+    static const Debug::DebugOutput DebugOut;
+
+    bool ValidateDependencies() const;
+    void ReleaseResources();
+    bool CreateImages(std::vector<VkMemoryRequirements>& outRequirements);
+    void AssignSlots(const std::vector<VkMemoryRequirements>& requirements);
+    bool AllocateSlot(MemorySlot& slot);
+    bool BindAndCreateViews();
+
+    void ReportError(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanTransientAllocator Error: " + message);
+    }
+
+    void ReportWarning(const std::string& message) const
+    {
+        DebugOut.outputDebug("VulkanTransientAllocator Warning: " + message);
+    }
+};
@@ -119,7 +119,7 @@ bool TextureManager::IsInitialized() const
 
 void TextureManager::Cleanup()
 {
-    std::lock_guard<std::mutex> lock(mux_lock);
+    DisableDefragmentation();
 
     UnloadAllTextures();
 
@@ -157,7 +157,7 @@ std::shared_ptr<Texture> TextureManager::CreateTextureFromPixels(
     imageOpts.width = width;
     imageOpts.height = height;
     imageOpts.format = VK_FORMAT_R8G8B8A8_SRGB;
-    imageOpts.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageOpts.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
     imageOpts.mipLevels = 1;
 
     TextureInfo& info = const_cast<TextureInfo&>(texture->GetInfo());
@@ -196,6 +196,7 @@ std::shared_ptr<Texture> TextureManager::CreateTextureFromPixels(
         return nullptr;
     }
 
+    RegisterMovable(texture);
     return texture;
 }
 
@@ -279,6 +280,8 @@ bool TextureManager::LoadTexture(const std::string& path)
 
     std::println("Successfully loaded path : {} (Maybe resolved path)", foundLocation); 
 
+    RegisterMovable(temp);
+
     {
         std::lock_guard<std::mutex> lock(mux_lock);
         m_textureCache[path] = temp;
@@ -368,6 +371,8 @@ std::shared_ptr<Texture> TextureManager::GetTexture(
         return m_whiteTexture;
     }
 
+    RegisterMovable(texture);
+
     {
         std::lock_guard<std::mutex> lock(mux_lock);
         m_textureCache[filepath] = texture;
@@ -383,19 +388,32 @@ void TextureManager::UnloadTexture(const std::string& filepath)
         return;
     }
 
-    std::lock_guard<std::mutex> lock(mux_lock);
-
-    auto it = m_textureCache.find(filepath);
-    if (it != m_textureCache.end())
+    // Destroying reaches the allocator, which may report a move back into this manager,
+    // so the texture leaves the map under the lock and is destroyed after it
+    std::shared_ptr<Texture> texture;
     {
+        std::lock_guard<std::mutex> lock(mux_lock);
+        auto it = m_textureCache.find(filepath);
+        if (it == m_textureCache.end())
+            return;
+
+        texture = std::move(it->second);
         m_textureCache.erase(it);
     }
+
+    // Last owner: hand the GPU objects to the deletion queue instead of stalling
+    if (texture.use_count() == 1)
+        texture->DeferDestroy();
 }
 
 void TextureManager::UnloadAllTextures()
 {
-    std::lock_guard<std::mutex> lock(mux_lock);
-    m_textureCache.clear();
+    std::unordered_map<std::string, std::shared_ptr<Texture>> unloaded;
+    {
+        std::lock_guard<std::mutex> lock(mux_lock);
+        unloaded.swap(m_textureCache);
+    }
+    // Released here, outside the lock, for the same reason as UnloadTexture
 }
 
 bool TextureManager::IsTextureCached(const std::string& filepath) const
@@ -435,3 +453,105 @@ std::string TextureManager::GetTextureManagerInfo() const
 
     return info;
 }
+
+bool TextureManager::EnableDefragmentation(VulkanMemoryAllocator* allocator, TextureMovedCallback onTextureMoved)
+{
+    if (!IsInitialized())
+    {
+        ReportError("Cannot enable defragmentation before initialization. 0x0000E600");
+        return false;
+    }
+
+    if (!allocator || !allocator->IsInitialized())
+    {
+        ReportError("Allocator not initialized. 0x0000E610");
+        return false;
+    }
+
+    DisableDefragmentation();
+
+    m_allocator = allocator;
+    m_onTextureMoved = std::move(onTextureMoved);
+    m_defragListenerId = m_allocator->AddDefragmentationListener(
+        [this](const DefragmentationMove& move) { OnAllocationMoved(move); });
+
+    std::vector<std::shared_ptr<Texture>> textures;
+    {
+        std::lock_guard<std::mutex> lock(mux_lock);
+        for (const auto& [path, texture] : m_textureCache)
+            textures.push_back(texture);
+    }
+
+    for (const auto& texture : textures)
+        RegisterMovable(texture);
+
+    return true;
+}
+
+void TextureManager::DisableDefragmentation()
+{
+    if (!m_allocator)
+        return;
+
+    m_allocator->RemoveDefragmentationListener(m_defragListenerId);
+
+    std::vector<VmaAllocation> allocations;
+    {
+        std::lock_guard<std::mutex> lock(mux_lock);
+        for (const auto& [allocation, texture] : m_movableTextures)
+        {
+            if (!texture.expired())
+                allocations.push_back(allocation);
+        }
+        m_movableTextures.clear();
+    }
+
+    for (VmaAllocation allocation : allocations)
+        m_allocator->ForgetMovable(allocation);
+
+    m_allocator = nullptr;
+    m_defragListenerId = 0;
+    m_onTextureMoved = nullptr;
+}
+
+void TextureManager::RegisterMovable(const std::shared_ptr<Texture>& texture)
+{
+    if (!m_allocator || !texture)
+        return;
+
+    TextureInfo& info = const_cast<TextureInfo&>(texture->GetInfo());
+    if (!m_allocator->RegisterMovable(&info.image))
+        return;
+
+    // Moves are matched by allocation, which survives the move, so textures that left
+    // the cache but are still held elsewhere get their views rebuilt too
+    std::lock_guard<std::mutex> lock(mux_lock);
+    std::erase_if(m_movableTextures, [](const auto& entry) { return entry.second.expired(); });
+    m_movableTextures[info.image.allocation] = texture;
+}
+
+void TextureManager::OnAllocationMoved(const DefragmentationMove& move)
+{
+    if (!move.image)
+        return;
+
+    std::shared_ptr<Texture> moved;
+    {
+        std::lock_guard<std::mutex> lock(mux_lock);
+        auto it = m_movableTextures.find(move.image->allocation);
+        if (it != m_movableTextures.end())
+            moved = it->second.lock(); // Null while its last owner is destroying it
+    }
+
+    if (!moved)
+        return;
+
+    if (!moved->RecreateView())
+    {
+        ReportError("Failed to rebuild view for moved texture. 0x0000E620");
+        return;
+    }
+
+    if (m_onTextureMoved)
+        m_onTextureMoved(moved);
+}
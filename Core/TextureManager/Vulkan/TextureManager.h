@@ -4,6 +4,7 @@
 #include <string>
 #include <unordered_map>
 #include <mutex>
+#include <functional>
 #include "../../Renderer/TextureLoader/Texture.h"
 #include "../../Renderer/VulkanImage/VulkanImage.h"
 #include "../../Renderer/VulkanImageView/VulkanImageView.h"
@@ -52,6 +53,11 @@ public:
     bool IsTextureCached(const std::string& filepath) const;
     size_t GetLoadedTextureCount() const;
 
+    // Defragmentation
+    using TextureMovedCallback = std::function<void(const std::shared_ptr<Texture>&)>;
+    bool EnableDefragmentation(VulkanMemoryAllocator* allocator, TextureMovedCallback onTextureMoved = {});
+    void DisableDefragmentation();
+
     TextureManagerStats GetStats() const;
     std::string GetTextureManagerInfo() const;
 
@@ -69,6 +75,12 @@ private:
 
     std::mutex mutable mux_lock;
 
+    VulkanMemoryAllocator* m_allocator = nullptr;
+    uint32_t m_defragListenerId = 0;
+    TextureMovedCallback m_onTextureMoved;
+    // Every texture registered as movable, cached or not; keyed by allocation
+    std::unordered_map<VmaAllocation, std::weak_ptr<Texture>> m_movableTextures;
+
     static const Debug::DebugOutput DebugOut;
 
     bool CreateDefaultTextures();
@@ -78,6 +90,9 @@ private:
         uint32_t width,
         uint32_t height);
 
+    void RegisterMovable(const std::shared_ptr<Texture>& texture);
+    void OnAllocationMoved(const DefragmentationMove& move);
+
     bool ValidateDependenices() const; 
 
     void ReportError(const std::string& message) const {
@@ -9,19 +9,31 @@ layout(location = 0) out vec4 outColor;
 
 layout(binding = 1) uniform sampler2D texSampler;
 
+// Specialization constants; each combination is its own pipeline variant,
+// so the branches a variant turns off are compiled out.
+layout(constant_id = 0) const bool USE_TEXTURE = true;    // Off for materials without a diffuse map
+layout(constant_id = 1) const bool USE_LIGHTING = true;
+layout(constant_id = 2) const bool ALPHA_TEST = false;
+layout(constant_id = 3) const float ALPHA_CUTOFF = 0.5;
+
 layout(push_constant) uniform PushConstants {
     mat4 model;
     vec3 light;
 } push;
 
 void main() {
-    vec3 light = push.light - fragWorldPos;
-    float brightness = dot(normalize(fragWorldNormal), normalize(light)); 
-    brightness = max(0.0, brightness) + 0.15;
-    
-    vec3 texColor = texture(texSampler, fragTexCoord).rgb;
+    vec4 texel = USE_TEXTURE ? texture(texSampler, fragTexCoord) : vec4(1.0);
+    if (ALPHA_TEST && texel.a < ALPHA_CUTOFF)
+        discard;
+
+    float brightness = 1.0;
+    if (USE_LIGHTING) {
+        vec3 light = push.light - fragWorldPos;
+        brightness = dot(normalize(fragWorldNormal), normalize(light)); 
+        brightness = max(0.0, brightness) + 0.15;
+    }
     
-    vec3 litColor = texColor * brightness;
+    vec3 litColor = texel.rgb * brightness;
 
     outColor = vec4(litColor, 1.0);
 }
\ No newline at end of file
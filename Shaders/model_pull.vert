@@ -0,0 +1,62 @@
+#version 460
+#extension GL_EXT_buffer_reference : require
+
+// Same outputs as model.vert, but vertices are fetched from a buffer device
+// address instead of fixed-function vertex input. See VertexPulling.h.
+
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer VertexData {
+    float v[];
+};
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragWorldNormal;
+layout(location = 2) out vec3 fragWorldPos;
+layout(location = 3) out vec2 fragTexCoord;
+
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+    vec3 light;
+    uint stride;
+    VertexData vertices;
+    uint position;
+    uint normal;
+    uint texCoord;
+    uint color;
+} push;
+
+layout(binding = 0) uniform CameraUBO {
+    mat4 view;
+    mat4 projection;
+} camera;
+
+const uint MISSING = 0xFFFFFFFFu;
+
+vec3 FetchVec3(uint base, uint offset, vec3 fallback) {
+    if (offset == MISSING)
+        return fallback;
+    uint i = base + offset;
+    return vec3(push.vertices.v[i], push.vertices.v[i + 1], push.vertices.v[i + 2]);
+}
+
+vec2 FetchVec2(uint base, uint offset, vec2 fallback) {
+    if (offset == MISSING)
+        return fallback;
+    uint i = base + offset;
+    return vec2(push.vertices.v[i], push.vertices.v[i + 1]);
+}
+
+void main() {
+    uint base = uint(gl_VertexIndex) * push.stride;
+
+    vec3 inPosition = FetchVec3(base, push.position, vec3(0.0));
+    vec3 inNormal = FetchVec3(base, push.normal, vec3(0.0, 0.0, 1.0));
+    vec2 inTexCoord = FetchVec2(base, push.texCoord, vec2(0.0));
+    vec3 inColor = FetchVec3(base, push.color, vec3(1.0));
+
+    vec4 world =  push.model * vec4(inPosition, 1.0);
+    fragWorldPos = world.xyz;
+    gl_Position = camera.projection * camera.view * world;
+    fragWorldNormal = normalize(mat3(transpose(inverse(push.model))) * inNormal);
+    fragColor = inColor;
+    fragTexCoord = inTexCoord;
+}
@@ -0,0 +1,281 @@
+#include "../Core/Renderer/VulkanRenderGraph/VulkanRenderGraph.h"
+#include <cstdio>
+
+// Builds render graphs without a device and checks what Compile() derives from them:
+// which passes are culled, each resource's lifetime and every barrier and layout
+// transition. Returns non-zero when a check fails, for CTest.
+
+static int s_failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) \
+        { \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static bool Matches(const RenderGraphBarrier& barrier, uint32_t resource,
+    VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkPipelineStageFlags srcStages, VkAccessFlags srcAccess,
+    VkPipelineStageFlags dstStages, VkAccessFlags dstAccess)
+{
+    return barrier.resource == resource &&
+        barrier.oldLayout == oldLayout && barrier.newLayout == newLayout &&
+        barrier.srcStages == srcStages && barrier.srcAccess == srcAccess &&
+        barrier.dstStages == dstStages && barrier.dstAccess == dstAccess;
+}
+
+// gbuffer -> (debug, never read) -> lighting -> bloom -> ui, presenting the backbuffer
+static void TestDeferredFrame()
+{
+    constexpr VkPipelineStageFlags Color = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    constexpr VkPipelineStageFlags Depth = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    constexpr VkPipelineStageFlags Fragment = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    constexpr VkPipelineStageFlags Compute = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    constexpr VkAccessFlags ColorAccess = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    constexpr VkAccessFlags DepthAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    VulkanRenderGraph graph;
+
+    const uint32_t backbuffer = graph.ImportImage(RenderGraphImportDesc::Backbuffer(VK_FORMAT_B8G8R8A8_UNORM));
+    const uint32_t depth = graph.ImportImage(RenderGraphImportDesc::Scratch(VK_FORMAT_D32_SFLOAT, "depth"));
+    const uint32_t gbuffer = graph.CreateImage(RenderGraphImageDesc::Make("gbuffer", 64, 64, VK_FORMAT_R16G16B16A16_SFLOAT));
+    const uint32_t debug = graph.CreateImage(RenderGraphImageDesc::Make("debug", 64, 64, VK_FORMAT_R8G8B8A8_UNORM));
+    const uint32_t bloom = graph.CreateImage(RenderGraphImageDesc::Make("bloom", 32, 32, VK_FORMAT_R16G16B16A16_SFLOAT));
+
+    graph.AddPass("gbuffer")
+        .Write(gbuffer, RenderGraphUsage::ColorAttachment)
+        .Write(depth, RenderGraphUsage::DepthAttachment);
+    graph.AddPass("debug")
+        .Write(debug, RenderGraphUsage::ColorAttachment);
+    graph.AddPass("lighting")
+        .Read(gbuffer, RenderGraphUsage::Sampled)
+        .Write(backbuffer, RenderGraphUsage::ColorAttachment);
+    graph.AddPass("bloom")
+        .Write(bloom, RenderGraphUsage::ComputeWrite);
+    graph.AddPass("ui")
+        .Read(bloom, RenderGraphUsage::Sampled)
+        .Write(backbuffer, RenderGraphUsage::ColorAttachment);
+
+    CHECK(graph.Compile());
+    CHECK(graph.IsCompiled());
+    CHECK(!graph.IsInitialized());
+
+    // Culling: nothing reaches an output from "debug"
+    CHECK(graph.GetPassCount() == 5);
+    CHECK(!graph.IsPassCulled(0));
+    CHECK(graph.IsPassCulled(1));
+    CHECK(!graph.IsPassCulled(2));
+    CHECK(!graph.IsPassCulled(3));
+    CHECK(!graph.IsPassCulled(4));
+
+    const auto& passes = graph.GetCompiledPasses();
+    CHECK(passes.size() == 4);
+    if (passes.size() != 4)
+        return;
+
+    CHECK(passes[0].pass == 0);
+    CHECK(passes[1].pass == 2);
+    CHECK(passes[2].pass == 3);
+    CHECK(passes[3].pass == 4);
+
+    // Lifetimes, in compiled pass order
+    CHECK(graph.GetFirstPass(gbuffer) == 0 && graph.GetLastPass(gbuffer) == 1);
+    CHECK(graph.GetFirstPass(depth) == 0 && graph.GetLastPass(depth) == 0);
+    CHECK(graph.GetFirstPass(backbuffer) == 1 && graph.GetLastPass(backbuffer) == 3);
+    CHECK(graph.GetFirstPass(bloom) == 2 && graph.GetLastPass(bloom) == 3);
+    CHECK(graph.GetFirstPass(debug) == VulkanRenderGraph::InvalidResource);
+
+    // gbuffer: both attachments come out of UNDEFINED. The gbuffer's memory was last
+    // sampled by the previous frame's lighting and ui passes, so it waits on those; the
+    // imported depth has nothing to wait on
+    const auto& gbufferBarriers = passes[0].barriers.barriers;
+    CHECK(gbufferBarriers.size() == 2);
+    if (gbufferBarriers.size() == 2)
+    {
+        CHECK(Matches(gbufferBarriers[0], gbuffer,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            Fragment, 0, Color, ColorAccess));
+        CHECK(Matches(gbufferBarriers[1], depth,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            0, 0, Depth, DepthAccess));
+    }
+
+    // lighting: the gbuffer write is made visible to sampling; the backbuffer waits on acquire
+    const auto& lightingBarriers = passes[1].barriers.barriers;
+    CHECK(lightingBarriers.size() == 2);
+    if (lightingBarriers.size() == 2)
+    {
+        CHECK(Matches(lightingBarriers[0], gbuffer,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            Color, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, Fragment, VK_ACCESS_SHADER_READ_BIT));
+        CHECK(Matches(lightingBarriers[1], backbuffer,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            Color, 0, Color, ColorAccess));
+    }
+
+    // bloom: may alias the retired gbuffer, so it waits for the lighting pass to stop sampling it
+    const auto& bloomBarriers = passes[2].barriers.barriers;
+    CHECK(bloomBarriers.size() == 1);
+    if (bloomBarriers.size() == 1)
+    {
+        CHECK(Matches(bloomBarriers[0], bloom,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+            Fragment, 0, Compute, VK_ACCESS_SHADER_WRITE_BIT));
+    }
+
+    // ui: bloom goes from storage to sampled; the backbuffer only needs write-after-write
+    const auto& uiBarriers = passes[3].barriers.barriers;
+    CHECK(uiBarriers.size() == 2);
+    if (uiBarriers.size() == 2)
+    {
+        CHECK(Matches(uiBarriers[0], bloom,
+            VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            Compute, VK_ACCESS_SHADER_WRITE_BIT, Fragment, VK_ACCESS_SHADER_READ_BIT));
+        CHECK(Matches(uiBarriers[1], backbuffer,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            Color, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, Color, ColorAccess));
+        CHECK(!uiBarriers[1].IsLayoutTransition());
+    }
+
+    // Only the backbuffer has a final layout; the scratch depth is left as is
+    const auto& finalBarriers = graph.GetFinalBarriers().barriers;
+    CHECK(finalBarriers.size() == 1);
+    if (finalBarriers.size() == 1)
+    {
+        CHECK(Matches(finalBarriers[0], backbuffer,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+            Color, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0, 0));
+    }
+
+    const RenderGraphStats& stats = graph.GetStats();
+    CHECK(stats.declaredPasses == 5);
+    CHECK(stats.culledPasses == 1);
+    CHECK(stats.barrierCount == 8);
+    CHECK(stats.batchCount == 5);
+    CHECK(stats.layoutTransitions == 7);
+}
+
+// A read after a read in the same layout needs no barrier
+static void TestReadAfterRead()
+{
+    VulkanRenderGraph graph;
+
+    const uint32_t backbuffer = graph.ImportImage(RenderGraphImportDesc::Backbuffer(VK_FORMAT_B8G8R8A8_UNORM));
+    const uint32_t shadow = graph.CreateImage(RenderGraphImageDesc::Make("shadow", 64, 64, VK_FORMAT_D32_SFLOAT));
+
+    graph.AddPass("shadow").Write(shadow, RenderGraphUsage::DepthAttachment);
+    graph.AddPass("opaque").Read(shadow, RenderGraphUsage::Sampled).Write(backbuffer, RenderGraphUsage::ColorAttachment);
+    graph.AddPass("transparent").Read(shadow, RenderGraphUsage::Sampled).Write(backbuffer, RenderGraphUsage::ColorAttachment);
+
+    CHECK(graph.Compile());
+
+    const auto& passes = graph.GetCompiledPasses();
+    CHECK(passes.size() == 3);
+    if (passes.size() != 3)
+        return;
+
+    for (const auto& barrier : passes[2].barriers.barriers)
+        CHECK(barrier.resource != shadow);
+}
+
+// Transients are shared by every frame in flight: the first use in one frame waits for
+// the last use of transient memory in the previous frame, including an unread write
+static void TestAcrossFrames()
+{
+    constexpr VkPipelineStageFlags Depth = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    constexpr VkPipelineStageFlags Fragment = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    constexpr VkPipelineStageFlags Transfer = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    constexpr VkAccessFlags DepthAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    VulkanRenderGraph graph;
+
+    const uint32_t backbuffer = graph.ImportImage(RenderGraphImportDesc::Backbuffer(VK_FORMAT_B8G8R8A8_UNORM));
+    const uint32_t shadow = graph.CreateImage(RenderGraphImageDesc::Make("shadow", 64, 64, VK_FORMAT_D32_SFLOAT));
+    const uint32_t capture = graph.CreateImage(RenderGraphImageDesc::Make("capture", 8, 8, VK_FORMAT_R8G8B8A8_UNORM));
+
+    graph.AddPass("shadow").Write(shadow, RenderGraphUsage::DepthAttachment);
+    graph.AddPass("opaque").Read(shadow, RenderGraphUsage::Sampled).Write(backbuffer, RenderGraphUsage::ColorAttachment);
+    graph.AddPass("capture").Write(capture, RenderGraphUsage::TransferDst).SetSideEffects();
+
+    CHECK(graph.Compile());
+
+    const auto& passes = graph.GetCompiledPasses();
+    CHECK(passes.size() == 3);
+    if (passes.size() != 3)
+        return;
+
+    // shadow: the previous frame last sampled the shadow map and wrote the capture
+    const auto& shadowBarriers = passes[0].barriers.barriers;
+    CHECK(shadowBarriers.size() == 1);
+    if (shadowBarriers.size() == 1)
+    {
+        CHECK(Matches(shadowBarriers[0], shadow,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            Fragment | Transfer, VK_ACCESS_TRANSFER_WRITE_BIT, Depth, DepthAccess));
+    }
+
+    // capture: the same, plus the shadow map retired earlier in this frame
+    const auto& captureBarriers = passes[2].barriers.barriers;
+    CHECK(captureBarriers.size() == 1);
+    if (captureBarriers.size() == 1)
+    {
+        CHECK(Matches(captureBarriers[0], capture,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            Fragment | Transfer, VK_ACCESS_TRANSFER_WRITE_BIT, Transfer, VK_ACCESS_TRANSFER_WRITE_BIT));
+    }
+}
+
+// Side effects keep a pass alive with no outputs; a resource in two layouts fails to compile
+static void TestSideEffectsAndValidation()
+{
+    {
+        VulkanRenderGraph graph;
+        const uint32_t readback = graph.CreateImage(RenderGraphImageDesc::Make("readback", 8, 8, VK_FORMAT_R8G8B8A8_UNORM));
+        graph.AddPass("capture").Write(readback, RenderGraphUsage::TransferDst).SetSideEffects();
+
+        CHECK(graph.Compile());
+        CHECK(!graph.IsPassCulled(0));
+        CHECK(graph.GetCompiledPasses().size() == 1);
+    }
+
+    {
+        VulkanRenderGraph graph;
+        const uint32_t backbuffer = graph.ImportImage(RenderGraphImportDesc::Backbuffer(VK_FORMAT_B8G8R8A8_UNORM));
+        graph.AddPass("feedback")
+            .Read(backbuffer, RenderGraphUsage::Sampled)
+            .Write(backbuffer, RenderGraphUsage::ColorAttachment);
+
+        CHECK(!graph.Compile());
+        CHECK(!graph.IsCompiled());
+    }
+
+    {
+        // Allocation needs a device
+        VulkanRenderGraph graph;
+        const uint32_t backbuffer = graph.ImportImage(RenderGraphImportDesc::Backbuffer(VK_FORMAT_B8G8R8A8_UNORM));
+        graph.AddPass("clear").Write(backbuffer, RenderGraphUsage::ColorAttachment);
+
+        CHECK(graph.Compile());
+        CHECK(!graph.Allocate());
+    }
+}
+
+int main()
+{
+    TestDeferredFrame();
+    TestReadAfterRead();
+    TestAcrossFrames();
+    TestSideEffectsAndValidation();
+
+    if (s_failures != 0)
+    {
+        std::printf("RenderGraphTests: %d check(s) failed\n", s_failures);
+        return 1;
+    }
+
+    std::printf("RenderGraphTests: all checks passed\n");
+    return 0;
+}
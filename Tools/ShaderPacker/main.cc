@@ -0,0 +1,44 @@
+#include "../../Core/Renderer/VulkanShaderModuleCache/ShaderArchive.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// Packs compiled shaders into one archive for VulkanShaderModuleCache.
+// Usage: ShaderPacker <output> <name prefix> <file.spv>...
+// Each file is stored as <name prefix><file name>, the path the engine asks for.
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: ShaderPacker <output> <name prefix> <file.spv>...\n";
+        return 1;
+    }
+
+    const std::string output = argv[1];
+    const std::string prefix = argv[2];
+
+    std::vector<ShaderArchiveFile> files;
+    for (int i = 3; i < argc; i++)
+    {
+        const std::filesystem::path path(argv[i]);
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "ShaderPacker: cannot open " << path.string() << "\n";
+            return 1;
+        }
+
+        ShaderArchiveFile entry;
+        entry.name = prefix + path.filename().string();
+        entry.code.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(entry.code.data(), static_cast<std::streamsize>(entry.code.size()));
+        files.push_back(std::move(entry));
+    }
+
+    if (!ShaderArchive::Write(output, files))
+        return 1;
+
+    std::cout << "Packed " << files.size() << " shaders into " << output << "\n";
+    return 0;
+}